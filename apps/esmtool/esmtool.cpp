@@ -5,14 +5,18 @@
 #include <map>
 #include <set>
 #include <fstream>
+#include <algorithm>
 
 #include <boost/program_options.hpp>
 
+#include <osg/Timer>
+
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
 #include <components/esm/records.hpp>
 
 #include "record.hpp"
+#include "memory.hpp"
 
 #define ESMTOOL_VERSION 1.2
 
@@ -58,6 +62,8 @@ struct Arguments
     std::string encoding;
     std::string filename;
     std::string outname;
+    std::vector<std::string> files;
+    int top;
 
     std::vector<std::string> types;
     std::string name;
@@ -69,7 +75,7 @@ struct Arguments
 
 bool parseOptions (int argc, char** argv, Arguments &info)
 {
-    bpo::options_description desc("Inspect and extract from Morrowind ES files (ESM, ESP, ESS)\nSyntax: esmtool [options] mode infile [outfile]\nAllowed modes:\n  dump\t Dumps all readable data from the input file.\n  clone\t Clones the input file to the output file.\n  comp\t Compares the given files.\n\nAllowed options");
+    bpo::options_description desc("Inspect and extract from Morrowind ES files (ESM, ESP, ESS)\nSyntax: esmtool [options] mode infile [outfile]\nAllowed modes:\n  dump\t Dumps all readable data from the input file.\n  clone\t Clones the input file to the output file.\n  comp\t Compares the given files.\n  stats\t Loads one or more files and reports count, size, memory use and load time\n\t per record type.\n\nAllowed options");
 
     desc.add_options()
         ("help,h", "print help message.")
@@ -87,6 +93,8 @@ bool parseOptions (int argc, char** argv, Arguments &info)
          "Only affects dump mode.")
         ("quiet,q", "Supress all record information. Useful for speed tests.")
         ("loadcells,C", "Browse through contents of all cells.")
+        ("top", bpo::value<int>(&(info.top))->default_value(10),
+         "Number of largest records to list.  Only affects stats mode.")
 
         ( "encoding,e", bpo::value<std::string>(&(info.encoding))->
           default_value("win1252"),
@@ -107,7 +115,7 @@ bool parseOptions (int argc, char** argv, Arguments &info)
         ;
 
     bpo::positional_options_description p;
-    p.add("mode", 1).add("input-file", 2);
+    p.add("mode", 1).add("input-file", -1);
 
     // there might be a better way to do this
     bpo::options_description all;
@@ -157,7 +165,7 @@ bool parseOptions (int argc, char** argv, Arguments &info)
         info.name = variables["name"].as<std::string>();
 
     info.mode = variables["mode"].as<std::string>();
-    if (!(info.mode == "dump" || info.mode == "clone" || info.mode == "comp"))
+    if (!(info.mode == "dump" || info.mode == "clone" || info.mode == "comp" || info.mode == "stats"))
     {
         std::cout << std::endl << "ERROR: invalid mode \"" << info.mode << "\"" << std::endl << std::endl
                   << desc << finalText << std::endl;
@@ -179,9 +187,19 @@ bool parseOptions (int argc, char** argv, Arguments &info)
       return false;
       }*/
 
-    info.filename = variables["input-file"].as< std::vector<std::string> >()[0];
-    if (variables["input-file"].as< std::vector<std::string> >().size() > 1)
-        info.outname = variables["input-file"].as< std::vector<std::string> >()[1];
+    info.files = variables["input-file"].as< std::vector<std::string> >();
+
+    // only stats mode takes more than an input and an output file
+    if (info.files.size() > 2 && info.mode != "stats")
+    {
+        std::cout << "\nERROR: too many files specified\n\n";
+        std::cout << desc << finalText << std::endl;
+        return false;
+    }
+
+    info.filename = info.files[0];
+    if (info.files.size() > 1 && info.mode != "stats")
+        info.outname = info.files[1];
 
     info.raw_given = variables.count ("raw") != 0;
     info.quiet_given = variables.count ("quiet") != 0;
@@ -206,6 +224,7 @@ void loadCell(ESM::Cell &cell, ESM::ESMReader &esm, Arguments& info);
 int load(Arguments& info);
 int clone(Arguments& info);
 int comp(Arguments& info);
+int stats(Arguments& info);
 
 int main(int argc, char**argv)
 {
@@ -221,6 +240,8 @@ int main(int argc, char**argv)
             return clone(info);
         else if (info.mode == "comp")
             return comp(info);
+        else if (info.mode == "stats")
+            return stats(info);
         else
         {
             std::cout << "Invalid or no mode specified, dying horribly. Have a nice day." << std::endl;
@@ -581,5 +602,198 @@ int comp(Arguments& info)
 
 
 
+    return 0;
+}
+
+namespace
+{
+    struct TypeStats
+    {
+        int mCount;
+        int mSkipped; // records esmtool can not load
+        std::size_t mDiskSize;
+        std::size_t mMemory;
+        double mTime;
+
+        TypeStats() : mCount(0), mSkipped(0), mDiskSize(0), mMemory(0), mTime(0) {}
+    };
+
+    struct RecordSize
+    {
+        ESM::NAME mType;
+        std::string mId;
+        std::string mFile;
+        std::size_t mDiskSize;
+        std::size_t mMemory;
+    };
+
+    bool isLarger(const RecordSize& left, const RecordSize& right)
+    {
+        return left.mDiskSize > right.mDiskSize;
+    }
+
+    void trimLargest(std::vector<RecordSize>& records, std::size_t count)
+    {
+        if (records.size() <= count)
+            return;
+
+        std::nth_element(records.begin(), records.begin() + count, records.end(), isLarger);
+        records.resize(count);
+    }
+}
+
+int stats(Arguments& info)
+{
+    ToUTF8::Utf8Encoder encoder (ToUTF8::calculateEncoding(info.encoding));
+
+    std::size_t top = static_cast<std::size_t>(std::max(0, info.top));
+
+    std::map<int, TypeStats> types;
+    std::vector<RecordSize> largest;
+
+    osg::Timer* timer = osg::Timer::instance();
+
+    for (std::vector<std::string>::const_iterator file = info.files.begin(); file != info.files.end(); ++file)
+    {
+        std::cout << "Loading file: " << *file << std::endl;
+
+        TypeStats total;
+        osg::Timer_t fileStart = timer->tick();
+
+        try
+        {
+            ESM::ESMReader esm;
+            esm.setEncoder(&encoder);
+            esm.open(*file);
+
+            while(esm.hasMoreRecs())
+            {
+                ESM::NAME n = esm.getRecName();
+                uint32_t flags;
+                esm.getRecHeader(flags);
+
+                // record name, size, unused and flags
+                std::size_t diskSize = 16 + esm.getContext().leftRec;
+
+                // outside of the timed part, querying the allocator is not free
+                std::size_t allocated = EsmTool::getHeapUsage();
+
+                osg::Timer_t start = timer->tick();
+
+                std::string id = esm.getHNOString("NAME");
+                if (id.empty())
+                    id = esm.getHNOString("INAM");
+
+                EsmTool::RecordBase *record = EsmTool::RecordBase::create(n);
+
+                TypeStats& stats = types[n.val];
+
+                if (record == 0)
+                {
+                    esm.skipRecord();
+                    ++stats.mSkipped;
+                }
+                else
+                {
+                    if (record->getType().val == ESM::REC_GMST) {
+                        // preset id for GameSetting record
+                        record->cast<ESM::GameSetting>()->get().mId = id;
+                    }
+                    record->setId(id);
+                    record->setFlags((int) flags);
+                    record->load(esm);
+                }
+
+                double time = timer->delta_s(start, timer->tick());
+
+                // memory released by the reader while loading is not attributed to the record
+                std::size_t memory = 0;
+                std::size_t heapUsage = EsmTool::getHeapUsage();
+                if (heapUsage > allocated)
+                    memory = heapUsage - allocated;
+
+                delete record;
+
+                ++stats.mCount;
+                stats.mDiskSize += diskSize;
+                stats.mMemory += memory;
+                stats.mTime += time;
+
+                ++total.mCount;
+                total.mDiskSize += diskSize;
+                total.mMemory += memory;
+
+                if (top > 0)
+                {
+                    RecordSize size;
+                    size.mType = n;
+                    size.mId = id;
+                    size.mFile = *file;
+                    size.mDiskSize = diskSize;
+                    size.mMemory = memory;
+                    largest.push_back(size);
+
+                    if (largest.size() >= 2 * top + 64)
+                        trimLargest(largest, top);
+                }
+            }
+        }
+        catch(std::exception &e)
+        {
+            std::cout << "\nERROR:\n\n  " << e.what() << std::endl;
+            return 1;
+        }
+
+        std::cout << "  " << total.mCount << " records, " << total.mDiskSize << " bytes on disk, "
+            << total.mMemory << " bytes in memory, "
+            << timer->delta_s(fileStart, timer->tick()) << " s" << std::endl;
+    }
+
+    if (!EsmTool::isHeapUsageAvailable())
+        std::cout << std::endl << "Memory use can not be measured on this platform." << std::endl;
+
+    std::cout << std::endl
+        << "Type " << std::setw(10) << "Count" << std::setw(16) << "Disk (bytes)"
+        << std::setw(16) << "Memory (bytes)" << std::setw(12) << "Time (ms)" << std::endl;
+
+    TypeStats total;
+    ESM::NAME name;
+
+    for (std::map<int, TypeStats>::const_iterator iter = types.begin(); iter != types.end(); ++iter)
+    {
+        name.val = iter->first;
+        const TypeStats& stats = iter->second;
+
+        std::cout << name.toString() << " " << std::setw(10) << stats.mCount
+            << std::setw(16) << stats.mDiskSize << std::setw(16) << stats.mMemory
+            << std::setw(12) << std::fixed << std::setprecision(2) << stats.mTime * 1000;
+
+        if (stats.mSkipped)
+            std::cout << "  (" << stats.mSkipped << " not loaded)";
+
+        std::cout << std::endl;
+
+        total.mCount += stats.mCount;
+        total.mDiskSize += stats.mDiskSize;
+        total.mMemory += stats.mMemory;
+        total.mTime += stats.mTime;
+    }
+
+    std::cout << "All  " << std::setw(10) << total.mCount
+        << std::setw(16) << total.mDiskSize << std::setw(16) << total.mMemory
+        << std::setw(12) << std::fixed << std::setprecision(2) << total.mTime * 1000 << std::endl;
+
+    if (top > 0 && !largest.empty())
+    {
+        trimLargest(largest, top);
+        std::sort(largest.begin(), largest.end(), isLarger);
+
+        std::cout << std::endl << "Largest records:" << std::endl;
+
+        for (std::vector<RecordSize>::const_iterator iter = largest.begin(); iter != largest.end(); ++iter)
+            std::cout << "  " << iter->mType.toString() << " '" << iter->mId << "' (" << iter->mFile << "): "
+                << iter->mDiskSize << " bytes on disk, " << iter->mMemory << " bytes in memory" << std::endl;
+    }
+
     return 0;
 }
@@ -0,0 +1,36 @@
+#include "memory.hpp"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+bool EsmTool::isHeapUsageAvailable()
+{
+#if defined(__GLIBC__) || defined(__APPLE__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::size_t EsmTool::getHeapUsage()
+{
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    // the fields are int, so this is only accurate below 2 GiB
+    struct mallinfo info = mallinfo();
+    return static_cast<unsigned int>(info.uordblks) + static_cast<unsigned int>(info.hblkhd);
+#endif
+#elif defined(__APPLE__)
+    malloc_statistics_t statistics;
+    malloc_zone_statistics(NULL, &statistics);
+    return statistics.size_in_use;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,19 @@
+#ifndef OPENMW_ESMTOOL_MEMORY_H
+#define OPENMW_ESMTOOL_MEMORY_H
+
+#include <cstddef>
+
+namespace EsmTool
+{
+    /// Can the heap usage be queried on this platform?
+    bool isHeapUsageAvailable();
+
+    /// Number of bytes currently in use on the heap, according to the statistics of the C library's
+    /// allocator. Includes the allocator's own bookkeeping of each block.
+    ///
+    /// The difference between two calls is the net amount of memory allocated in between. Always 0 if
+    /// isHeapUsageAvailable() is false.
+    std::size_t getHeapUsage();
+}
+
+#endif
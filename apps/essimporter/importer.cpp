@@ -1,11 +1,29 @@
 #include "importer.hpp"
 
 #include <iomanip>
+#include <sstream>
 
 #include <boost/shared_ptr.hpp>
 
+#if defined(_WIN32)
+// For GetProcessMemoryInfo
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <OpenThreads/Thread>
+
 #include <osgDB/ReadFile>
 #include <osg/ImageUtils>
+#include <osg/Timer>
 
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
@@ -27,6 +45,8 @@
 
 #include <components/to_utf8/to_utf8.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include "importercontext.hpp"
 
 #include "converter.hpp"
@@ -34,7 +54,7 @@
 namespace
 {
 
-    void writeScreenshot(const ESM::Header& fileHeader, ESM::SavedGame& out)
+    void writeScreenshot(const ESM::Header& fileHeader, std::vector<char>& out)
     {
         if (fileHeader.mSCRS.size() != 128*128*4)
         {
@@ -77,7 +97,234 @@ namespace
         }
 
         std::string data = ostream.str();
-        out.mScreenshot = std::vector<char>(data.begin(), data.end());
+        out = std::vector<char>(data.begin(), data.end());
+    }
+
+    /// Encodes the screenshot of the save game header, while the records are being read
+    class EncodeScreenshot : public SceneUtil::WorkItem
+    {
+    public:
+        EncodeScreenshot(const ESM::Header& fileHeader, const boost::shared_ptr<std::vector<char> >& out)
+            : mHeader(fileHeader)
+            , mOut(out)
+        {
+        }
+
+        virtual void doWork()
+        {
+            writeScreenshot(mHeader, *mOut);
+            mTicket->signalDone();
+        }
+
+    private:
+        const ESM::Header& mHeader;
+        boost::shared_ptr<std::vector<char> > mOut;
+    };
+
+    struct ConverterOutput
+    {
+        boost::shared_ptr<std::stringstream> mData;
+        std::string mError;
+        double mTime;
+
+        ConverterOutput() : mTime(0) {}
+    };
+
+    /// Writes the records of a converter into a separate buffer, so that converters can be written
+    /// concurrently.
+    /// @note Converter::write must only read the shared Context, except for state that is not used by
+    /// any other converter.
+    class WriteConverter : public SceneUtil::WorkItem
+    {
+    public:
+        WriteConverter(const boost::shared_ptr<ESSImport::Converter>& converter, int format,
+                       const boost::shared_ptr<ConverterOutput>& out)
+            : mConverter(converter)
+            , mFormat(format)
+            , mOut(out)
+        {
+        }
+
+        virtual void doWork()
+        {
+            osg::Timer_t start = osg::Timer::instance()->tick();
+
+            try
+            {
+                boost::shared_ptr<std::stringstream> stream(
+                    new std::stringstream(std::ios::in | std::ios::out | std::ios::binary));
+
+                ESM::ESMWriter writer;
+                writer.setFormat(mFormat);
+                writer.open(*stream);
+                mConverter->write(writer);
+                writer.close();
+
+                mOut->mData = stream;
+            }
+            catch (const std::exception& e)
+            {
+                mOut->mError = e.what();
+            }
+
+            mOut->mTime = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+            mTicket->signalDone();
+        }
+
+    private:
+        boost::shared_ptr<ESSImport::Converter> mConverter;
+        int mFormat;
+        boost::shared_ptr<ConverterOutput> mOut;
+    };
+
+    struct PendingConverter
+    {
+        unsigned int mRecordType;
+        boost::shared_ptr<ESSImport::Converter> mConverter;
+        osg::ref_ptr<SceneUtil::WorkTicket> mTicket;
+        boost::shared_ptr<ConverterOutput> mOutput;
+    };
+
+    /// Runs the converters on a WorkQueue and appends their output to the save in the order they were added.
+    /// Only a few converters are started ahead of the one being written, so the buffered output of most of them
+    /// never has to be held at the same time.
+    class ConverterWriter
+    {
+    public:
+        ConverterWriter(SceneUtil::WorkQueue& workQueue, unsigned int maxInFlight, int format)
+            : mWorkQueue(workQueue)
+            , mMaxInFlight(std::max(1u, maxInFlight))
+            , mFormat(format)
+            , mNextStart(0)
+            , mNextWrite(0)
+        {
+        }
+
+        void add(unsigned int recordType, const boost::shared_ptr<ESSImport::Converter>& converter)
+        {
+            PendingConverter pending;
+            pending.mRecordType = recordType;
+            pending.mConverter = converter;
+            mPending.push_back(pending);
+        }
+
+        /// Start converting the first converters, so they are done by the time the header has been written.
+        void start()
+        {
+            startMore();
+        }
+
+        /// Append the output of the next \a count converters.
+        void write(unsigned int count, ESM::ESMWriter& writer, std::ostream& stream)
+        {
+            for (unsigned int i=0; i<count; ++i)
+            {
+                PendingConverter& pending = mPending.at(mNextWrite++);
+                pending.mTicket->waitTillDone();
+                pending.mTicket = NULL;
+
+                // keep the queue busy while this output is being written
+                startMore();
+
+                ConverterOutput& output = *pending.mOutput;
+                if (!output.mError.empty())
+                    throw std::runtime_error(output.mError);
+
+                // the records are complete, so they can go straight to the stream
+                writer.flush();
+                if (output.mData->tellp() > 0)
+                    stream << output.mData->rdbuf();
+
+                output.mData.reset();
+                pending.mConverter.reset();
+            }
+        }
+
+        /// Get the time each converter spent writing, by record type.
+        void getWriteTimes(std::map<unsigned int, double>& times) const
+        {
+            for (std::vector<PendingConverter>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+                if (it->mOutput)
+                    times[it->mRecordType] = it->mOutput->mTime;
+        }
+
+    private:
+        void startMore()
+        {
+            while (mNextStart < mPending.size() && mNextStart - mNextWrite < mMaxInFlight)
+            {
+                PendingConverter& pending = mPending[mNextStart++];
+                pending.mOutput.reset(new ConverterOutput);
+                pending.mTicket = mWorkQueue.addWorkItem(new WriteConverter(pending.mConverter, mFormat, pending.mOutput));
+            }
+        }
+
+        SceneUtil::WorkQueue& mWorkQueue;
+        unsigned int mMaxInFlight;
+        int mFormat;
+
+        std::vector<PendingConverter> mPending;
+        unsigned int mNextStart;
+        unsigned int mNextWrite;
+    };
+
+    /// Per record type statistics for --benchmark
+    struct ConverterStats
+    {
+        int mRecords;
+        double mReadTime;
+        double mWriteTime;
+
+        ConverterStats() : mRecords(0), mReadTime(0), mWriteTime(0) {}
+    };
+
+    /// @return The peak resident memory of the process in KiB, or 0 if unknown.
+    size_t getPeakMemoryUsage()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize / 1024;
+        return 0;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#if defined(__APPLE__)
+        // in bytes rather than KiB
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+#endif
+    }
+
+    void printStats(const std::map<unsigned int, ConverterStats>& stats, double totalTime)
+    {
+        std::ios::fmtflags f(std::cout.flags());
+
+        std::cout << "record  count      read (s)  write (s)" << std::endl;
+
+        for (std::map<unsigned int, ConverterStats>::const_iterator it = stats.begin(); it != stats.end(); ++it)
+        {
+            ESM::NAME name;
+            name.val = it->first;
+
+            std::cout << name.toString() << "  "
+                      << std::setw(9) << it->second.mRecords << "  "
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(8) << it->second.mReadTime << "  "
+                      << std::setw(9) << it->second.mWriteTime << std::endl;
+        }
+
+        std::cout << "total: " << std::fixed << std::setprecision(3) << totalTime << " s" << std::endl;
+
+        size_t peakMemory = getPeakMemoryUsage();
+        if (peakMemory)
+            std::cout << "peak memory: " << peakMemory << " KiB" << std::endl;
+
+        std::cout.flags(f);
     }
 
 }
@@ -89,10 +336,16 @@ namespace ESSImport
         : mEssFile(essfile)
         , mOutFile(outfile)
         , mEncoding(encoding)
+        , mBenchmark(false)
     {
 
     }
 
+    void Importer::setBenchmark(bool benchmark)
+    {
+        mBenchmark = benchmark;
+    }
+
     struct File
     {
         struct Subrecord
@@ -263,6 +516,13 @@ namespace ESSImport
         const ESM::Header& header = esm.getHeader();
         context.mPlayerCellName = header.mGameData.mCurrentCell.toString();
 
+        unsigned int numThreads = std::max(1, OpenThreads::GetNumberOfProcessors());
+        SceneUtil::WorkQueue workQueue(static_cast<int>(numThreads));
+
+        boost::shared_ptr<std::vector<char> > screenshot(new std::vector<char>);
+        osg::ref_ptr<SceneUtil::WorkTicket> screenshotTicket =
+            workQueue.addWorkItem(new EncodeScreenshot(header, screenshot));
+
         const unsigned int recREFR = ESM::FourCC<'R','E','F','R'>::value;
         const unsigned int recPCDT = ESM::FourCC<'P','C','D','T'>::value;
         const unsigned int recFMAP = ESM::FourCC<'F','M','A','P'>::value;
@@ -317,6 +577,10 @@ namespace ESSImport
             it->second->setContext(context);
         }
 
+        std::map<unsigned int, ConverterStats> stats;
+        osg::Timer_t startTime = osg::Timer::instance()->tick();
+
+        // Records depend on each other through the Context, so they have to be read in order
         while (esm.hasMoreRecs())
         {
             ESM::NAME n = esm.getRecName();
@@ -325,7 +589,17 @@ namespace ESSImport
             std::map<unsigned int, boost::shared_ptr<Converter> >::iterator it = converters.find(n.val);
             if (it != converters.end())
             {
-                it->second->read(esm);
+                if (mBenchmark)
+                {
+                    osg::Timer_t start = osg::Timer::instance()->tick();
+                    it->second->read(esm);
+
+                    ConverterStats& converterStats = stats[n.val];
+                    ++converterStats.mRecords;
+                    converterStats.mReadTime += osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+                }
+                else
+                    it->second->read(esm);
             }
             else
             {
@@ -340,6 +614,24 @@ namespace ESSImport
             }
         }
 
+        // Converting the records to the output format is independent for each converter.
+        // Writing order should be Dynamic Store -> Cells -> Player,
+        // so that references to dynamic records can be recognized when loading
+        ConverterWriter converterWriter(workQueue, numThreads, ESM::SavedGame::sCurrentFormat);
+        unsigned int numStage[2] = { 0, 0 };
+        for (int stage=0; stage<2; ++stage)
+        {
+            for (std::map<unsigned int, boost::shared_ptr<Converter> >::const_iterator it = converters.begin();
+                 it != converters.end(); ++it)
+            {
+                if (it->second->getStage() != stage)
+                    continue;
+                converterWriter.add(it->first, it->second);
+                ++numStage[stage];
+            }
+        }
+        converterWriter.start();
+
         ESM::ESMWriter writer;
 
         writer.setFormat (ESM::SavedGame::sCurrentFormat);
@@ -377,34 +669,21 @@ namespace ESSImport
         profile.mPlayerLevel = context.mPlayerBase.mNpdt52.mLevel;
         profile.mPlayerName = header.mGameData.mPlayerName.toString();
 
-        writeScreenshot(header, profile);
+        screenshotTicket->waitTillDone();
+        profile.mScreenshot.swap(*screenshot);
 
         writer.startRecord (ESM::REC_SAVE);
         profile.save (writer);
         writer.endRecord (ESM::REC_SAVE);
 
-        // Writing order should be Dynamic Store -> Cells -> Player,
-        // so that references to dynamic records can be recognized when loading
-        for (std::map<unsigned int, boost::shared_ptr<Converter> >::const_iterator it = converters.begin();
-             it != converters.end(); ++it)
-        {
-            if (it->second->getStage() != 0)
-                continue;
-            it->second->write(writer);
-        }
+        converterWriter.write(numStage[0], writer, stream);
 
         writer.startRecord(ESM::REC_NPC_);
         writer.writeHNString("NAME", "player");
         context.mPlayerBase.save(writer);
         writer.endRecord(ESM::REC_NPC_);
 
-        for (std::map<unsigned int, boost::shared_ptr<Converter> >::const_iterator it = converters.begin();
-             it != converters.end(); ++it)
-        {
-            if (it->second->getStage() != 1)
-                continue;
-            it->second->write(writer);
-        }
+        converterWriter.write(numStage[1], writer, stream);
 
         writer.startRecord(ESM::REC_PLAY);
         if (context.mPlayer.mCellId.mPaged)
@@ -422,6 +701,18 @@ namespace ESSImport
         writer.startRecord (ESM::REC_DIAS);
         context.mDialogueState.save(writer);
         writer.endRecord(ESM::REC_DIAS);
+
+        writer.close();
+
+        if (mBenchmark)
+        {
+            std::map<unsigned int, double> writeTimes;
+            converterWriter.getWriteTimes(writeTimes);
+            for (std::map<unsigned int, double>::const_iterator it = writeTimes.begin(); it != writeTimes.end(); ++it)
+                stats[it->first].mWriteTime = it->second;
+
+            printStats(stats, osg::Timer::instance()->delta_s(startTime, osg::Timer::instance()->tick()));
+        }
     }
 
 
@@ -11,6 +11,9 @@ namespace ESSImport
     public:
         Importer(const std::string& essfile, const std::string& outfile, const std::string& encoding);
 
+        /// Print time spent per record type and the peak memory usage after conversion.
+        void setBenchmark(bool benchmark);
+
         void run();
 
         void compare();
@@ -19,6 +22,7 @@ namespace ESSImport
         std::string mEssFile;
         std::string mOutFile;
         std::string mEncoding;
+        bool mBenchmark;
     };
 
 }
@@ -25,6 +25,7 @@ int main(int argc, char** argv)
             ("mwsave,m", bpo::value<std::string>(), "morrowind .ess save file")
             ("output,o", bpo::value<std::string>(), "output file (.omwsave)")
             ("compare,c", "compare two .ess files")
+            ("benchmark,b", "report time spent for each record type and the peak memory usage")
             ("encoding", boost::program_options::value<std::string>()->default_value("win1252"), "encoding of the save file")
         ;
         p_desc.add("mwsave", 1).add("output", 1);
@@ -53,6 +54,7 @@ int main(int argc, char** argv)
         std::string encoding = variables["encoding"].as<std::string>();
 
         ESSImport::Importer importer(essFile, outputFile, encoding);
+        importer.setBenchmark(variables.count("benchmark") != 0);
 
         if (variables.count("compare"))
             importer.compare();
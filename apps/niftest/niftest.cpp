@@ -1,17 +1,26 @@
 ///Program to test .nif files both on the FileSystem and in BSA archives.
 
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <sstream>
 #include <cstdlib>
+#include <algorithm>
+
+#include <OpenThreads/Thread>
+
+#include <osg/Timer>
 
 #include <components/nif/niffile.hpp>
 #include <components/files/constrainedfilestream.hpp>
 #include <components/vfs/manager.hpp>
 #include <components/vfs/bsaarchive.hpp>
 #include <components/vfs/filesystemarchive.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
 
 // Create local aliases for brevity
 namespace bpo = boost::program_options;
@@ -43,16 +52,36 @@ bool isBSA(std::string filename)
     return hasExtension(filename,"bsa");
 }
 
-/// Check all the nif files in a given VFS::Archive
+/// A nif file to check, and the results of checking it
+struct Job
+{
+    const VFS::Manager* mManager; ///< 0 for files that are read from the file system directly
+    std::string mName; ///< name in mManager, or path
+    std::string mPath; ///< name used for reporting
+
+    size_t mRecords;
+    size_t mBytes;
+    double mTime; ///< in seconds, including opening the file
+    std::string mError;
+
+    Job(const VFS::Manager* manager, const std::string& name, const std::string& path)
+        : mManager(manager), mName(name), mPath(path), mRecords(0), mBytes(0), mTime(0)
+    {}
+};
+
+typedef std::vector<boost::shared_ptr<VFS::Manager> > Managers;
+
+/// Add all the nif files in a given VFS::Archive to \a jobs
 /// \note Takes ownership!
 /// \note Can not read a bsa file inside of a bsa file.
-void readVFS(VFS::Archive* anArchive,std::string archivePath = "")
+void readVFS(VFS::Archive* anArchive, std::vector<Job>& jobs, Managers& managers, std::string archivePath = "")
 {
-    VFS::Manager myManager(true);
-    myManager.addArchive(anArchive);
-    myManager.buildIndex();
+    boost::shared_ptr<VFS::Manager> myManager(new VFS::Manager(true));
+    myManager->addArchive(anArchive);
+    myManager->buildIndex();
+    managers.push_back(myManager);
 
-    std::map<std::string, VFS::File*> files=myManager.getIndex();
+    const std::map<std::string, VFS::File*>& files=myManager->getIndex();
     for(std::map<std::string, VFS::File*>::const_iterator it=files.begin(); it!=files.end(); ++it)
     {
         std::string name = it->first;
@@ -60,16 +89,13 @@ void readVFS(VFS::Archive* anArchive,std::string archivePath = "")
         try{
             if(isNIF(name))
             {
-            //           std::cout << "Decoding: " << name << std::endl;
-                Nif::NIFFile temp_nif(myManager.get(name),archivePath+name);
+                jobs.push_back(Job(myManager.get(), name, archivePath+name));
             }
             else if(isBSA(name))
             {
                 if(!archivePath.empty() && !isBSA(archivePath))
                 {
-//                     std::cout << "Reading BSA File: " << name << std::endl;
-                    readVFS(new VFS::BsaArchive(archivePath+name),archivePath+name+"/");
-//                     std::cout << "Done with BSA File: " << name << std::endl;
+                    readVFS(new VFS::BsaArchive(archivePath+name), jobs, managers, archivePath+name+"/");
                 }
             }
         }
@@ -80,7 +106,171 @@ void readVFS(VFS::Archive* anArchive,std::string archivePath = "")
     }
 }
 
-std::vector<std::string> parseOptions (int argc, char** argv)
+/// Parse a nif file and record the results in \a job
+/// \note The VFS is only read, so several jobs can be run concurrently.
+void parse(Job& job)
+{
+    osg::Timer_t start = osg::Timer::instance()->tick();
+
+    try
+    {
+        Files::IStreamPtr stream = job.mManager ? job.mManager->get(job.mName)
+                                                : Files::openConstrainedFileStream(job.mName.c_str());
+
+        stream->seekg(0, std::ios::end);
+        job.mBytes = static_cast<size_t>(stream->tellg());
+        stream->seekg(0, std::ios::beg);
+
+        Nif::NIFFile nif(stream, job.mPath);
+        job.mRecords = nif.numRecords();
+    }
+    catch (std::exception& e)
+    {
+        job.mError = e.what();
+    }
+
+    job.mTime = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+}
+
+class ParseJob : public SceneUtil::WorkItem
+{
+public:
+    ParseJob(Job& job) : mJob(job) {}
+
+    virtual void doWork()
+    {
+        parse(mJob);
+        mTicket->signalDone();
+    }
+
+private:
+    Job& mJob;
+};
+
+/// Parse all jobs, using \a threads worker threads (or the calling thread only, if \a threads is 1)
+void parseAll(std::vector<Job>& jobs, int threads)
+{
+    if (threads<=1)
+    {
+        for (std::vector<Job>::iterator it=jobs.begin(); it!=jobs.end(); ++it)
+            parse(*it);
+        return;
+    }
+
+    SceneUtil::WorkQueue workQueue(threads);
+
+    std::vector<osg::ref_ptr<SceneUtil::WorkTicket> > tickets;
+    tickets.reserve(jobs.size());
+
+    for (std::vector<Job>::iterator it=jobs.begin(); it!=jobs.end(); ++it)
+        tickets.push_back(workQueue.addWorkItem(new ParseJob(*it)));
+
+    for (std::vector<osg::ref_ptr<SceneUtil::WorkTicket> >::const_iterator it=tickets.begin(); it!=tickets.end(); ++it)
+        (*it)->waitTillDone();
+}
+
+std::string escapeCSV(const std::string& text)
+{
+    std::string escaped = "\"";
+    for (std::string::const_iterator it=text.begin(); it!=text.end(); ++it)
+    {
+        if (*it == '"')
+            escaped += '"';
+        escaped += *it;
+    }
+    return escaped + "\"";
+}
+
+std::string escapeJSON(const std::string& text)
+{
+    std::ostringstream escaped;
+    escaped << '"';
+    for (std::string::const_iterator it=text.begin(); it!=text.end(); ++it)
+    {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (c == '"' || c == '\\')
+            escaped << '\\' << *it;
+        else if (c < 0x20)
+            escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        else
+            escaped << *it;
+    }
+    escaped << '"';
+    return escaped.str();
+}
+
+/// Write the per-file results to \a filename, as JSON if it ends in .json, otherwise as CSV
+void writeSummary(const std::vector<Job>& jobs, const std::string& filename, int threads, double time)
+{
+    std::ofstream stream(filename.c_str());
+    if (!stream)
+        throw std::runtime_error("can't open summary file " + filename);
+
+    stream.setf(std::ios::fixed);
+    stream << std::setprecision(6);
+
+    if (hasExtension(filename, "json"))
+    {
+        stream << "{\n  \"threads\": " << threads << ",\n  \"seconds\": " << time << ",\n  \"files\": [";
+        for (std::vector<Job>::const_iterator it=jobs.begin(); it!=jobs.end(); ++it)
+        {
+            stream << (it==jobs.begin() ? "\n" : ",\n")
+                   << "    {\"file\": " << escapeJSON(it->mPath)
+                   << ", \"records\": " << it->mRecords
+                   << ", \"bytes\": " << it->mBytes
+                   << ", \"seconds\": " << it->mTime
+                   << ", \"error\": " << escapeJSON(it->mError) << "}";
+        }
+        stream << "\n  ]\n}\n";
+    }
+    else
+    {
+        stream << "file,records,bytes,seconds,error\n";
+        for (std::vector<Job>::const_iterator it=jobs.begin(); it!=jobs.end(); ++it)
+        {
+            stream << escapeCSV(it->mPath) << ',' << it->mRecords << ',' << it->mBytes << ','
+                   << it->mTime << ',' << escapeCSV(it->mError) << '\n';
+        }
+    }
+}
+
+/// Print totals for all jobs
+void printTiming(const std::vector<Job>& jobs, int threads, double time)
+{
+    size_t records = 0;
+    size_t bytes = 0;
+    size_t failed = 0;
+    double parseTime = 0;
+    for (std::vector<Job>::const_iterator it=jobs.begin(); it!=jobs.end(); ++it)
+    {
+        records += it->mRecords;
+        bytes += it->mBytes;
+        parseTime += it->mTime;
+        if (!it->mError.empty())
+            ++failed;
+    }
+
+    std::ios::fmtflags f(std::cout.flags());
+    std::cout << std::fixed << std::setprecision(3)
+              << "files: " << jobs.size() << " (" << failed << " failed)\n"
+              << "records: " << records << "\n"
+              << "bytes: " << bytes << "\n"
+              << "threads: " << threads << "\n"
+              << "parse time (sum over files): " << parseTime << " s\n"
+              << "wall time: " << time << " s\n"
+              << "throughput: " << (time > 0 ? bytes/(1024.0*1024.0)/time : 0) << " MiB/s" << std::endl;
+    std::cout.flags(f);
+}
+
+struct Options
+{
+    std::vector<std::string> mFiles;
+    int mThreads;
+    std::string mSummary;
+    bool mTiming;
+};
+
+Options parseOptions (int argc, char** argv)
 {
     bpo::options_description desc("Ensure that OpenMW can use the provided NIF and BSA files\n\n"
         "Usages:\n"
@@ -90,6 +280,11 @@ std::vector<std::string> parseOptions (int argc, char** argv)
     desc.add_options()
         ("help,h", "print help message.")
         ("input-file", bpo::value< std::vector<std::string> >(), "input file")
+        ("threads,j", bpo::value<int>()->default_value(1),
+            "number of threads to parse files with (0: one per processor).")
+        ("summary,s", bpo::value<std::string>(),
+            "write per-file records, bytes and parse time to the given file (JSON for *.json, CSV otherwise).")
+        ("timing,t", "print total records, bytes, time and throughput.")
         ;
 
     //Default option if none provided
@@ -118,7 +313,15 @@ std::vector<std::string> parseOptions (int argc, char** argv)
     }
     if (variables.count("input-file"))
     {
-        return variables["input-file"].as< std::vector<std::string> >();
+        Options options;
+        options.mFiles = variables["input-file"].as< std::vector<std::string> >();
+        options.mThreads = variables["threads"].as<int>();
+        if (options.mThreads <= 0)
+            options.mThreads = std::max(1, OpenThreads::GetNumberOfProcessors());
+        if (variables.count("summary"))
+            options.mSummary = variables["summary"].as<std::string>();
+        options.mTiming = variables.count("timing") != 0;
+        return options;
     }
 
     std::cout << "No input files or directories specified!" << std::endl;
@@ -128,28 +331,27 @@ std::vector<std::string> parseOptions (int argc, char** argv)
 
 int main(int argc, char **argv)
 {
-    std::vector<std::string> files = parseOptions (argc, argv);
+    Options options = parseOptions (argc, argv);
+
+    std::vector<Job> jobs;
+    Managers managers;
 
-//     std::cout << "Reading Files" << std::endl;
-    for(std::vector<std::string>::const_iterator it=files.begin(); it!=files.end(); ++it)
+    for(std::vector<std::string>::const_iterator it=options.mFiles.begin(); it!=options.mFiles.end(); ++it)
     {
          std::string name = *it;
 
         try{
             if(isNIF(name))
             {
-                //std::cout << "Decoding: " << name << std::endl;
-                Nif::NIFFile temp_nif(Files::openConstrainedFileStream(name.c_str()),name);
+                jobs.push_back(Job(0, name, name));
              }
              else if(isBSA(name))
              {
-//                 std::cout << "Reading BSA File: " << name << std::endl;
-                readVFS(new VFS::BsaArchive(name));
+                readVFS(new VFS::BsaArchive(name), jobs, managers);
              }
              else if(bfs::is_directory(bfs::path(name)))
              {
-//                 std::cout << "Reading All Files in: " << name << std::endl;
-                readVFS(new VFS::FileSystemArchive(name),name);
+                readVFS(new VFS::FileSystemArchive(name), jobs, managers, name);
              }
              else
              {
@@ -161,5 +363,31 @@ int main(int argc, char **argv)
             std::cerr << "ERROR, an exception has occurred:  " << e.what() << std::endl;
         }
      }
+
+    osg::Timer_t start = osg::Timer::instance()->tick();
+    parseAll(jobs, options.mThreads);
+    double time = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+    // report in a stable order, regardless of the number of threads
+    for(std::vector<Job>::const_iterator it=jobs.begin(); it!=jobs.end(); ++it)
+    {
+        if (!it->mError.empty())
+            std::cerr << "ERROR, an exception has occurred:  " << it->mError << std::endl;
+    }
+
+    try
+    {
+        if (!options.mSummary.empty())
+            writeSummary(jobs, options.mSummary, options.mThreads, time);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR, an exception has occurred:  " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (options.mTiming)
+        printTiming(jobs, options.mThreads, time);
+
      return 0;
 }
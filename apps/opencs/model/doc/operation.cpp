@@ -2,8 +2,11 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 
 #include <QTimer>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "../world/universalid.hpp"
 #include "../settings/usersettings.hpp"
@@ -11,6 +14,56 @@
 #include "state.hpp"
 #include "stage.hpp"
 
+namespace
+{
+    /// Number of steps per thread in a single batch of a parallel stage
+    const int sStepsPerThread = 64;
+
+    struct StepResult
+    {
+        CSMDoc::Messages mMessages;
+        bool mFailed;
+        std::string mError;
+
+        StepResult (CSMDoc::Message::Severity defaultSeverity)
+        : mMessages (defaultSeverity), mFailed (false) {}
+    };
+
+    class PerformSteps : public QRunnable
+    {
+            CSMDoc::Stage& mStage;
+            int mFirstStep;
+            std::vector<StepResult>::iterator mBegin;
+            std::vector<StepResult>::iterator mEnd;
+
+        public:
+
+            PerformSteps (CSMDoc::Stage& stage, int firstStep,
+                std::vector<StepResult>::iterator begin, std::vector<StepResult>::iterator end)
+            : mStage (stage), mFirstStep (firstStep), mBegin (begin), mEnd (end)
+            {}
+
+            virtual void run()
+            {
+                int step = mFirstStep;
+
+                for (std::vector<StepResult>::iterator iter (mBegin); iter!=mEnd; ++iter, ++step)
+                {
+                    try
+                    {
+                        mStage.perform (step, iter->mMessages);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        iter->mFailed = true;
+                        iter->mError = e.what();
+                        break;
+                    }
+                }
+            }
+    };
+}
+
 void CSMDoc::Operation::prepareStages()
 {
     mCurrentStage = mStages.begin();
@@ -36,6 +89,7 @@ CSMDoc::Operation::Operation (int type, bool ordered, bool finalAlways)
   mDefaultSeverity (Message::Severity_Error)
 {
     mTimer = new QTimer (this);
+    mThreadPool = new QThreadPool (this);
 }
 
 CSMDoc::Operation::~Operation()
@@ -126,6 +180,11 @@ void CSMDoc::Operation::executeStage()
             mCurrentStep = 0;
             ++mCurrentStage;
         }
+        else if (mCurrentStage->first->isParallel())
+        {
+            performParallel (messages);
+            break;
+        }
         else
         {
             try
@@ -152,6 +211,46 @@ void CSMDoc::Operation::executeStage()
         operationDone();
 }
 
+void CSMDoc::Operation::performParallel (Messages& messages)
+{
+    Stage& stage = *mCurrentStage->first;
+
+    int threads = std::max (1, mThreadPool->maxThreadCount());
+    int steps = std::min (mCurrentStage->second-mCurrentStep, threads*sStepsPerThread);
+    int chunk = (steps+threads-1)/threads;
+
+    std::vector<StepResult> results (steps, StepResult (mDefaultSeverity));
+
+    for (int begin = 0; begin<steps; begin += chunk)
+        mThreadPool->start (new PerformSteps (stage, mCurrentStep+begin, results.begin()+begin,
+            results.begin()+std::min (begin+chunk, steps)));
+
+    mThreadPool->waitForDone();
+
+    // Merge in step order, so that the report does not depend on the scheduling. Steps after a
+    // failed one are discarded, as if the stage had been performed sequentially.
+    int done = 0;
+
+    for (std::vector<StepResult>::const_iterator iter (results.begin()); iter!=results.end(); ++iter)
+    {
+        for (Messages::Iterator iter2 (iter->mMessages.begin()); iter2!=iter->mMessages.end(); ++iter2)
+            messages.add (iter2->mId, iter2->mMessage, iter2->mHint, iter2->mSeverity);
+
+        ++done;
+
+        if (iter->mFailed)
+        {
+            mCurrentStepTotal += done;
+            emit reportMessage (Message (CSMWorld::UniversalId(), iter->mError, "", Message::Severity_SeriousError), mType);
+            abort();
+            return;
+        }
+    }
+
+    mCurrentStep += steps;
+    mCurrentStepTotal += steps;
+}
+
 void CSMDoc::Operation::operationDone()
 {
     mTimer->stop();
@@ -8,6 +8,8 @@
 #include <QTimer>
 #include <QStringList>
 
+class QThreadPool;
+
 #include "messages.hpp"
 
 namespace CSMWorld
@@ -37,9 +39,15 @@ namespace CSMDoc
             std::map<QString, QStringList> mSettings;
             bool mPrepared;
             Message::Severity mDefaultSeverity;
+            QThreadPool *mThreadPool;
 
             void prepareStages();
 
+            void performParallel (Messages& messages);
+            ///< Perform the next batch of steps of the current stage on the thread pool.
+            ///
+            /// \note Messages are added to \a messages in step order.
+
         public:
 
             Operation (int type, bool ordered, bool finalAlways = false);
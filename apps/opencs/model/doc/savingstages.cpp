@@ -478,6 +478,7 @@ int CSMDoc::CloseSaveStage::setup()
 
 void CSMDoc::CloseSaveStage::perform (int stage, Messages& messages)
 {
+    mState.getWriter().close();
     mState.getStream().close();
 
     if (!mState.getStream())
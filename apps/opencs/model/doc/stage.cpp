@@ -1,5 +1,12 @@
 #include "stage.hpp"
 
+CSMDoc::Stage::Stage (bool parallel) : mParallel (parallel) {}
+
 CSMDoc::Stage::~Stage() {}
 
+bool CSMDoc::Stage::isParallel() const
+{
+    return mParallel;
+}
+
 void CSMDoc::Stage::updateUserSetting (const QString& name, const QStringList& value) {}
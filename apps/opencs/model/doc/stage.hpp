@@ -14,8 +14,15 @@ namespace CSMDoc
 {
     class Stage
     {
+            bool mParallel;
+
         public:
 
+            Stage (bool parallel = false);
+            ///< \param parallel Can the steps of this stage be performed concurrently, in any order?
+            /// This requires that perform only reads the document and does not modify the stage
+            /// itself.
+
             virtual ~Stage();
 
             virtual int setup() = 0;
@@ -24,6 +31,11 @@ namespace CSMDoc
             virtual void perform (int stage, Messages& messages) = 0;
             ///< Messages resulting from this stage will be appended to \a messages.
 
+            /// Can the steps of this stage be performed concurrently, in any order?
+            ///
+            /// Default-implementation: as passed to the constructor
+            virtual bool isParallel() const;
+
             /// Default-implementation: ignore
             virtual void updateUserSetting (const QString& name, const QStringList& value);
     };
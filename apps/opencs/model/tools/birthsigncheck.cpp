@@ -8,7 +8,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::BirthsignCheckStage::BirthsignCheckStage (const CSMWorld::IdCollection<ESM::BirthSign>& birthsigns)
-: mBirthsigns (birthsigns)
+: CSMDoc::Stage (true), mBirthsigns (birthsigns)
 {}
 
 int CSMTools::BirthsignCheckStage::setup()
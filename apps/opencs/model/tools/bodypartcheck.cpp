@@ -4,6 +4,7 @@ CSMTools::BodyPartCheckStage::BodyPartCheckStage(
         const CSMWorld::IdCollection<ESM::BodyPart> &bodyParts,
         const CSMWorld::Resources                   &meshes,
         const CSMWorld::IdCollection<ESM::Race>     &races ) :
+    CSMDoc::Stage(true),
     mBodyParts(bodyParts),
     mMeshes(meshes),
     mRaces(races)
@@ -9,7 +9,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::ClassCheckStage::ClassCheckStage (const CSMWorld::IdCollection<ESM::Class>& classes)
-: mClasses (classes)
+: CSMDoc::Stage (true), mClasses (classes)
 {}
 
 int CSMTools::ClassCheckStage::setup()
@@ -9,7 +9,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::FactionCheckStage::FactionCheckStage (const CSMWorld::IdCollection<ESM::Faction>& factions)
-: mFactions (factions)
+: CSMDoc::Stage (true), mFactions (factions)
 {}
 
 int CSMTools::FactionCheckStage::setup()
@@ -0,0 +1,149 @@
+#include "incrementalstage.hpp"
+
+#include <components/misc/stringops.hpp>
+
+#include "../world/data.hpp"
+#include "../world/collectionbase.hpp"
+
+void CSMTools::IncrementalStage::commit()
+{
+    if (!mPending)
+        return;
+
+    mPending = false;
+
+    for (std::vector<Result>::const_iterator iter (mResults.begin()); iter!=mResults.end(); ++iter)
+        if (!iter->mDone)
+        {
+            // run has been aborted
+            mValid = false;
+            mCache.clear();
+            return;
+        }
+
+    for (std::vector<Result>::const_iterator iter (mResults.begin()); iter!=mResults.end(); ++iter)
+    {
+        std::vector<CSMDoc::Message>& messages = mCache[iter->mId];
+        messages.insert (messages.end(), iter->mMessages.begin(), iter->mMessages.end());
+    }
+
+    mValid = true;
+    mRevision = mNextRevision;
+}
+
+bool CSMTools::IncrementalStage::isTableChanged (CSMWorld::UniversalId::Type type) const
+{
+    return mData.getRevision (type)>mRevision;
+}
+
+CSMTools::IncrementalStage::IncrementalStage (CSMDoc::Stage *stage, const CSMWorld::Data& data,
+    CSMWorld::UniversalId::Type type, const CSMWorld::CollectionBase *records)
+: mStage (stage), mData (data), mType (type), mRecords (records), mValid (false), mRevision (0),
+  mNextRevision (0), mPending (false)
+{}
+
+CSMTools::IncrementalStage::~IncrementalStage()
+{
+    delete mStage;
+}
+
+void CSMTools::IncrementalStage::addDependency (CSMWorld::UniversalId::Type type)
+{
+    mDependencies.push_back (type);
+}
+
+int CSMTools::IncrementalStage::setup()
+{
+    commit();
+
+    // the wrapped stage is always set up, since it may need to prepare for the steps
+    int size = mStage->setup();
+
+    bool full = !mValid || (!mRecords && isTableChanged (mType));
+
+    for (std::vector<CSMWorld::UniversalId::Type>::const_iterator iter (mDependencies.begin());
+        !full && iter!=mDependencies.end(); ++iter)
+        if (isTableChanged (*iter))
+            full = true;
+
+    mResults.clear();
+    mNextRevision = mData.getRevision();
+    mPending = true;
+
+    if (full)
+    {
+        mCache.clear();
+
+        mResults.resize (size);
+
+        for (int i=0; i<size; ++i)
+        {
+            mResults[i].mStep = i;
+
+            if (mRecords)
+                mResults[i].mId = Misc::StringUtils::lowerCase (mRecords->getId (i));
+        }
+    }
+    else if (mRecords)
+    {
+        // The findings of unchanged records are replayed in the step of their record. Records that
+        // have been removed since the last run are dropped from the cache.
+        mResults.resize (size);
+
+        for (int i=0; i<size; ++i)
+        {
+            Result& result = mResults[i];
+            result.mId = Misc::StringUtils::lowerCase (mRecords->getId (i));
+
+            Cache::iterator iter = mCache.find (result.mId);
+
+            if (iter==mCache.end() || mData.getRevision (mType, result.mId)>mRevision)
+                result.mStep = i;
+            else
+                result.mMessages.swap (iter->second);
+        }
+
+        mCache.clear();
+    }
+    else
+    {
+        // nothing has changed, replay all findings in one step
+        mResults.resize (1);
+        mResults[0].mMessages.swap (mCache[""]);
+        mCache.clear();
+    }
+
+    return mResults.size();
+}
+
+void CSMTools::IncrementalStage::perform (int stage, CSMDoc::Messages& messages)
+{
+    Result& result = mResults.at (stage);
+
+    if (result.mStep==-1)
+    {
+        for (std::vector<CSMDoc::Message>::const_iterator iter (result.mMessages.begin());
+            iter!=result.mMessages.end(); ++iter)
+            messages.add (iter->mId, iter->mMessage, iter->mHint, iter->mSeverity);
+    }
+    else
+    {
+        std::size_t first = messages.end()-messages.begin();
+
+        mStage->perform (result.mStep, messages);
+
+        result.mMessages.assign (messages.begin()+first, messages.end());
+    }
+
+    result.mDone = true;
+}
+
+bool CSMTools::IncrementalStage::isParallel() const
+{
+    return mStage->isParallel();
+}
+
+void CSMTools::IncrementalStage::updateUserSetting (const QString& name, const QStringList& value)
+{
+    mStage->updateUserSetting (name, value);
+}
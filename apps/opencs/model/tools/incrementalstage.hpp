@@ -0,0 +1,91 @@
+#ifndef CSM_TOOLS_INCREMENTALSTAGE_H
+#define CSM_TOOLS_INCREMENTALSTAGE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../doc/stage.hpp"
+
+#include "../world/universalid.hpp"
+
+namespace CSMWorld
+{
+    class Data;
+    class CollectionBase;
+}
+
+namespace CSMTools
+{
+    /// \brief VerifyStage: reuse the findings of another stage from the previous verification
+    ///
+    /// The wrapped stage is performed completely again, if any of the tables it depends on has
+    /// changed since the last complete run. Otherwise, if step n of the wrapped stage checks
+    /// record n of the table it is responsible for, only added and modified records are checked
+    /// again. The findings for all other records are reported in their place, so the messages
+    /// come in the same order as in a complete run.
+    ///
+    /// \note Stages whose findings depend on user settings must not be wrapped.
+    class IncrementalStage : public CSMDoc::Stage
+    {
+            struct Result
+            {
+                int mStep; // of mStage, -1 if the findings are replayed from the cache
+                std::string mId; // lower case
+                std::vector<CSMDoc::Message> mMessages;
+                bool mDone;
+
+                Result() : mStep (-1), mDone (false) {}
+            };
+
+            typedef std::map<std::string, std::vector<CSMDoc::Message> > Cache;
+
+            CSMDoc::Stage *mStage;
+            const CSMWorld::Data& mData;
+            CSMWorld::UniversalId::Type mType;
+            const CSMWorld::CollectionBase *mRecords;
+            std::vector<CSMWorld::UniversalId::Type> mDependencies;
+            Cache mCache; // lower case record ID (empty for stages without records), findings
+            bool mValid;
+            int mRevision; // revision of the data the cache is based on
+            int mNextRevision;
+            bool mPending;
+            std::vector<Result> mResults; // one entry per step of this run
+
+            // not implemented
+            IncrementalStage (const IncrementalStage&);
+            IncrementalStage& operator= (const IncrementalStage&);
+
+            void commit();
+            ///< Merge the findings of the last run into the cache, if it has been completed.
+
+            bool isTableChanged (CSMWorld::UniversalId::Type type) const;
+
+        public:
+
+            IncrementalStage (CSMDoc::Stage *stage, const CSMWorld::Data& data,
+                CSMWorld::UniversalId::Type type, const CSMWorld::CollectionBase *records = 0);
+            ///< The ownership of \a stage is transferred to *this.
+            ///
+            /// \param type Table checked by \a stage
+            /// \param records Collection for \a type, if step n of \a stage checks record n of
+            /// it. 0, if \a stage can only be performed as a whole.
+
+            virtual ~IncrementalStage();
+
+            void addDependency (CSMWorld::UniversalId::Type type);
+            ///< A change to table \a type invalidates all findings of the wrapped stage.
+
+            virtual int setup();
+            ///< \return number of steps
+
+            virtual void perform (int stage, CSMDoc::Messages& messages);
+            ///< Messages resulting from this stage will be appended to \a messages.
+
+            virtual bool isParallel() const;
+
+            virtual void updateUserSetting (const QString& name, const QStringList& value);
+    };
+}
+
+#endif
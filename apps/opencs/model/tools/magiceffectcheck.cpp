@@ -72,7 +72,7 @@ CSMTools::MagicEffectCheckStage::MagicEffectCheckStage(const CSMWorld::IdCollect
                                                        const CSMWorld::RefIdCollection &referenceables,
                                                        const CSMWorld::Resources &icons,
                                                        const CSMWorld::Resources &textures)
-    : mMagicEffects(effects),
+    : CSMDoc::Stage(true), mMagicEffects(effects),
       mSounds(sounds),
       mReferenceables(referenceables),
       mIcons(icons),
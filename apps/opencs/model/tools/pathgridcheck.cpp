@@ -9,7 +9,7 @@
 #include "../world/pathgrid.hpp"
 
 CSMTools::PathgridCheckStage::PathgridCheckStage (const CSMWorld::SubCellCollection<CSMWorld::Pathgrid>& pathgrids)
-: mPathgrids (pathgrids)
+: CSMDoc::Stage (true), mPathgrids (pathgrids)
 {}
 
 int CSMTools::PathgridCheckStage::setup()
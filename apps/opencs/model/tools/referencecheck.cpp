@@ -8,6 +8,7 @@ CSMTools::ReferenceCheckStage::ReferenceCheckStage(
     const CSMWorld::IdCollection<CSMWorld::Cell>& cells,
     const CSMWorld::IdCollection<ESM::Faction>& factions)
     :
+    CSMDoc::Stage(true),
     mReferences(references),
     mReferencables(referencables),
     mDataSet(referencables.getDataSet()),
@@ -8,7 +8,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::RegionCheckStage::RegionCheckStage (const CSMWorld::IdCollection<ESM::Region>& regions)
-: mRegions (regions)
+: CSMDoc::Stage (true), mRegions (regions)
 {}
 
 int CSMTools::RegionCheckStage::setup()
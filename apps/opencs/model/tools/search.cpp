@@ -248,6 +248,16 @@ void CSMTools::Search::setPadding (int before, int after)
     mPaddingAfter = after;
 }
 
+CSMTools::Search::Type CSMTools::Search::getType() const
+{
+    return mType;
+}
+
+const std::string& CSMTools::Search::getText() const
+{
+    return mText;
+}
+
 void CSMTools::Search::replace (CSMDoc::Document& document, CSMWorld::IdTableBase *model,
     const CSMWorld::UniversalId& id, const std::string& messageHint,
     const std::string& replaceText) const
@@ -84,6 +84,11 @@ namespace CSMTools
 
             void setPadding (int before, int after);
 
+            Type getType() const;
+
+            /// Return the text searched for by Type_Text and Type_Id searches.
+            const std::string& getText() const;
+
             // Configuring *this for the model is not necessary when calling this function.
             void replace (CSMDoc::Document& document, CSMWorld::IdTableBase *model,
                 const CSMWorld::UniversalId& id, const std::string& messageHint,
@@ -0,0 +1,242 @@
+#include "searchindex.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QString>
+
+#include <components/misc/stringops.hpp>
+
+#include "../world/data.hpp"
+#include "../world/idtablebase.hpp"
+#include "../world/columnbase.hpp"
+
+namespace
+{
+    bool isShorter (const std::vector<int> *left, const std::vector<int> *right)
+    {
+        return left->size()<right->size();
+    }
+}
+
+void CSMTools::SearchIndex::getTrigrams (const QString& text, std::vector<Trigram>& trigrams)
+{
+    // same folding as the Qt::CaseInsensitive comparison used by the search itself
+    QByteArray folded = text.toCaseFolded().toUtf8();
+
+    Trigram trigram = 0;
+
+    for (int i=0; i<folded.size(); ++i)
+    {
+        trigram = ((trigram<<8) | static_cast<unsigned char> (folded[i])) & 0xffffff;
+
+        if (i>=2)
+            trigrams.push_back (trigram);
+    }
+}
+
+void CSMTools::SearchIndex::index (int slot, int row)
+{
+    Record& record = mRecords[slot];
+
+    record.mTrigrams.clear();
+
+    for (std::vector<int>::const_iterator iter (mColumns.begin()); iter!=mColumns.end(); ++iter)
+        getTrigrams (mModel.data (mModel.index (row, *iter)).toString(), record.mTrigrams);
+
+    std::sort (record.mTrigrams.begin(), record.mTrigrams.end());
+    record.mTrigrams.erase (std::unique (record.mTrigrams.begin(), record.mTrigrams.end()),
+        record.mTrigrams.end());
+
+    for (std::vector<Trigram>::const_iterator iter (record.mTrigrams.begin());
+        iter!=record.mTrigrams.end(); ++iter)
+    {
+        std::vector<int>& records = mPostings[*iter];
+
+        // slots are handed out in ascending order while building, so this is usually an append
+        if (records.empty() || records.back()<slot)
+            records.push_back (slot);
+        else
+            records.insert (std::lower_bound (records.begin(), records.end(), slot), slot);
+    }
+}
+
+void CSMTools::SearchIndex::unindex (int slot)
+{
+    Record& record = mRecords[slot];
+
+    for (std::vector<Trigram>::const_iterator iter (record.mTrigrams.begin());
+        iter!=record.mTrigrams.end(); ++iter)
+    {
+        std::map<Trigram, std::vector<int> >::iterator postings = mPostings.find (*iter);
+
+        std::vector<int>::iterator slot2 =
+            std::lower_bound (postings->second.begin(), postings->second.end(), slot);
+
+        postings->second.erase (slot2);
+
+        if (postings->second.empty())
+            mPostings.erase (postings);
+    }
+
+    record.mTrigrams.clear();
+}
+
+void CSMTools::SearchIndex::add (int row, const std::string& id)
+{
+    int slot;
+
+    if (mFree.empty())
+    {
+        slot = static_cast<int> (mRecords.size());
+        mRecords.push_back (Record());
+    }
+    else
+    {
+        slot = mFree.back();
+        mFree.pop_back();
+    }
+
+    mRecords[slot].mId = id;
+    mRecords[slot].mSeen = true;
+    mSlots.insert (std::make_pair (Misc::StringUtils::lowerCase (id), slot));
+
+    index (slot, row);
+}
+
+void CSMTools::SearchIndex::remove (int slot)
+{
+    unindex (slot);
+
+    mSlots.erase (Misc::StringUtils::lowerCase (mRecords[slot].mId));
+    mRecords[slot].mId.clear();
+    mFree.push_back (slot);
+}
+
+void CSMTools::SearchIndex::build()
+{
+    mRevision = mData.getRevision();
+
+    mColumns.clear();
+
+    int columns = mModel.columnCount();
+
+    for (int i=0; i<columns; ++i)
+    {
+        CSMWorld::ColumnBase::Display display = static_cast<CSMWorld::ColumnBase::Display> (
+            mModel.headerData (
+            i, Qt::Horizontal, static_cast<int> (CSMWorld::ColumnBase::Role_Display)).toInt());
+
+        if (CSMWorld::ColumnBase::isText (display) || CSMWorld::ColumnBase::isId (display) ||
+            CSMWorld::ColumnBase::isScript (display))
+            mColumns.push_back (i);
+    }
+
+    mIdColumn = mModel.findColumnIndex (CSMWorld::Columns::ColumnId_Id);
+
+    int rows = mModel.rowCount();
+
+    mRecords.reserve (rows);
+
+    for (int i=0; i<rows; ++i)
+        add (i, mModel.data (mModel.index (i, mIdColumn)).toString().toUtf8().constData());
+
+    mBuilt = true;
+}
+
+void CSMTools::SearchIndex::update()
+{
+    if (!mBuilt)
+    {
+        build();
+        return;
+    }
+
+    if (mData.getRevision (mType)<=mRevision)
+        return;
+
+    int revision = mData.getRevision();
+
+    for (std::vector<Record>::iterator iter (mRecords.begin()); iter!=mRecords.end(); ++iter)
+        iter->mSeen = false;
+
+    int rows = mModel.rowCount();
+
+    for (int i=0; i<rows; ++i)
+    {
+        std::string id = mModel.data (mModel.index (i, mIdColumn)).toString().toUtf8().constData();
+
+        std::map<std::string, int>::const_iterator iter =
+            mSlots.find (Misc::StringUtils::lowerCase (id));
+
+        if (iter==mSlots.end())
+            add (i, id);
+        else
+        {
+            mRecords[iter->second].mSeen = true;
+
+            if (mData.getRevision (mType, id)>mRevision)
+            {
+                unindex (iter->second);
+                index (iter->second, i);
+            }
+        }
+    }
+
+    for (int i=0; i<static_cast<int> (mRecords.size()); ++i)
+        if (!mRecords[i].mSeen && !mRecords[i].mId.empty())
+            remove (i);
+
+    mRevision = revision;
+}
+
+CSMTools::SearchIndex::SearchIndex (const CSMWorld::IdTableBase& model,
+    const CSMWorld::Data& data, CSMWorld::UniversalId::Type type)
+: mModel (model), mData (data), mType (type), mBuilt (false), mRevision (0), mIdColumn (-1)
+{}
+
+bool CSMTools::SearchIndex::find (const std::string& text, std::vector<int>& rows)
+{
+    std::vector<Trigram> trigrams;
+    getTrigrams (QString::fromUtf8 (text.c_str()), trigrams);
+
+    if (trigrams.empty())
+        return false;
+
+    update();
+
+    // intersect, starting with the shortest list
+    std::vector<const std::vector<int> *> postings;
+
+    for (std::vector<Trigram>::const_iterator iter (trigrams.begin()); iter!=trigrams.end(); ++iter)
+    {
+        std::map<Trigram, std::vector<int> >::const_iterator postings2 = mPostings.find (*iter);
+
+        if (postings2==mPostings.end())
+            return true;
+
+        postings.push_back (&postings2->second);
+    }
+
+    std::sort (postings.begin(), postings.end(), isShorter);
+
+    std::vector<int> records (*postings.front());
+
+    for (std::vector<const std::vector<int> *>::const_iterator iter (postings.begin()+1);
+        iter!=postings.end() && !records.empty(); ++iter)
+    {
+        std::vector<int> records2;
+        std::set_intersection (records.begin(), records.end(), (*iter)->begin(), (*iter)->end(),
+            std::back_inserter (records2));
+        records.swap (records2);
+    }
+
+    std::size_t size = rows.size();
+
+    for (std::vector<int>::const_iterator iter (records.begin()); iter!=records.end(); ++iter)
+        rows.push_back (mModel.getModelIndex (mRecords[*iter].mId, mIdColumn).row());
+
+    std::sort (rows.begin()+size, rows.end());
+
+    return true;
+}
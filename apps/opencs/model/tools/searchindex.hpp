@@ -0,0 +1,85 @@
+#ifndef CSM_TOOLS_SEARCHINDEX_H
+#define CSM_TOOLS_SEARCHINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../world/universalid.hpp"
+
+class QString;
+
+namespace CSMWorld
+{
+    class Data;
+    class IdTableBase;
+}
+
+namespace CSMTools
+{
+    /// \brief Inverted index of the trigrams in the text, ID and script columns of a table
+    ///
+    /// Used for narrowing down the rows that need to be searched for a text or an ID. The trigrams
+    /// are taken from the UTF-8 bytes of the case-folded text, so that every case-insensitive match
+    /// of the search text contains all of its trigrams. The index is built on first use and
+    /// afterwards only changed records are indexed again.
+    class SearchIndex
+    {
+            typedef unsigned int Trigram;
+
+            struct Record
+            {
+                std::string mId; // empty for unused slots
+                std::vector<Trigram> mTrigrams;
+                bool mSeen;
+
+                Record() : mSeen (false) {}
+            };
+
+            const CSMWorld::IdTableBase& mModel;
+            const CSMWorld::Data& mData;
+            CSMWorld::UniversalId::Type mType;
+            bool mBuilt;
+            int mRevision;
+            std::vector<int> mColumns;
+            int mIdColumn;
+            std::vector<Record> mRecords;
+            std::vector<int> mFree; // unused slots in mRecords
+            std::map<std::string, int> mSlots; // lower case ID, index into mRecords
+            std::map<Trigram, std::vector<int> > mPostings; // sorted indices into mRecords
+
+            // not implemented
+            SearchIndex (const SearchIndex&);
+            SearchIndex& operator= (const SearchIndex&);
+
+            static void getTrigrams (const QString& text, std::vector<Trigram>& trigrams);
+            ///< Append the trigrams of \a text (case-folded) to \a trigrams.
+
+            void index (int slot, int row);
+
+            void unindex (int slot);
+
+            void add (int row, const std::string& id);
+
+            void remove (int slot);
+
+            void build();
+
+            void update();
+            ///< Index records that have been added or modified since the last update.
+
+        public:
+
+            SearchIndex (const CSMWorld::IdTableBase& model, const CSMWorld::Data& data,
+                CSMWorld::UniversalId::Type type);
+
+            /// Add all rows that may contain \a text (case-insensitive) to \a rows, in ascending
+            /// order.
+            ///
+            /// \return Can the index be used for \a text? If not, \a rows is left unchanged and all
+            /// rows need to be searched.
+            bool find (const std::string& text, std::vector<int>& rows);
+    };
+}
+
+#endif
@@ -19,7 +19,7 @@ CSMTools::SearchOperation::SearchOperation (CSMDoc::Document& document)
     for (std::vector<CSMWorld::UniversalId::Type>::const_iterator iter (types.begin());
         iter!=types.end(); ++iter)
         appendStage (new SearchStage (&dynamic_cast<CSMWorld::IdTableBase&> (
-            *document.getData().getTableModel (*iter))));
+            *document.getData().getTableModel (*iter)), document.getData(), *iter));
 
     setDefaultSeverity (CSMDoc::Message::Severity_Info);
 }
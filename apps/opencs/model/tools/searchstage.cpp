@@ -4,8 +4,9 @@
 
 #include "searchoperation.hpp"
 
-CSMTools::SearchStage::SearchStage (const CSMWorld::IdTableBase *model)
-: mModel (model), mOperation (0)
+CSMTools::SearchStage::SearchStage (const CSMWorld::IdTableBase *model,
+    const CSMWorld::Data& data, CSMWorld::UniversalId::Type type)
+: mModel (model), mOperation (0), mIndex (*model, data, type), mIndexed (false)
 {}
 
 int CSMTools::SearchStage::setup()
@@ -14,13 +15,19 @@ int CSMTools::SearchStage::setup()
         mSearch = mOperation->getSearch();
 
     mSearch.configure (mModel);
-        
-    return mModel->rowCount();
+
+    // Plain text and ID searches only need to look at rows containing all trigrams of the
+    // search text. Everything else requires a full scan.
+    mRows.clear();
+    mIndexed = (mSearch.getType()==Search::Type_Text || mSearch.getType()==Search::Type_Id) &&
+        mIndex.find (mSearch.getText(), mRows);
+
+    return mIndexed ? mRows.size() : mModel->rowCount();
 }
 
 void CSMTools::SearchStage::perform (int stage, CSMDoc::Messages& messages)
 {
-    mSearch.searchRow (mModel, stage, messages);
+    mSearch.searchRow (mModel, mIndexed ? mRows[stage] : stage, messages);
 }
 
 void CSMTools::SearchStage::setOperation (const SearchOperation *operation)
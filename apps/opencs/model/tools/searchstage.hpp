@@ -1,12 +1,16 @@
 #ifndef CSM_TOOLS_SEARCHSTAGE_H
 #define CSM_TOOLS_SEARCHSTAGE_H
 
+#include <vector>
+
 #include "../doc/stage.hpp"
 
 #include "search.hpp"
+#include "searchindex.hpp"
 
 namespace CSMWorld
 {
+    class Data;
     class IdTableBase;
 }
 
@@ -19,10 +23,15 @@ namespace CSMTools
             const CSMWorld::IdTableBase *mModel;
             Search mSearch;
             const SearchOperation *mOperation;
+            SearchIndex mIndex;
+            bool mIndexed;
+            std::vector<int> mRows; // rows to search, if mIndexed
 
         public:
 
-            SearchStage (const CSMWorld::IdTableBase *model);
+            SearchStage (const CSMWorld::IdTableBase *model, const CSMWorld::Data& data,
+                CSMWorld::UniversalId::Type type);
+            ///< \param type Type of \a model
 
             virtual int setup();
             ///< \return number of steps
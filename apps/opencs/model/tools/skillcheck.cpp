@@ -7,7 +7,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::SkillCheckStage::SkillCheckStage (const CSMWorld::IdCollection<ESM::Skill>& skills)
-: mSkills (skills)
+: CSMDoc::Stage (true), mSkills (skills)
 {}
 
 int CSMTools::SkillCheckStage::setup()
@@ -7,7 +7,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::SoundCheckStage::SoundCheckStage (const CSMWorld::IdCollection<ESM::Sound>& sounds)
-: mSounds (sounds)
+: CSMDoc::Stage (true), mSounds (sounds)
 {}
 
 int CSMTools::SoundCheckStage::setup()
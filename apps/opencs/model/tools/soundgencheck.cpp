@@ -8,7 +8,7 @@
 CSMTools::SoundGenCheckStage::SoundGenCheckStage(const CSMWorld::IdCollection<ESM::SoundGenerator> &soundGens,
                                                  const CSMWorld::IdCollection<ESM::Sound> &sounds,
                                                  const CSMWorld::RefIdCollection &referenceables)
-    : mSoundGens(soundGens),
+    : CSMDoc::Stage(true), mSoundGens(soundGens),
       mSounds(sounds),
       mReferenceables(referenceables)
 {}
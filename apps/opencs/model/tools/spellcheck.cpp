@@ -8,7 +8,7 @@
 #include "../world/universalid.hpp"
 
 CSMTools::SpellCheckStage::SpellCheckStage (const CSMWorld::IdCollection<ESM::Spell>& spells)
-: mSpells (spells)
+: CSMDoc::Stage (true), mSpells (spells)
 {}
 
 int CSMTools::SpellCheckStage::setup()
@@ -5,7 +5,7 @@
 CSMTools::StartScriptCheckStage::StartScriptCheckStage (
     const CSMWorld::IdCollection<ESM::StartScript>& startScripts,
     const CSMWorld::IdCollection<ESM::Script>& scripts)
-: mStartScripts (startScripts), mScripts (scripts)
+: CSMDoc::Stage (true), mStartScripts (startScripts), mScripts (scripts)
 {}
 
 void CSMTools::StartScriptCheckStage::perform(int stage, CSMDoc::Messages& messages)
@@ -28,6 +28,7 @@
 #include "pathgridcheck.hpp"
 #include "soundgencheck.hpp"
 #include "magiceffectcheck.hpp"
+#include "incrementalstage.hpp"
 
 CSMDoc::OperationHolder *CSMTools::Tools::get (int type)
 {
@@ -68,51 +69,95 @@ CSMDoc::OperationHolder *CSMTools::Tools::getVerifier()
         mandatoryIds.push_back ("Month");
         mandatoryIds.push_back ("PCRace");
 
-        mVerifierOperation->appendStage (new MandatoryIdStage (mData.getGlobals(),
-            CSMWorld::UniversalId (CSMWorld::UniversalId::Type_Globals), mandatoryIds));
+        // Stages are wrapped into IncrementalStages, so that findings for unchanged records can
+        // be reused when the verifier is run again.
+        IncrementalStage *stage = new IncrementalStage (new MandatoryIdStage (mData.getGlobals(),
+            CSMWorld::UniversalId (CSMWorld::UniversalId::Type_Globals), mandatoryIds),
+            mData, CSMWorld::UniversalId::Type_Globals);
+        mVerifierOperation->appendStage (stage);
 
-        mVerifierOperation->appendStage (new SkillCheckStage (mData.getSkills()));
+        mVerifierOperation->appendStage (new IncrementalStage (new SkillCheckStage (mData.getSkills()),
+            mData, CSMWorld::UniversalId::Type_Skills, &mData.getSkills()));
 
-        mVerifierOperation->appendStage (new ClassCheckStage (mData.getClasses()));
+        mVerifierOperation->appendStage (new IncrementalStage (new ClassCheckStage (mData.getClasses()),
+            mData, CSMWorld::UniversalId::Type_Classes, &mData.getClasses()));
 
-        mVerifierOperation->appendStage (new FactionCheckStage (mData.getFactions()));
+        mVerifierOperation->appendStage (new IncrementalStage (new FactionCheckStage (mData.getFactions()),
+            mData, CSMWorld::UniversalId::Type_Factions, &mData.getFactions()));
 
-        mVerifierOperation->appendStage (new RaceCheckStage (mData.getRaces()));
+        // checks across all races in its last step
+        mVerifierOperation->appendStage (new IncrementalStage (new RaceCheckStage (mData.getRaces()),
+            mData, CSMWorld::UniversalId::Type_Races));
 
-        mVerifierOperation->appendStage (new SoundCheckStage (mData.getSounds()));
+        mVerifierOperation->appendStage (new IncrementalStage (new SoundCheckStage (mData.getSounds()),
+            mData, CSMWorld::UniversalId::Type_Sounds, &mData.getSounds()));
 
-        mVerifierOperation->appendStage (new RegionCheckStage (mData.getRegions()));
+        mVerifierOperation->appendStage (new IncrementalStage (new RegionCheckStage (mData.getRegions()),
+            mData, CSMWorld::UniversalId::Type_Regions, &mData.getRegions()));
 
-        mVerifierOperation->appendStage (new BirthsignCheckStage (mData.getBirthsigns()));
+        mVerifierOperation->appendStage (new IncrementalStage (new BirthsignCheckStage (mData.getBirthsigns()),
+            mData, CSMWorld::UniversalId::Type_Birthsigns, &mData.getBirthsigns()));
 
-        mVerifierOperation->appendStage (new SpellCheckStage (mData.getSpells()));
+        mVerifierOperation->appendStage (new IncrementalStage (new SpellCheckStage (mData.getSpells()),
+            mData, CSMWorld::UniversalId::Type_Spells, &mData.getSpells()));
 
-        mVerifierOperation->appendStage (new ReferenceableCheckStage (mData.getReferenceables().getDataSet(), mData.getRaces(), mData.getClasses(), mData.getFactions(), mData.getScripts()));
+        // checks across all referenceables in its last step
+        stage = new IncrementalStage (new ReferenceableCheckStage (mData.getReferenceables().getDataSet(), mData.getRaces(), mData.getClasses(), mData.getFactions(), mData.getScripts()),
+            mData, CSMWorld::UniversalId::Type_Referenceables);
+        stage->addDependency (CSMWorld::UniversalId::Type_Races);
+        stage->addDependency (CSMWorld::UniversalId::Type_Classes);
+        stage->addDependency (CSMWorld::UniversalId::Type_Factions);
+        stage->addDependency (CSMWorld::UniversalId::Type_Scripts);
+        mVerifierOperation->appendStage (stage);
 
-        mVerifierOperation->appendStage (new ReferenceCheckStage(mData.getReferences(), mData.getReferenceables(), mData.getCells(), mData.getFactions()));
+        stage = new IncrementalStage (new ReferenceCheckStage(mData.getReferences(), mData.getReferenceables(), mData.getCells(), mData.getFactions()),
+            mData, CSMWorld::UniversalId::Type_References, &mData.getReferences());
+        stage->addDependency (CSMWorld::UniversalId::Type_Referenceables);
+        stage->addDependency (CSMWorld::UniversalId::Type_Cells);
+        stage->addDependency (CSMWorld::UniversalId::Type_Factions);
+        mVerifierOperation->appendStage (stage);
 
+        // scripts can refer to any ID and the findings depend on user settings
         mVerifierOperation->appendStage (new ScriptCheckStage (mDocument));
 
-        mVerifierOperation->appendStage (new StartScriptCheckStage (mData.getStartScripts(), mData.getScripts()));
+        stage = new IncrementalStage (new StartScriptCheckStage (mData.getStartScripts(), mData.getScripts()),
+            mData, CSMWorld::UniversalId::Type_StartScripts, &mData.getStartScripts());
+        stage->addDependency (CSMWorld::UniversalId::Type_Scripts);
+        mVerifierOperation->appendStage (stage);
 
-        mVerifierOperation->appendStage(
+        stage = new IncrementalStage (
             new BodyPartCheckStage(
                 mData.getBodyParts(),
                 mData.getResources(
                     CSMWorld::UniversalId( CSMWorld::UniversalId::Type_Meshes )),
-                mData.getRaces() ));
-
-        mVerifierOperation->appendStage (new PathgridCheckStage (mData.getPathgrids()));
-
-        mVerifierOperation->appendStage (new SoundGenCheckStage (mData.getSoundGens(),
+                mData.getRaces() ),
+            mData, CSMWorld::UniversalId::Type_BodyParts, &mData.getBodyParts());
+        stage->addDependency (CSMWorld::UniversalId::Type_Meshes);
+        stage->addDependency (CSMWorld::UniversalId::Type_Races);
+        mVerifierOperation->appendStage (stage);
+
+        mVerifierOperation->appendStage (new IncrementalStage (new PathgridCheckStage (mData.getPathgrids()),
+            mData, CSMWorld::UniversalId::Type_Pathgrids, &mData.getPathgrids()));
+
+        stage = new IncrementalStage (new SoundGenCheckStage (mData.getSoundGens(),
+                                                              mData.getSounds(),
+                                                              mData.getReferenceables()),
+            mData, CSMWorld::UniversalId::Type_SoundGens, &mData.getSoundGens());
+        stage->addDependency (CSMWorld::UniversalId::Type_Sounds);
+        stage->addDependency (CSMWorld::UniversalId::Type_Referenceables);
+        mVerifierOperation->appendStage (stage);
+
+        stage = new IncrementalStage (new MagicEffectCheckStage (mData.getMagicEffects(),
                                                                  mData.getSounds(),
-                                                                 mData.getReferenceables()));
-
-        mVerifierOperation->appendStage (new MagicEffectCheckStage (mData.getMagicEffects(),
-                                                                    mData.getSounds(),
-                                                                    mData.getReferenceables(),
-                                                                    mData.getResources (CSMWorld::UniversalId::Type_Icons),
-                                                                    mData.getResources (CSMWorld::UniversalId::Type_Textures)));
+                                                                 mData.getReferenceables(),
+                                                                 mData.getResources (CSMWorld::UniversalId::Type_Icons),
+                                                                 mData.getResources (CSMWorld::UniversalId::Type_Textures)),
+            mData, CSMWorld::UniversalId::Type_MagicEffects, &mData.getMagicEffects());
+        stage->addDependency (CSMWorld::UniversalId::Type_Sounds);
+        stage->addDependency (CSMWorld::UniversalId::Type_Referenceables);
+        stage->addDependency (CSMWorld::UniversalId::Type_Icons);
+        stage->addDependency (CSMWorld::UniversalId::Type_Textures);
+        mVerifierOperation->appendStage (stage);
 
         mVerifier.setOperation (mVerifierOperation);
     }
@@ -162,6 +207,10 @@ CSMWorld::UniversalId CSMTools::Tools::runVerifier (const CSMWorld::UniversalId&
         
     mActiveReports[CSMDoc::State_Verifying] = reportNumber;
 
+    // Some stages look up records from several threads. Do the lazy row updates now, while the
+    // document can not be modified concurrently.
+    mData.updateRows();
+
     getVerifier()->start();
 
     return CSMWorld::UniversalId (CSMWorld::UniversalId::Type_VerificationResults, reportNumber);
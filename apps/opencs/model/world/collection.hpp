@@ -3,12 +3,17 @@
 
 #include <vector>
 #include <map>
+#include <memory>
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
 #include <functional>
 
+#include <boost/iterator/indirect_iterator.hpp>
+
 #include <QVariant>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include <components/misc/stringops.hpp>
 
@@ -40,22 +45,64 @@ namespace CSMWorld
     }
 
     /// \brief Single-type record collection
+    ///
+    /// Each record is stored in its own slot, whose address does not change for as long as the
+    /// record is part of the collection. Inserting, removing or reordering rows only moves
+    /// pointers. Row numbers cached in the slots are updated lazily, the next time an ID has
+    /// to be mapped to a row.
+    ///
+    /// Const functions may be called from several threads at once only while no thread modifies the
+    /// collection and the cached rows are up to date (see updateRows()). Otherwise const callers can
+    /// update the cached rows, which is not synchronised with readers that take the fast path.
     template<typename ESXRecordT, typename IdAccessorT = IdAccessor<ESXRecordT> >
     class Collection : public CollectionBase
     {
-            std::vector<Record<ESXRecordT> > mRecords;
-            std::map<std::string, int> mIndex;
+        protected:
+
+            struct Slot;
+
+            typedef std::map<std::string, Slot *> IdMap;
+
+            struct Slot : public Record<ESXRecordT>
+            {
+                typename IdMap::iterator mIndexEntry;
+                int mRow; ///< Might be outdated, see getRow()
+
+                Slot (const Record<ESXRecordT>& record) : Record<ESXRecordT> (record), mRow (-1) {}
+            };
+
+        public:
+
+            typedef boost::indirect_iterator<typename std::vector<Slot *>::const_iterator,
+                const Record<ESXRecordT> > RecordConstIterator;
+
+        private:
+
+            std::vector<Slot *> mRecords;
+            IdMap mIndex;
             std::vector<Column<ESXRecordT> *> mColumns;
 
+            // Cached rows are valid for all slots with mRow below this value.
+            mutable int mFirstDirtyRow;
+            mutable QMutex mRowMutex; // serialises const callers that update outdated rows
+
             // not implemented
             Collection (const Collection&);
             Collection& operator= (const Collection&);
 
+            void setDirty (int row);
+            ///< Rows from \a row on have been moved.
+
         protected:
 
-            const std::map<std::string, int>& getIdMap() const;
+            const IdMap& getIdMap() const;
+            ///< Keys are lower case IDs.
+
+            int getRow (const Slot *slot) const;
 
-            const std::vector<Record<ESXRecordT> >& getRecords() const;
+            RecordConstIterator getRecordsBegin() const;
+
+            RecordConstIterator getRecordsEnd() const;
 
             bool reorderRowsImp (int baseIndex, const std::vector<int>& newOrder);
             ///< Reorder the rows [baseIndex, baseIndex+newOrder.size()) according to the indices
@@ -106,6 +153,8 @@ namespace CSMWorld
             ////< Search record with \a id.
             /// \return index of record (if found) or -1 (not found)
 
+            virtual void updateRows() const;
+
             virtual void replace (int index, const RecordBase& record);
             ///< If the record type does not match, an exception is thrown.
             ///
@@ -153,15 +202,59 @@ namespace CSMWorld
     };
 
     template<typename ESXRecordT, typename IdAccessorT>
-    const std::map<std::string, int>& Collection<ESXRecordT, IdAccessorT>::getIdMap() const
+    void Collection<ESXRecordT, IdAccessorT>::setDirty (int row)
+    {
+        if (row<mFirstDirtyRow)
+            mFirstDirtyRow = row;
+    }
+
+    template<typename ESXRecordT, typename IdAccessorT>
+    const typename Collection<ESXRecordT, IdAccessorT>::IdMap&
+        Collection<ESXRecordT, IdAccessorT>::getIdMap() const
     {
         return mIndex;
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
-    const std::vector<Record<ESXRecordT> >& Collection<ESXRecordT, IdAccessorT>::getRecords() const
+    int Collection<ESXRecordT, IdAccessorT>::getRow (const Slot *slot) const
+    {
+        // A slot that has been moved since the last update has a cached row of at least
+        // mFirstDirtyRow, because only rows at or after an insertion/removal point move.
+        //
+        // Concurrent readers (e.g. parallel verifier stages) must only take the fast path, which
+        // reads without the lock. The verifier brings the rows up to date by calling updateRows()
+        // before it starts, and the document is not modified while it runs.
+        if (slot->mRow>=mFirstDirtyRow)
+            updateRows();
+
+        return slot->mRow;
+    }
+
+    template<typename ESXRecordT, typename IdAccessorT>
+    void Collection<ESXRecordT, IdAccessorT>::updateRows() const
     {
-        return mRecords;
+        QMutexLocker lock (&mRowMutex);
+
+        int size = static_cast<int> (mRecords.size());
+
+        for (int i=mFirstDirtyRow; i<size; ++i)
+            mRecords[i]->mRow = i;
+
+        mFirstDirtyRow = size;
+    }
+
+    template<typename ESXRecordT, typename IdAccessorT>
+    typename Collection<ESXRecordT, IdAccessorT>::RecordConstIterator
+        Collection<ESXRecordT, IdAccessorT>::getRecordsBegin() const
+    {
+        return RecordConstIterator (mRecords.begin());
+    }
+
+    template<typename ESXRecordT, typename IdAccessorT>
+    typename Collection<ESXRecordT, IdAccessorT>::RecordConstIterator
+        Collection<ESXRecordT, IdAccessorT>::getRecordsEnd() const
+    {
+        return RecordConstIterator (mRecords.end());
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -179,21 +272,17 @@ namespace CSMWorld
                 return false;
 
             // reorder records
-            std::vector<Record<ESXRecordT> > buffer (size);
+            std::vector<Slot *> buffer (size);
 
             for (int i=0; i<size; ++i)
             {
                 buffer[newOrder[i]] = mRecords [baseIndex+i];
-                buffer[newOrder[i]].setModified (buffer[newOrder[i]].get());
+                buffer[newOrder[i]]->setModified (buffer[newOrder[i]]->get());
             }
 
             std::copy (buffer.begin(), buffer.end(), mRecords.begin()+baseIndex);
 
-            // adjust index
-            for (std::map<std::string, int>::iterator iter (mIndex.begin()); iter!=mIndex.end();
-                 ++iter)
-                if (iter->second>=baseIndex && iter->second<baseIndex+size)
-                    iter->second = newOrder.at (iter->second-baseIndex)+baseIndex;
+            setDirty (baseIndex);
         }
 
         return true;
@@ -214,6 +303,7 @@ namespace CSMWorld
 
     template<typename ESXRecordT, typename IdAccessorT>
     Collection<ESXRecordT, IdAccessorT>::Collection()
+    : mFirstDirtyRow (0)
     {}
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -221,6 +311,9 @@ namespace CSMWorld
     {
         for (typename std::vector<Column<ESXRecordT> *>::iterator iter (mColumns.begin()); iter!=mColumns.end(); ++iter)
             delete *iter;
+
+        for (typename std::vector<Slot *>::iterator iter (mRecords.begin()); iter!=mRecords.end(); ++iter)
+            delete *iter;
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -228,7 +321,7 @@ namespace CSMWorld
     {
         std::string id = Misc::StringUtils::lowerCase (IdAccessorT().getId (record));
 
-        std::map<std::string, int>::iterator iter = mIndex.find (id);
+        typename IdMap::iterator iter = mIndex.find (id);
 
         if (iter==mIndex.end())
         {
@@ -240,7 +333,7 @@ namespace CSMWorld
         }
         else
         {
-            mRecords[iter->second].setModified (record);
+            iter->second->setModified (record);
         }
     }
 
@@ -253,7 +346,7 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     std::string Collection<ESXRecordT, IdAccessorT>::getId (int index) const
     {
-        return IdAccessorT().getId (mRecords.at (index).get());
+        return IdAccessorT().getId (mRecords.at (index)->get());
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -276,13 +369,13 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     QVariant Collection<ESXRecordT, IdAccessorT>::getData (int index, int column) const
     {
-        return mColumns.at (column)->get (mRecords.at (index));
+        return mColumns.at (column)->get (*mRecords.at (index));
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::setData (int index, int column, const QVariant& data)
     {
-        return mColumns.at (column)->set (mRecords.at (index), data);
+        return mColumns.at (column)->set (*mRecords.at (index), data);
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -309,8 +402,8 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::merge()
     {
-        for (typename std::vector<Record<ESXRecordT> >::iterator iter (mRecords.begin()); iter!=mRecords.end(); ++iter)
-            iter->merge();
+        for (typename std::vector<Slot *>::iterator iter (mRecords.begin()); iter!=mRecords.end(); ++iter)
+            (*iter)->merge();
 
         purge();
     }
@@ -318,41 +411,44 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     void  Collection<ESXRecordT, IdAccessorT>::purge()
     {
-        int i = 0;
+        // remove all erased records in a single pass
+        typename std::vector<Slot *>::iterator out = mRecords.begin();
 
-        while (i<static_cast<int> (mRecords.size()))
+        for (typename std::vector<Slot *>::iterator iter (mRecords.begin()); iter!=mRecords.end(); ++iter)
         {
-            if (mRecords[i].isErased())
-                removeRows (i, 1);
+            if ((*iter)->isErased())
+            {
+                setDirty (static_cast<int> (out-mRecords.begin()));
+
+                if ((*iter)->mIndexEntry!=mIndex.end())
+                    mIndex.erase ((*iter)->mIndexEntry);
+
+                delete *iter;
+            }
             else
-                ++i;
+                *out++ = *iter;
         }
+
+        mRecords.erase (out, mRecords.end());
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::removeRows (int index, int count)
     {
-        mRecords.erase (mRecords.begin()+index, mRecords.begin()+index+count);
+        typename std::vector<Slot *>::iterator begin = mRecords.begin()+index;
+        typename std::vector<Slot *>::iterator end = begin+count;
 
-        typename std::map<std::string, int>::iterator iter = mIndex.begin();
-
-        while (iter!=mIndex.end())
+        for (typename std::vector<Slot *>::iterator iter (begin); iter!=end; ++iter)
         {
-            if (iter->second>=index)
-            {
-                if (iter->second>=index+count)
-                {
-                    iter->second -= count;
-                    ++iter;
-                }
-                else
-                {
-                    mIndex.erase (iter++);
-                }
-            }
-            else
-                ++iter;
+            if ((*iter)->mIndexEntry!=mIndex.end())
+                mIndex.erase ((*iter)->mIndexEntry);
+
+            delete *iter;
         }
+
+        mRecords.erase (begin, end);
+
+        setDirty (index);
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -375,18 +471,19 @@ namespace CSMWorld
     {
         std::string id2 = Misc::StringUtils::lowerCase(id);
 
-        std::map<std::string, int>::const_iterator iter = mIndex.find (id2);
+        typename IdMap::const_iterator iter = mIndex.find (id2);
 
         if (iter==mIndex.end())
             return -1;
 
-        return iter->second;
+        return getRow (iter->second);
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::replace (int index, const RecordBase& record)
     {
-        mRecords.at (index) = dynamic_cast<const Record<ESXRecordT>&> (record);
+        Record<ESXRecordT>& record2 = *mRecords.at (index);
+        record2 = dynamic_cast<const Record<ESXRecordT>&> (record);
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -410,11 +507,10 @@ namespace CSMWorld
     {
         std::vector<std::string> ids;
 
-        for (typename std::map<std::string, int>::const_iterator iter = mIndex.begin();
-            iter!=mIndex.end(); ++iter)
+        for (typename IdMap::const_iterator iter = mIndex.begin(); iter!=mIndex.end(); ++iter)
         {
-            if (listDeleted || !mRecords[iter->second].isDeleted())
-                ids.push_back (IdAccessorT().getId (mRecords[iter->second].get()));
+            if (listDeleted || !iter->second->isDeleted())
+                ids.push_back (IdAccessorT().getId (iter->second->get()));
         }
 
         return ids;
@@ -423,14 +519,19 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     const Record<ESXRecordT>& Collection<ESXRecordT, IdAccessorT>::getRecord (const std::string& id) const
     {
-        int index = getIndex (id);
-        return mRecords.at (index);
+        // no need to look up the row
+        typename IdMap::const_iterator iter = mIndex.find (Misc::StringUtils::lowerCase (id));
+
+        if (iter==mIndex.end())
+            throw std::runtime_error ("invalid ID: " + id);
+
+        return *iter->second;
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
     const Record<ESXRecordT>& Collection<ESXRecordT, IdAccessorT>::getRecord (int index) const
     {
-        return mRecords.at (index);
+        return *mRecords.at (index);
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -442,28 +543,31 @@ namespace CSMWorld
 
         const Record<ESXRecordT>& record2 = dynamic_cast<const Record<ESXRecordT>&> (record);
 
-        mRecords.insert (mRecords.begin()+index, record2);
+        std::auto_ptr<Slot> slot (new Slot (record2));
+        slot->mRow = index;
 
-        if (index<static_cast<int> (mRecords.size())-1)
-        {
-            for (std::map<std::string, int>::iterator iter (mIndex.begin()); iter!=mIndex.end();
-                ++iter)
-                 if (iter->second>=index)
-                     ++(iter->second);
-        }
+        mRecords.insert (mRecords.begin()+index, slot.get());
+
+        std::pair<typename IdMap::iterator, bool> result = mIndex.insert (std::make_pair (
+            Misc::StringUtils::lowerCase (IdAccessorT().getId (record2.get())), slot.get()));
+
+        // If the ID is already taken, the index keeps pointing to the existing record
+        slot->mIndexEntry = result.second ? result.first : mIndex.end();
+
+        slot.release();
 
-        mIndex.insert (std::make_pair (Misc::StringUtils::lowerCase (IdAccessorT().getId (
-            record2.get())), index));
+        setDirty (index);
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::setRecord (int index, const Record<ESXRecordT>& record)
     {
-        if (Misc::StringUtils::lowerCase (IdAccessorT().getId (mRecords.at (index).get()))!=
+        if (Misc::StringUtils::lowerCase (IdAccessorT().getId (mRecords.at (index)->get()))!=
             Misc::StringUtils::lowerCase (IdAccessorT().getId (record.get())))
             throw std::runtime_error ("attempt to change the ID of a record");
 
-        mRecords.at (index) = record;
+        Record<ESXRecordT>& record2 = *mRecords.at (index);
+        record2 = record;
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
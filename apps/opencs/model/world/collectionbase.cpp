@@ -8,6 +8,8 @@ CSMWorld::CollectionBase::CollectionBase() {}
 
 CSMWorld::CollectionBase::~CollectionBase() {}
 
+void CSMWorld::CollectionBase::updateRows() const {}
+
 int CSMWorld::CollectionBase::searchColumnIndex (Columns::ColumnId id) const
 {
     int columns = getColumns();
@@ -97,6 +97,12 @@ namespace CSMWorld
             ///
             /// \return Success?
 
+            virtual void updateRows() const;
+            ///< Bring row numbers that are cached lazily up to date, so that looking up records
+            /// does not modify the collection until it is changed again.
+            ///
+            /// Default-implementation: ignore
+
             int searchColumnIndex (Columns::ColumnId id) const;
             ///< Return index of column with the given \a id. If no such column exists, -1 is returned.
 
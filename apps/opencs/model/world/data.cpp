@@ -4,12 +4,15 @@
 #include <algorithm>
 
 #include <QAbstractItemModel>
+#include <QMutexLocker>
 
 #include <components/esm/esmreader.hpp>
 #include <components/esm/defs.hpp>
 #include <components/esm/loadglob.hpp>
 #include <components/esm/cellref.hpp>
 
+#include <components/misc/stringops.hpp>
+
 #include "idtable.hpp"
 #include "idtree.hpp"
 #include "columnimp.hpp"
@@ -34,9 +37,10 @@ void CSMWorld::Data::addModel (QAbstractItemModel *model, UniversalId::Type type
         connect (model, SIGNAL (dataChanged (const QModelIndex&, const QModelIndex&)),
             this, SLOT (dataChanged (const QModelIndex&, const QModelIndex&)));
         connect (model, SIGNAL (rowsInserted (const QModelIndex&, int, int)),
-            this, SLOT (rowsChanged (const QModelIndex&, int, int)));
+            this, SLOT (rowsInserted (const QModelIndex&, int, int)));
         connect (model, SIGNAL (rowsRemoved (const QModelIndex&, int, int)),
-            this, SLOT (rowsChanged (const QModelIndex&, int, int)));
+            this, SLOT (rowsRemoved (const QModelIndex&, int, int)));
+        connect (model, SIGNAL (modelReset()), this, SLOT (modelReset()));
     }
 }
 
@@ -48,6 +52,49 @@ void CSMWorld::Data::appendIds (std::vector<std::string>& ids, const CollectionB
     ids.insert (ids.end(), ids2.begin(), ids2.end());
 }
 
+void CSMWorld::Data::touch (const QAbstractItemModel *model, int first, int last)
+{
+    const IdTableBase *table = dynamic_cast<const IdTableBase *> (model);
+
+    int column = table ? table->searchColumnIndex (Columns::ColumnId_Id) : -1;
+
+    std::vector<std::string> ids;
+
+    if (last>=first && column!=-1)
+        for (int row = first; row<=last; ++row)
+        {
+            std::string id = model->data (model->index (row, column)).toString().toUtf8().constData();
+            ids.push_back (Misc::StringUtils::lowerCase (id));
+        }
+
+    QMutexLocker lock (&mRevisionMutex);
+
+    Revisions& revisions = mRevisions[model];
+
+    revisions.mTable = ++mRevision;
+
+    if (last<first || column==-1)
+    {
+        revisions.mAll = mRevision;
+        return;
+    }
+
+    for (std::vector<std::string>::const_iterator iter (ids.begin()); iter!=ids.end(); ++iter)
+        revisions.mRecords[*iter] = mRevision;
+}
+
+const CSMWorld::Data::Revisions *CSMWorld::Data::findRevisions (UniversalId::Type type) const
+{
+    std::map<UniversalId::Type, QAbstractItemModel *>::const_iterator model = mModelIndex.find (type);
+
+    if (model==mModelIndex.end())
+        return 0;
+
+    std::map<const QAbstractItemModel *, Revisions>::const_iterator iter = mRevisions.find (model->second);
+
+    return iter==mRevisions.end() ? 0 : &iter->second;
+}
+
 int CSMWorld::Data::count (RecordBase::State state, const CollectionBase& collection)
 {
     int number = 0;
@@ -61,7 +108,8 @@ int CSMWorld::Data::count (RecordBase::State state, const CollectionBase& collec
 
 CSMWorld::Data::Data (ToUTF8::FromType encoding, const ResourcesManager& resourcesManager)
 : mEncoder (encoding), mPathgrids (mCells), mRefs (mCells),
-  mResourcesManager (resourcesManager), mReader (0), mDialogue (0), mReaderIndex(0), mResourceSystem(new Resource::ResourceSystem(resourcesManager.getVFS()))
+  mResourcesManager (resourcesManager), mReader (0), mDialogue (0), mReaderIndex(0), mResourceSystem(new Resource::ResourceSystem(resourcesManager.getVFS())),
+  mRevision (0)
 {
     int index = 0;
 
@@ -1136,6 +1184,75 @@ int CSMWorld::Data::count (RecordBase::State state) const
         count (state, mPathgrids);
 }
 
+void CSMWorld::Data::updateRows() const
+{
+    mGlobals.updateRows();
+    mGmsts.updateRows();
+    mSkills.updateRows();
+    mClasses.updateRows();
+    mFactions.updateRows();
+    mRaces.updateRows();
+    mSounds.updateRows();
+    mScripts.updateRows();
+    mRegions.updateRows();
+    mBirthsigns.updateRows();
+    mSpells.updateRows();
+    mTopics.updateRows();
+    mJournals.updateRows();
+    mEnchantments.updateRows();
+    mBodyParts.updateRows();
+    mMagicEffects.updateRows();
+    mPathgrids.updateRows();
+    mDebugProfiles.updateRows();
+    mSoundGens.updateRows();
+    mStartScripts.updateRows();
+    mTopicInfos.updateRows();
+    mJournalInfos.updateRows();
+    mCells.updateRows();
+    mLandTextures.updateRows();
+    mLand.updateRows();
+    mReferenceables.updateRows();
+    mRefs.updateRows();
+    mFilters.updateRows();
+    mMetaData.updateRows();
+}
+
+int CSMWorld::Data::getRevision() const
+{
+    QMutexLocker lock (&mRevisionMutex);
+
+    return mRevision;
+}
+
+int CSMWorld::Data::getRevision (UniversalId::Type type) const
+{
+    QMutexLocker lock (&mRevisionMutex);
+
+    const Revisions *revisions = findRevisions (type);
+
+    return revisions ? revisions->mTable : 0;
+}
+
+int CSMWorld::Data::getRevision (UniversalId::Type type, const std::string& id) const
+{
+    std::string id2 = Misc::StringUtils::lowerCase (id);
+
+    QMutexLocker lock (&mRevisionMutex);
+
+    const Revisions *revisions = findRevisions (type);
+
+    if (!revisions)
+        return 0;
+
+    std::map<std::string, int>::const_iterator iter =
+        revisions->mRecords.find (id2);
+
+    if (iter==revisions->mRecords.end())
+        return revisions->mAll;
+
+    return std::max (iter->second, revisions->mAll);
+}
+
 std::vector<std::string> CSMWorld::Data::getIds (bool listDeleted) const
 {
     std::vector<std::string> ids;
@@ -1166,12 +1283,45 @@ std::vector<std::string> CSMWorld::Data::getIds (bool listDeleted) const
 
 void CSMWorld::Data::dataChanged (const QModelIndex& topLeft, const QModelIndex& bottomRight)
 {
+    // changes to nested tables are attributed to the record the nested table belongs to
+    if (topLeft.parent().isValid())
+        touch (topLeft.model(), topLeft.parent().row(), topLeft.parent().row());
+    else
+        touch (topLeft.model(), topLeft.row(), bottomRight.row());
+
     if (topLeft.column()<=0)
         emit idListChanged();
 }
 
-void CSMWorld::Data::rowsChanged (const QModelIndex& parent, int start, int end)
+void CSMWorld::Data::rowsInserted (const QModelIndex& parent, int start, int end)
+{
+    if (parent.isValid())
+        touch (parent.model(), parent.row(), parent.row());
+    else
+        touch (qobject_cast<const QAbstractItemModel *> (sender()), start, end);
+
+    emit idListChanged();
+}
+
+void CSMWorld::Data::rowsRemoved (const QModelIndex& parent, int start, int end)
+{
+    // the IDs of removed records are not available anymore, so only the table itself is marked
+    // as changed
+    if (parent.isValid())
+        touch (parent.model(), parent.row(), parent.row());
+    else
+    {
+        QMutexLocker lock (&mRevisionMutex);
+        mRevisions[qobject_cast<const QAbstractItemModel *> (sender())].mTable = ++mRevision;
+    }
+
+    emit idListChanged();
+}
+
+void CSMWorld::Data::modelReset()
 {
+    touch (qobject_cast<const QAbstractItemModel *> (sender()));
+
     emit idListChanged();
 }
 
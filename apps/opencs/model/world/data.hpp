@@ -8,6 +8,7 @@
 
 #include <QObject>
 #include <QModelIndex>
+#include <QMutex>
 
 #include <components/esm/loadglob.hpp>
 #include <components/esm/loadgmst.hpp>
@@ -117,6 +118,20 @@ namespace CSMWorld
 
             std::vector<boost::shared_ptr<ESM::ESMReader> > mReaders;
 
+            struct Revisions
+            {
+                int mTable; // last change to any record of the table
+                int mAll; // last change that could not be attributed to individual records
+                std::map<std::string, int> mRecords; // lower case ID, last change
+
+                Revisions() : mTable (0), mAll (0) {}
+            };
+
+            // Revisions are recorded on the GUI thread and queried by the verifier thread
+            int mRevision;
+            std::map<const QAbstractItemModel *, Revisions> mRevisions;
+            mutable QMutex mRevisionMutex;
+
             // not implemented
             Data (const Data&);
             Data& operator= (const Data&);
@@ -128,6 +143,13 @@ namespace CSMWorld
                 bool listDeleted);
             ///< Append all IDs from collection to \a ids.
 
+            void touch (const QAbstractItemModel *model, int first = 0, int last = -1);
+            ///< Record a change to the top-level rows \a first to \a last of \a model (all
+            /// rows, if \a last is smaller than \a first).
+
+            const Revisions *findRevisions (UniversalId::Type type) const;
+            ///< \note mRevisionMutex must be locked.
+
             static int count (RecordBase::State state, const CollectionBase& collection);
 
         public:
@@ -284,6 +306,26 @@ namespace CSMWorld
             int count (RecordBase::State state) const;
             ///< Return number of top-level records with the given \a state.
 
+            void updateRows() const;
+            ///< Bring the cached row numbers of all collections up to date, so that other threads
+            /// can look up records without modifying the collections.
+
+            /// Return the current revision of the document data.
+            ///
+            /// The revision is incremented for every change made through the models. It is not
+            /// saved, and only meant for finding out what changed between two points in time.
+            int getRevision() const;
+
+            /// Return the revision of the last change to any record in table \a type (0 if the
+            /// table has not been changed since the document was loaded).
+            int getRevision (UniversalId::Type type) const;
+
+            /// Return the revision of the last change to record \a id in table \a type (0 if
+            /// the record has not been changed since the document was loaded).
+            ///
+            /// \note Removing a record only changes the revision of the table.
+            int getRevision (UniversalId::Type type, const std::string& id) const;
+
         signals:
 
             void idListChanged();
@@ -292,7 +334,11 @@ namespace CSMWorld
 
             void dataChanged (const QModelIndex& topLeft, const QModelIndex& bottomRight);
 
-            void rowsChanged (const QModelIndex& parent, int start, int end);
+            void rowsInserted (const QModelIndex& parent, int start, int end);
+
+            void rowsRemoved (const QModelIndex& parent, int start, int end);
+
+            void modelReset();
     };
 }
 
@@ -40,7 +40,7 @@ void CSMWorld::InfoCollection::load (const Info& record, bool base)
         {
             Range range = getTopicRange (topic);
 
-            index = std::distance (getRecords().begin(), range.second);
+            index = std::distance (getRecordsBegin(), range.second);
         }
 
         insertRecord (record2, index);
@@ -67,7 +67,7 @@ int CSMWorld::InfoCollection::getInfoIndex (const std::string& id, const std::st
 
     for (; range.first!=range.second; ++range.first)
         if (Misc::StringUtils::ciEqual(range.first->get().mId, fullId))
-            return std::distance (getRecords().begin(), range.first);
+            return std::distance (getRecordsBegin(), range.first);
 
     return -1;
 }
@@ -84,7 +84,7 @@ int CSMWorld::InfoCollection::getAppendIndex (const std::string& id, UniversalId
     if (range.first==range.second)
         return Collection<Info, IdAccessor<Info> >::getAppendIndex (id, type);
 
-    return std::distance (getRecords().begin(), range.second);
+    return std::distance (getRecordsBegin(), range.second);
 }
 
 bool CSMWorld::InfoCollection::reorderRows (int baseIndex, const std::vector<int>& newOrder)
@@ -150,14 +150,14 @@ CSMWorld::InfoCollection::Range CSMWorld::InfoCollection::getTopicRange (const s
 {
     std::string topic2 = Misc::StringUtils::lowerCase (topic);
 
-    std::map<std::string, int>::const_iterator iter = getIdMap().lower_bound (topic2);
+    IdMap::const_iterator iter = getIdMap().lower_bound (topic2);
 
     // Skip invalid records: The beginning of a topic string could be identical to another topic
     // string.
     for (; iter!=getIdMap().end(); ++iter)
     {
         std::string testTopicId =
-            Misc::StringUtils::lowerCase (getRecord (iter->second).get().mTopicId);
+            Misc::StringUtils::lowerCase (iter->second->get().mTopicId);
 
         if (testTopicId==topic2)
             break;
@@ -165,15 +165,15 @@ CSMWorld::InfoCollection::Range CSMWorld::InfoCollection::getTopicRange (const s
         std::size_t size = topic2.size();
 
         if (testTopicId.size()<size || testTopicId.substr (0, size)!=topic2)
-            return Range (getRecords().end(), getRecords().end());
+            return Range (getRecordsEnd(), getRecordsEnd());
     }
 
     if (iter==getIdMap().end())
-        return Range (getRecords().end(), getRecords().end());
+        return Range (getRecordsEnd(), getRecordsEnd());
 
-    RecordConstIterator begin = getRecords().begin()+iter->second;
+    RecordConstIterator begin = getRecordsBegin()+getRow (iter->second);
 
-    while (begin != getRecords().begin())
+    while (begin != getRecordsBegin())
     {
         if (!Misc::StringUtils::ciEqual(begin->get().mTopicId, topic2))
         {
@@ -187,7 +187,7 @@ CSMWorld::InfoCollection::Range CSMWorld::InfoCollection::getTopicRange (const s
     // Find end
     RecordConstIterator end = begin;
 
-    for (; end!=getRecords().end(); ++end)
+    for (; end!=getRecordsEnd(); ++end)
         if (!Misc::StringUtils::ciEqual(end->get().mTopicId, topic2))
             break;
 
@@ -15,7 +15,7 @@ namespace CSMWorld
     {
         public:
 
-            typedef std::vector<Record<Info> >::const_iterator RecordConstIterator;
+            typedef Collection<Info, IdAccessor<Info> >::RecordConstIterator RecordConstIterator;
             typedef std::pair<RecordConstIterator, RecordConstIterator> Range;
 
         private:
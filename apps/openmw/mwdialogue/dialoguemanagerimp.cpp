@@ -64,10 +64,13 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
+        mInfoIndex.clear();
+
         MWWorld::Store<ESM::Dialogue>::iterator it = dialogs.begin();
         for (; it != dialogs.end(); ++it)
         {
             mDialogueMap[Misc::StringUtils::lowerCase(it->mId)] = *it;
+            mInfoIndex.addTopic (*it);
         }
     }
 
@@ -146,7 +149,7 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        Filter filter (actor, mChoice, mTalkedTo);
+        Filter filter (actor, mChoice, mTalkedTo, &mInfoIndex);
 
         for (MWWorld::Store<ESM::Dialogue>::iterator it = dialogs.begin(); it != dialogs.end(); ++it)
         {
@@ -259,7 +262,7 @@ namespace MWDialogue
 
     void DialogueManager::executeTopic (const std::string& topic)
     {
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndex);
 
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
@@ -332,7 +335,7 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndex);
 
         for (MWWorld::Store<ESM::Dialogue>::iterator iter = dialogs.begin(); iter != dialogs.end(); ++iter)
         {
@@ -456,7 +459,7 @@ namespace MWDialogue
 
         if (mDialogueMap.find(mLastTopic) != mDialogueMap.end())
         {
-            Filter filter (mActor, mChoice, mTalkedTo);
+            Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndex);
 
             if (mDialogueMap[mLastTopic].mType == ESM::Dialogue::Topic
                     || mDialogueMap[mLastTopic].mType == ESM::Dialogue::Greeting)
@@ -580,7 +583,7 @@ namespace MWDialogue
 
     bool DialogueManager::checkServiceRefused()
     {
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndex);
 
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
@@ -621,7 +624,7 @@ namespace MWDialogue
         const MWWorld::ESMStore &store = MWBase::Environment::get().getWorld()->getStore();
         const ESM::Dialogue *dial = store.get<ESM::Dialogue>().find(topic);
 
-        Filter filter(actor, 0, false);
+        Filter filter(actor, 0, false, &mInfoIndex);
         const ESM::DialInfo *info = filter.search(*dial, false);
         if(info != NULL)
         {
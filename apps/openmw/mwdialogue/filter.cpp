@@ -69,7 +69,26 @@ bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
 
         if (!Misc::StringUtils::ciEqual(mActor.getClass().getPrimaryFaction(mActor), info.mFaction))
             return false;
+    }
+
+    return testActorRank (info);
+}
+
+bool MWDialogue::Filter::testActor (const Candidate& candidate) const
+{
+    // actor ID, race, class and faction have already been matched by the index
+    if (candidate.mIndexed)
+        return testActorRank (*candidate.mInfo);
+
+    return testActor (*candidate.mInfo);
+}
 
+bool MWDialogue::Filter::testActorRank (const ESM::DialInfo& info) const
+{
+    bool isCreature = (mActor.getTypeName() != typeid (ESM::NPC).name());
+
+    if (!info.mFaction.empty())
+    {
         // check rank
         if (mActor.getClass().getPrimaryFactionRank(mActor) < info.mData.mRank)
             return false;
@@ -138,6 +157,19 @@ bool MWDialogue::Filter::testSelectStructs (const ESM::DialInfo& info) const
     return true;
 }
 
+bool MWDialogue::Filter::testSelectStructs (const Candidate& candidate) const
+{
+    if (!candidate.mIndexed)
+        return testSelectStructs (*candidate.mInfo);
+
+    for (std::vector<SelectWrapper>::const_iterator iter (candidate.mIndexed->mSelects.begin());
+        iter != candidate.mIndexed->mSelects.end(); ++iter)
+        if (!testSelectStruct (*iter))
+            return false;
+
+    return true;
+}
+
 bool MWDialogue::Filter::testDisposition (const ESM::DialInfo& info, bool invert) const
 {
     bool isCreature = (mActor.getTypeName() != typeid (ESM::NPC).name());
@@ -440,18 +472,30 @@ bool MWDialogue::Filter::getSelectStructBoolean (const SelectWrapper& select) co
 
         case SelectWrapper::Function_NotId:
 
+            if (mIndex && select.getNameId()!=-1)
+                return mActorKey.mActor!=select.getNameId();
+
             return !Misc::StringUtils::ciEqual(mActor.getClass().getId (mActor), select.getName());
 
         case SelectWrapper::Function_NotFaction:
 
+            if (mIndex && select.getNameId()!=-1)
+                return mActorKey.mFaction!=select.getNameId();
+
             return !Misc::StringUtils::ciEqual(mActor.getClass().getPrimaryFaction(mActor), select.getName());
 
         case SelectWrapper::Function_NotClass:
 
+            if (mIndex && select.getNameId()!=-1)
+                return mActorKey.mClass!=select.getNameId();
+
             return !Misc::StringUtils::ciEqual(mActor.get<ESM::NPC>()->mBase->mClass, select.getName());
 
         case SelectWrapper::Function_NotRace:
 
+            if (mIndex && select.getNameId()!=-1)
+                return mActorKey.mRace!=select.getNameId();
+
             return !Misc::StringUtils::ciEqual(mActor.get<ESM::NPC>()->mBase->mRace, select.getName());
 
         case SelectWrapper::Function_NotCell:
@@ -589,9 +633,53 @@ bool MWDialogue::Filter::hasFactionRankReputationRequirements (const MWWorld::Pt
     return stats.getFactionReputation (factionId)>=faction.mData.mRankData[rank].mFactReaction;
 }
 
-MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer)
-: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer)
-{}
+MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, const InfoIndex *index)
+: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer), mIndex (index)
+{
+    if (mIndex)
+    {
+        if (mActor.getTypeName()==typeid (ESM::NPC).name())
+        {
+            const MWWorld::LiveCellRef<ESM::NPC> *npc = mActor.get<ESM::NPC>();
+            mActorKey = mIndex->getActorKey (mActor.getClass().getId (mActor), false,
+                npc->mBase->mRace, npc->mBase->mClass, mActor.getClass().getPrimaryFaction (mActor));
+        }
+        else
+            mActorKey = mIndex->getActorKey (mActor.getClass().getId (mActor), true, "", "", "");
+    }
+}
+
+void MWDialogue::Filter::getCandidates (const ESM::Dialogue& dialogue, std::vector<Candidate>& candidates) const
+{
+    if (mIndex)
+    {
+        if (const std::vector<const InfoIndex::Info *> *indexed = mIndex->getCandidates (dialogue, mActorKey))
+        {
+            candidates.reserve (indexed->size());
+
+            for (std::vector<const InfoIndex::Info *>::const_iterator iter (indexed->begin());
+                iter!=indexed->end(); ++iter)
+            {
+                Candidate candidate;
+                candidate.mInfo = (*iter)->mInfo;
+                candidate.mIndexed = *iter;
+                candidates.push_back (candidate);
+            }
+
+            return;
+        }
+    }
+
+    candidates.reserve (dialogue.mInfo.size());
+
+    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin(); iter!=dialogue.mInfo.end(); ++iter)
+    {
+        Candidate candidate;
+        candidate.mInfo = &*iter;
+        candidate.mIndexed = 0;
+        candidates.push_back (candidate);
+    }
+}
 
 const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue, const bool fallbackToInfoRefusal) const
 {
@@ -605,11 +693,14 @@ const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue,
 
 std::vector<const ESM::DialInfo *> MWDialogue::Filter::listAll (const ESM::Dialogue& dialogue) const
 {
+    std::vector<Candidate> candidates;
+    getCandidates (dialogue, candidates);
+
     std::vector<const ESM::DialInfo *> infos;
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin(); iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<Candidate>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
     {
         if (testActor (*iter))
-            infos.push_back(&*iter);
+            infos.push_back(iter->mInfo);
     }
     return infos;
 }
@@ -621,14 +712,17 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
     bool infoRefusal = false;
 
+    std::vector<Candidate> candidates;
+    getCandidates (dialogue, candidates);
+
     // Iterate over topic responses to find a matching one
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<Candidate>::const_iterator iter = candidates.begin();
+        iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        if (testActor (*iter) && testPlayer (*iter->mInfo) && testSelectStructs (*iter))
         {
-            if (testDisposition (*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+            if (testDisposition (*iter->mInfo, invertDisposition)) {
+                infos.push_back(iter->mInfo);
                 if (!searchAll)
                     break;
             }
@@ -647,10 +741,13 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
         const ESM::Dialogue& infoRefusalDialogue = *dialogues.find ("Info Refusal");
 
-        for (ESM::Dialogue::InfoContainer::const_iterator iter = infoRefusalDialogue.mInfo.begin();
-            iter!=infoRefusalDialogue.mInfo.end(); ++iter)
-            if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter) && testDisposition(*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+        std::vector<Candidate> refusalCandidates;
+        getCandidates (infoRefusalDialogue, refusalCandidates);
+
+        for (std::vector<Candidate>::const_iterator iter = refusalCandidates.begin();
+            iter!=refusalCandidates.end(); ++iter)
+            if (testActor (*iter) && testPlayer (*iter->mInfo) && testSelectStructs (*iter) && testDisposition(*iter->mInfo, invertDisposition)) {
+                infos.push_back(iter->mInfo);
                 if (!searchAll)
                     break;
             }
@@ -661,10 +758,13 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
 bool MWDialogue::Filter::responseAvailable (const ESM::Dialogue& dialogue) const
 {
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    std::vector<Candidate> candidates;
+    getCandidates (dialogue, candidates);
+
+    for (std::vector<Candidate>::const_iterator iter = candidates.begin();
+        iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        if (testActor (*iter) && testPlayer (*iter->mInfo) && testSelectStructs (*iter))
             return true;
     }
 
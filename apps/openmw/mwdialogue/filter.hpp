@@ -5,6 +5,8 @@
 
 #include "../mwworld/ptr.hpp"
 
+#include "infoindex.hpp"
+
 namespace ESM
 {
     struct DialInfo;
@@ -20,16 +22,35 @@ namespace MWDialogue
             MWWorld::Ptr mActor;
             int mChoice;
             bool mTalkedToPlayer;
+            const InfoIndex *mIndex;
+            InfoIndex::ActorKey mActorKey;
+
+            struct Candidate
+            {
+                const ESM::DialInfo *mInfo;
+                const InfoIndex::Info *mIndexed; // may be 0
+            };
+
+            void getCandidates (const ESM::Dialogue& dialogue, std::vector<Candidate>& candidates) const;
+            ///< Get the infos of \a dialogue that need to be tested. If an index is available, infos with
+            /// mismatching actor, race, class or faction are already excluded.
 
             bool testActor (const ESM::DialInfo& info) const;
             ///< Is this the right actor for this \a info?
 
+            bool testActor (const Candidate& candidate) const;
+
+            bool testActorRank (const ESM::DialInfo& info) const;
+            ///< Do the actor's faction rank and gender match \a info?
+
             bool testPlayer (const ESM::DialInfo& info) const;
             ///< Do the player and the cell the player is currently in match \a info?
 
             bool testSelectStructs (const ESM::DialInfo& info) const;
             ///< Are all select structs matching?
 
+            bool testSelectStructs (const Candidate& candidate) const;
+
             bool testDisposition (const ESM::DialInfo& info, bool invert=false) const;
             ///< Is the actor disposition toward the player high enough (or low enough, if \a invert is true)?
 
@@ -51,7 +72,9 @@ namespace MWDialogue
 
         public:
 
-            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer);
+            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, const InfoIndex *index = 0);
+            ///< \param index Optional precompiled index over all dialogue topics. If given, only the infos
+            /// that can apply to \a actor are tested.
 
             std::vector<const ESM::DialInfo *> list (const ESM::Dialogue& dialogue,
                 bool fallbackToInfoRefusal, bool searchAll, bool invertDisposition=false) const;
@@ -0,0 +1,178 @@
+#include "infoindex.hpp"
+
+#include <algorithm>
+
+#include <components/esm/loaddial.hpp>
+#include <components/misc/stringops.hpp>
+
+namespace MWDialogue
+{
+    InfoIndex::ActorKey::ActorKey()
+    : mActor (-1), mRace (-1), mClass (-1), mFaction (-1), mIsCreature (false)
+    {}
+
+    int InfoIndex::intern (const std::string& id)
+    {
+        std::map<std::string, int>::const_iterator iter = mIds.find (id);
+
+        if (iter!=mIds.end())
+            return iter->second;
+
+        int index = static_cast<int> (mIds.size());
+        mIds.insert (std::make_pair (id, index));
+        return index;
+    }
+
+    void InfoIndex::addBucket (const Buckets& buckets, int key, std::vector<int>& indices)
+    {
+        if (key==-1)
+            return;
+
+        Buckets::const_iterator iter = buckets.find (key);
+
+        if (iter!=buckets.end())
+            indices.insert (indices.end(), iter->second.begin(), iter->second.end());
+    }
+
+    void InfoIndex::clear()
+    {
+        mIds.clear();
+        mTopics.clear();
+    }
+
+    void InfoIndex::addTopic (const ESM::Dialogue& dialogue)
+    {
+        Topic& topic = mTopics[Misc::StringUtils::lowerCase (dialogue.mId)];
+        topic = Topic();
+        topic.mInfos.reserve (dialogue.mInfo.size());
+
+        for (ESM::Dialogue::InfoContainer::const_iterator infoIter = dialogue.mInfo.begin();
+            infoIter!=dialogue.mInfo.end(); ++infoIter)
+        {
+            Info info;
+            info.mInfo = &*infoIter;
+            info.mActor = infoIter->mActor.empty() ? -1 : intern (Misc::StringUtils::lowerCase (infoIter->mActor));
+            info.mRace = infoIter->mRace.empty() ? -1 : intern (Misc::StringUtils::lowerCase (infoIter->mRace));
+            info.mClass = infoIter->mClass.empty() ? -1 : intern (Misc::StringUtils::lowerCase (infoIter->mClass));
+            info.mFaction = infoIter->mFaction.empty() ? -1 : intern (Misc::StringUtils::lowerCase (infoIter->mFaction));
+
+            info.mSelects.reserve (infoIter->mSelects.size());
+
+            for (std::vector<ESM::DialInfo::SelectStruct>::const_iterator selectIter (infoIter->mSelects.begin());
+                selectIter!=infoIter->mSelects.end(); ++selectIter)
+            {
+                SelectWrapper select (*selectIter);
+
+                switch (select.getFunction())
+                {
+                    case SelectWrapper::Function_NotId:
+                    case SelectWrapper::Function_NotFaction:
+                    case SelectWrapper::Function_NotClass:
+                    case SelectWrapper::Function_NotRace:
+
+                        select.setNameId (intern (select.getName()));
+                        break;
+
+                    default:
+
+                        break;
+                }
+
+                info.mSelects.push_back (select);
+            }
+
+            int index = static_cast<int> (topic.mInfos.size());
+            topic.mInfos.push_back (info);
+
+            if (info.mActor!=-1)
+                topic.mByActor[info.mActor].push_back (index);
+            else if (info.mRace!=-1)
+                topic.mByRace[info.mRace].push_back (index);
+            else if (info.mClass!=-1)
+                topic.mByClass[info.mClass].push_back (index);
+            else if (info.mFaction!=-1)
+                topic.mByFaction[info.mFaction].push_back (index);
+            else
+                topic.mUnconstrained.push_back (index);
+        }
+    }
+
+    int InfoIndex::lookup (const std::string& id) const
+    {
+        if (id.empty())
+            return -1;
+
+        std::map<std::string, int>::const_iterator iter = mIds.find (Misc::StringUtils::lowerCase (id));
+
+        if (iter==mIds.end())
+            return -1;
+
+        return iter->second;
+    }
+
+    InfoIndex::ActorKey InfoIndex::getActorKey (const std::string& id, bool isCreature,
+        const std::string& race, const std::string& class_, const std::string& faction) const
+    {
+        ActorKey key;
+
+        key.mIsCreature = isCreature;
+        key.mActor = lookup (id);
+
+        if (!key.mIsCreature)
+        {
+            key.mRace = lookup (race);
+            key.mClass = lookup (class_);
+            key.mFaction = lookup (faction);
+        }
+
+        return key;
+    }
+
+    const std::vector<const InfoIndex::Info *> *InfoIndex::getCandidates (const ESM::Dialogue& dialogue,
+        const ActorKey& actor) const
+    {
+        std::map<std::string, Topic>::const_iterator topicIter =
+            mTopics.find (Misc::StringUtils::lowerCase (dialogue.mId));
+
+        if (topicIter==mTopics.end() || topicIter->second.mInfos.size()!=dialogue.mInfo.size())
+            return 0;
+
+        const Topic& topic = topicIter->second;
+
+        std::vector<int>& indices = mIndices;
+        indices.clear();
+        mCandidates.clear();
+
+        addBucket (topic.mByActor, actor.mActor, indices);
+
+        // Creatures must not have topics aside of those specific to their id
+        if (!actor.mIsCreature)
+        {
+            addBucket (topic.mByRace, actor.mRace, indices);
+            addBucket (topic.mByClass, actor.mClass, indices);
+            addBucket (topic.mByFaction, actor.mFaction, indices);
+            indices.insert (indices.end(), topic.mUnconstrained.begin(), topic.mUnconstrained.end());
+        }
+
+        // buckets are disjoint, so sorting is enough to restore the original INFO order
+        std::sort (indices.begin(), indices.end());
+
+        for (std::vector<int>::const_iterator iter (indices.begin()); iter!=indices.end(); ++iter)
+        {
+            const Info& info = topic.mInfos[*iter];
+
+            if (info.mRace!=-1 && (actor.mIsCreature || info.mRace!=actor.mRace))
+                continue;
+
+            if (info.mClass!=-1 && (actor.mIsCreature || info.mClass!=actor.mClass))
+                continue;
+
+            if (info.mFaction!=-1 && (actor.mIsCreature || info.mFaction!=actor.mFaction))
+                continue;
+
+            mCandidates.push_back (&info);
+        }
+
+        return &mCandidates;
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef GAME_MWDIALOGUE_INFOINDEX_H
+#define GAME_MWDIALOGUE_INFOINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "selectwrapper.hpp"
+
+namespace ESM
+{
+    struct DialInfo;
+    struct Dialogue;
+}
+
+namespace MWDialogue
+{
+    /// \brief Precompiled lookup structure for the INFOs of all dialogue topics
+    ///
+    /// INFOs are bucketed by their cheap discriminators (actor, race, class, faction), so that
+    /// Filter only needs to run the full condition checks on INFOs that can possibly apply to a
+    /// given actor. All IDs, including the names referenced by select structs, are interned
+    /// into integers when the index is built.
+    class InfoIndex
+    {
+        public:
+
+            struct Info
+            {
+                const ESM::DialInfo* mInfo;
+
+                // Interned IDs, or -1 if the INFO does not filter by this property
+                int mActor;
+                int mRace;
+                int mClass;
+                int mFaction;
+
+                std::vector<SelectWrapper> mSelects;
+            };
+
+            /// Interned IDs of an actor, as used for the candidate lookup.
+            struct ActorKey
+            {
+                int mActor;
+                int mRace;
+                int mClass;
+                int mFaction;
+                bool mIsCreature;
+
+                ActorKey();
+            };
+
+        private:
+
+            typedef std::map<int, std::vector<int> > Buckets;
+
+            struct Topic
+            {
+                std::vector<Info> mInfos;
+
+                // Each INFO is put into exactly one bucket, keyed by its most selective discriminator
+                Buckets mByActor;
+                Buckets mByRace;
+                Buckets mByClass;
+                Buckets mByFaction;
+                std::vector<int> mUnconstrained;
+            };
+
+            std::map<std::string, int> mIds;
+            std::map<std::string, Topic> mTopics;
+
+            int intern (const std::string& id);
+            ///< \note \a id must be in lower case.
+
+            // buffers of getCandidates, kept so that lookups during the game do not allocate
+            mutable std::vector<int> mIndices;
+            mutable std::vector<const Info *> mCandidates;
+
+            static void addBucket (const Buckets& buckets, int key, std::vector<int>& indices);
+
+        public:
+
+            void clear();
+
+            void addTopic (const ESM::Dialogue& dialogue);
+            ///< Index the INFOs of \a dialogue. The INFOs must stay at their address for as long as
+            /// the index is used.
+
+            int lookup (const std::string& id) const;
+            ///< Return the interned ID of \a id (case-insensitive), or -1 if no INFO refers to it.
+
+            ActorKey getActorKey (const std::string& id, bool isCreature, const std::string& race,
+                const std::string& class_, const std::string& faction) const;
+            ///< \param race, class_, faction Ignored for creatures.
+
+            const std::vector<const Info *> *getCandidates (const ESM::Dialogue& dialogue,
+                const ActorKey& actor) const;
+            ///< Get all INFOs of \a dialogue whose actor, race, class and faction match \a actor, in
+            /// the original INFO order.
+            ///
+            /// \return 0, if \a dialogue has not been indexed. The returned vector is reused by the
+            /// next call.
+    };
+}
+
+#endif
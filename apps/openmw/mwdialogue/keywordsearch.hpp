@@ -1,17 +1,27 @@
 #ifndef GAME_MWDIALOGUE_KEYWORDSEARCH_H
 #define GAME_MWDIALOGUE_KEYWORDSEARCH_H
 
-#include <map>
+#include <cctype>
+#include <list>
 #include <locale>
 #include <stdexcept>
 #include <vector>
-#include <algorithm>    // std::reverse
+#include <algorithm>
 
 #include <components/misc/stringops.hpp>
 
 namespace MWDialogue
 {
 
+/// \brief Finds known keywords in a text
+///
+/// The keywords are compiled into an Aho-Corasick automaton over case-folded bytes, so the text
+/// is scanned only once regardless of the number of keywords. Since UTF-8 multi-byte sequences
+/// never contain ASCII bytes, working on bytes is safe for UTF-8 text.
+///
+/// Each node only stores the edges of the trie, sorted by byte; a missing transition is resolved
+/// by following the failure links while searching. The failure links are kept up to date as
+/// keywords are seeded, so seeding never triggers a rebuild of the whole automaton.
 template <typename string_t, typename value_t>
 class KeywordSearch
 {
@@ -26,46 +36,84 @@ public:
         value_t mValue;
     };
 
+    KeywordSearch()
+    {
+        for (int i=0; i<256; ++i)
+            mFold[i] = static_cast<unsigned char> (std::tolower (static_cast<char> (i), mLocale));
+
+        clear();
+    }
+
     void seed (string_t keyword, value_t value)
     {
         if (keyword.empty())
             return;
-        seed_impl  (/*std::move*/ (keyword), /*std::move*/ (value), 0, mRoot);
+
+        int node = 0;
+
+        for (Point i = keyword.begin(); i != keyword.end(); ++i)
+        {
+            unsigned char ch = fold (*i);
+
+            int child = findChild (node, ch);
+
+            if (child == -1)
+                child = addNode (node, ch);
+
+            node = child;
+        }
+
+        if (mNodes[node].mKeyword != -1)
+        {
+            if (keyword == mKeywords[mNodes[node].mKeyword].first)
+                throw std::runtime_error ("duplicate keyword inserted");
+
+            return; // differs only in case from a known keyword
+        }
+
+        mNodes[node].mKeyword = static_cast<int> (mKeywords.size());
+        mKeywords.push_back (std::make_pair (keyword, value));
+
+        // nodes whose failure chain reaches the new keyword without passing another keyword report it next
+        std::vector<int> stack;
+        pushFailChildren (node, stack);
+
+        while (!stack.empty())
+        {
+            int current = stack.back();
+            stack.pop_back();
+
+            mNodes[current].mOutput = node;
+
+            if (mNodes[current].mKeyword == -1)
+                pushFailChildren (current, stack);
+        }
     }
 
     void clear ()
     {
-        mRoot.mChildren.clear ();
-        mRoot.mKeyword.clear ();
+        mNodes.clear();
+        mNodes.push_back (Node (0));
+        mKeywords.clear();
     }
 
     bool containsKeyword (string_t keyword, value_t& value)
     {
-        typename Entry::childen_t::iterator current;
-        typename Entry::childen_t::iterator next;
+        int node = 0;
 
-        current = mRoot.mChildren.find (std::tolower (*keyword.begin(), mLocale));
-        if (current == mRoot.mChildren.end())
-            return false;
-        else if (current->second.mKeyword.size() && Misc::StringUtils::ciEqual(current->second.mKeyword, keyword))
+        for (Point i = keyword.begin(); i != keyword.end(); ++i)
         {
-            value = current->second.mValue;
-            return true;
-        }
+            node = findChild (node, fold (*i));
 
-        for (Point i = ++keyword.begin(); i != keyword.end(); ++i)
-        {
-            next = current->second.mChildren.find(std::tolower (*i, mLocale));
-            if (next == current->second.mChildren.end())
+            if (node == -1)
                 return false;
-            if (Misc::StringUtils::ciEqual(next->second.mKeyword, keyword))
-            {
-                value = next->second.mValue;
-                return true;
-            }
-            current = next;
         }
-        return false;
+
+        if (mNodes[node].mKeyword == -1)
+            return false;
+
+        value = mKeywords[mNodes[node].mKeyword].second;
+        return true;
     }
 
     static bool sortMatches(const Match& left, const Match& right)
@@ -75,94 +123,56 @@ public:
 
     void highlightKeywords (Point beg, Point end, std::vector<Match>& out)
     {
+        // the longest keyword starting at each word boundary, sorted by start position
         std::vector<Match> matches;
-        for (Point i = beg; i != end; ++i)
-        {
-            // check if previous character marked start of new word
-            if (i != beg)
-            {
-                Point prev = i;
-                --prev;
-                if(isalpha(*prev))
-                    continue;
-            }
-
-
-            // check first character
-            typename Entry::childen_t::iterator candidate = mRoot.mChildren.find (std::tolower (*i, mLocale));
-
-            // no match, on to next character
-            if (candidate == mRoot.mChildren.end ())
-                continue;
-
-            // see how far the match goes
-            Point j = i;
-
-            // some keywords might be longer variations of other keywords, so we definitely need a list of candidates
-            // the first element in the pair is length of the match, i.e. depth from the first character on
-            std::vector< typename std::pair<int, typename Entry::childen_t::iterator> > candidates;
 
-            while ((j + 1) != end)
-            {
-                typename Entry::childen_t::iterator next = candidate->second.mChildren.find (std::tolower (*++j, mLocale));
+        int state = 0;
 
-                if (next == candidate->second.mChildren.end ())
-                {
-                    if (candidate->second.mKeyword.size() > 0)
-                        candidates.push_back(std::make_pair((j-i), candidate));
-                    break;
-                }
+        for (Point i = beg; i != end; ++i)
+        {
+            unsigned char ch = fold (*i);
 
-                candidate = next;
+            int next;
+            while ((next = findChild (state, ch)) == -1 && state != 0)
+                state = mNodes[state].mFail;
 
-                if (candidate->second.mKeyword.size() > 0)
-                    candidates.push_back(std::make_pair((j-i), candidate));
-            }
+            state = next == -1 ? 0 : next;
 
-            if (candidates.empty())
-                continue; // didn't match enough to disambiguate, on to next character
+            // check all keywords ending here
+            int output = mNodes[state].mKeyword != -1 ? state : mNodes[state].mOutput;
 
-            // shorter candidates will be added to the vector first. however, we want to check against longer candidates first
-            std::reverse(candidates.begin(), candidates.end());
-
-            for (typename std::vector< std::pair<int, typename Entry::childen_t::iterator> >::iterator it = candidates.begin();
-                 it != candidates.end(); ++it)
+            for (; output != -1; output = mNodes[output].mOutput)
             {
-                candidate = it->second;
-                // try to match the rest of the keyword
-                Point k = i + it->first;
-                typename string_t::const_iterator t = candidate->second.mKeyword.begin () + (k - i);
-
-
-                while (k != end && t != candidate->second.mKeyword.end ())
-                {
-                    if (std::tolower (*k, mLocale) != std::tolower (*t, mLocale))
-                        break;
-
-                    ++k, ++t;
-                }
+                Point start = i - (mNodes[output].mDepth-1);
 
-                // didn't match full keyword, try the next candidate
-                if (t != candidate->second.mKeyword.end ())
+                // keywords have to start at the beginning of a word
+                if (start != beg && std::isalpha (static_cast<unsigned char> (*(start-1))))
                     continue;
 
-                // found a keyword, but there might still be longer keywords that start somewhere _within_ this keyword
-                // we will resolve these overlapping keywords later, choosing the longest one in case of conflict
                 Match match;
-                match.mValue = candidate->second.mValue;
-                match.mBeg = i;
-                match.mEnd = k;
-                matches.push_back(match);
-                break;
+                match.mBeg = start;
+                match.mEnd = i+1;
+                match.mValue = mKeywords[mNodes[output].mKeyword].second;
+
+                // only keep the longest keyword starting at this position. Matches are found in order
+                // of their end position, so a longer match for the same start always comes later.
+                typename std::vector<Match>::iterator iter = std::lower_bound (matches.begin(), matches.end(),
+                    match, sortMatches);
+
+                if (iter != matches.end() && iter->mBeg == start)
+                    *iter = match;
+                else
+                    matches.insert (iter, match);
             }
         }
 
         // resolve overlapping keywords
-        while (matches.size())
+        std::list<Match> remaining (matches.begin(), matches.end());
+        while (remaining.size())
         {
             int longestKeywordSize = 0;
-            typename std::vector<Match>::iterator longestKeyword = matches.begin();
-            for (typename std::vector<Match>::iterator it = matches.begin(); it != matches.end(); ++it)
+            typename std::list<Match>::iterator longestKeyword = remaining.begin();
+            for (typename std::list<Match>::iterator it = remaining.begin(); it != remaining.end(); ++it)
             {
                 int size = it->mEnd - it->mBeg;
                 if (size > longestKeywordSize)
@@ -171,10 +181,10 @@ public:
                     longestKeyword = it;
                 }
 
-                typename std::vector<Match>::iterator next = it;
+                typename std::list<Match>::iterator next = it;
                 ++next;
 
-                if (next == matches.end())
+                if (next == remaining.end())
                     break;
 
                 if (it->mEnd <= next->mBeg)
@@ -184,13 +194,14 @@ public:
             }
 
             Match keyword = *longestKeyword;
-            matches.erase(longestKeyword);
+            remaining.erase(longestKeyword);
             out.push_back(keyword);
-            // erase anything that overlaps with the keyword we just added to the output
-            for (typename std::vector<Match>::iterator it = matches.begin(); it != matches.end();)
+            // erase anything that overlaps with the keyword we just added to the output. Since matches are sorted
+            // by their start, we can stop at the first match starting after the keyword.
+            for (typename std::list<Match>::iterator it = remaining.begin(); it != remaining.end() && it->mBeg < keyword.mEnd;)
             {
-                if (it->mBeg < keyword.mEnd && it->mEnd > keyword.mBeg)
-                    it = matches.erase(it);
+                if (it->mEnd > keyword.mBeg)
+                    it = remaining.erase(it);
                 else
                     ++it;
             }
@@ -201,54 +212,147 @@ public:
 
 private:
 
-    struct Entry
+    struct Node
     {
-        typedef std::map <wchar_t, Entry> childen_t;
-
-        string_t mKeyword;
-        value_t mValue;
-        childen_t mChildren;
+        typedef std::vector<std::pair<unsigned char, int> > Children;
+
+        Children mChildren; // trie edges, sorted by byte
+        int mFail;
+        int mOutput; // next node along the failure chain that terminates a keyword, or -1
+        int mKeyword; // index into mKeywords, or -1
+        int mDepth;
+
+        // the nodes failing to this one, as a doubly linked list, so that a failure link can be moved
+        int mFailChild;
+        int mFailPrev;
+        int mFailNext;
+
+        Node (int depth)
+        : mFail (0), mOutput (-1), mKeyword (-1), mDepth (depth), mFailChild (-1), mFailPrev (-1), mFailNext (-1)
+        {}
     };
 
-    void seed_impl (string_t keyword, value_t value, size_t depth, Entry  & entry)
+    static bool compareEdge (const std::pair<unsigned char, int>& edge, unsigned char ch)
     {
-        int ch = tolower (keyword.at (depth), mLocale);
+        return edge.first < ch;
+    }
 
-        typename Entry::childen_t::iterator j = entry.mChildren.find (ch);
+    unsigned char fold (char ch) const
+    {
+        return mFold[static_cast<unsigned char> (ch)];
+    }
 
-        if (j == entry.mChildren.end ())
-        {
-            entry.mChildren [ch].mValue = /*std::move*/ (value);
-            entry.mChildren [ch].mKeyword = /*std::move*/ (keyword);
-        }
-        else
-        {
-            if (j->second.mKeyword.size () > 0)
-            {
-                if (keyword == j->second.mKeyword)
-                    throw std::runtime_error ("duplicate keyword inserted");
+    /// @return the child of \a node for the byte \a ch, or -1
+    int findChild (int node, unsigned char ch) const
+    {
+        const typename Node::Children& children = mNodes[node].mChildren;
+
+        typename Node::Children::const_iterator iter =
+            std::lower_bound (children.begin(), children.end(), ch, compareEdge);
+
+        if (iter == children.end() || iter->first != ch)
+            return -1;
+
+        return iter->second;
+    }
+
+    /// Add a trie node below \a parent and link it into the automaton.
+    int addNode (int parent, unsigned char ch)
+    {
+        int node = static_cast<int> (mNodes.size());
+        mNodes.push_back (Node (mNodes[parent].mDepth+1));
 
-                value_t pushValue = /*std::move*/ (j->second.mValue);
-                string_t pushKeyword = /*std::move*/ (j->second.mKeyword);
+        typename Node::Children& children = mNodes[parent].mChildren;
+        children.insert (std::lower_bound (children.begin(), children.end(), ch, compareEdge),
+            std::make_pair (ch, node));
 
-                if (depth >= pushKeyword.size ())
-                    throw std::runtime_error ("unexpected");
+        // the failure target is shallower than the new node and therefore already linked correctly
+        int fail = 0;
 
-                if (depth+1 < pushKeyword.size())
+        if (parent != 0)
+        {
+            for (int current = mNodes[parent].mFail; ; current = mNodes[current].mFail)
+            {
+                int child = findChild (current, ch);
+
+                if (child != -1)
                 {
-                    seed_impl (/*std::move*/ (pushKeyword), /*std::move*/ (pushValue), depth+1, j->second);
-                    j->second.mKeyword.clear ();
+                    fail = child;
+                    break;
                 }
+
+                if (current == 0)
+                    break;
             }
-            if (depth+1 == keyword.size())
-                j->second.mKeyword = value;
-            else // depth+1 < keyword.size()
-                seed_impl (/*std::move*/ (keyword), /*std::move*/ (value), depth+1, j->second);
         }
 
+        attachFail (node, fail);
+        mNodes[node].mOutput = mNodes[fail].mKeyword != -1 ? fail : mNodes[fail].mOutput;
+
+        // Existing nodes ending in ch whose failure chain reaches the parent before any other node with an
+        // edge for ch now fail to the new node. The new node fails to where they failed before, so their
+        // output links stay the same.
+        std::vector<int> stack;
+        pushFailChildren (parent, stack);
+
+        while (!stack.empty())
+        {
+            int current = stack.back();
+            stack.pop_back();
+
+            int child = findChild (current, ch);
+
+            if (child == -1)
+                pushFailChildren (current, stack);
+            else if (mNodes[child].mFail != node)
+            {
+                detachFail (child);
+                attachFail (child, node);
+            }
+        }
+
+        return node;
+    }
+
+    void pushFailChildren (int node, std::vector<int>& stack) const
+    {
+        for (int child = mNodes[node].mFailChild; child != -1; child = mNodes[child].mFailNext)
+            stack.push_back (child);
+    }
+
+    void attachFail (int node, int fail)
+    {
+        int next = mNodes[fail].mFailChild;
+
+        mNodes[node].mFail = fail;
+        mNodes[node].mFailPrev = -1;
+        mNodes[node].mFailNext = next;
+
+        if (next != -1)
+            mNodes[next].mFailPrev = node;
+
+        mNodes[fail].mFailChild = node;
     }
 
-    Entry mRoot;
+    void detachFail (int node)
+    {
+        int prev = mNodes[node].mFailPrev;
+        int next = mNodes[node].mFailNext;
+
+        if (prev != -1)
+            mNodes[prev].mFailNext = next;
+        else
+            mNodes[mNodes[node].mFail].mFailChild = next;
+
+        if (next != -1)
+            mNodes[next].mFailPrev = prev;
+    }
+
+    std::vector<Node> mNodes;
+    std::vector<std::pair<string_t, value_t> > mKeywords;
+
+    unsigned char mFold[256];
+
     std::locale mLocale;
 };
 
@@ -48,7 +48,7 @@ MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction()
 {
     int index = 0;
 
-    std::istringstream (mSelect.mSelectRule.substr(2,2)) >> index;
+    std::istringstream (mSelect->mSelectRule.substr(2,2)) >> index;
 
     switch (index)
     {
@@ -97,11 +97,20 @@ MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction()
     return Function_False;
 }
 
-MWDialogue::SelectWrapper::SelectWrapper (const ESM::DialInfo::SelectStruct& select) : mSelect (select) {}
+MWDialogue::SelectWrapper::SelectWrapper (const ESM::DialInfo::SelectStruct& select)
+: mSelect (&select), mNameId (-1)
+{
+    mFunction = decodeFunctionType();
+    mArgument = decodeArgument();
+    mType = decodeType();
+    mNpcOnly = decodeNpcOnly();
+    if (mSelect->mSelectRule.size()>5)
+        mName = Misc::StringUtils::lowerCase (mSelect->mSelectRule.substr (5));
+}
 
-MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() const
+MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunctionType() const
 {
-    char type = mSelect.mSelectRule[1];
+    char type = mSelect->mSelectRule[1];
 
     switch (type)
     {
@@ -122,14 +131,14 @@ MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() con
     return Function_None;
 }
 
-int MWDialogue::SelectWrapper::getArgument() const
+int MWDialogue::SelectWrapper::decodeArgument() const
 {
-    if (mSelect.mSelectRule[1]!='1')
+    if (mSelect->mSelectRule[1]!='1')
         return 0;
 
     int index = 0;
 
-    std::istringstream (mSelect.mSelectRule.substr(2,2)) >> index;
+    std::istringstream (mSelect->mSelectRule.substr(2,2)) >> index;
 
     switch (index)
     {
@@ -187,7 +196,7 @@ int MWDialogue::SelectWrapper::getArgument() const
     return 0;
 }
 
-MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
+MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::decodeType() const
 {
     static const Function integerFunctions[] =
     {
@@ -236,7 +245,7 @@ MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
         Function_None // end marker
     };
 
-    Function function = getFunction();
+    Function function = mFunction;
 
     for (int i=0; integerFunctions[i]!=Function_None; ++i)
         if (integerFunctions[i]==function)
@@ -257,7 +266,7 @@ MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
     return Type_None;
 }
 
-bool MWDialogue::SelectWrapper::isNpcOnly() const
+bool MWDialogue::SelectWrapper::decodeNpcOnly() const
 {
     static const Function functions[] =
     {
@@ -274,7 +283,7 @@ bool MWDialogue::SelectWrapper::isNpcOnly() const
         Function_None // end marker
     };
 
-    Function function = getFunction();
+    Function function = mFunction;
 
     for (int i=0; functions[i]!=Function_None; ++i)
         if (functions[i]==function)
@@ -283,22 +292,52 @@ bool MWDialogue::SelectWrapper::isNpcOnly() const
     return false;
 }
 
+MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() const
+{
+    return mFunction;
+}
+
+int MWDialogue::SelectWrapper::getArgument() const
+{
+    return mArgument;
+}
+
+MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
+{
+    return mType;
+}
+
+bool MWDialogue::SelectWrapper::isNpcOnly() const
+{
+    return mNpcOnly;
+}
+
 bool MWDialogue::SelectWrapper::selectCompare (int value) const
 {
-    return selectCompareImp (mSelect, value);
+    return selectCompareImp (*mSelect, value);
 }
 
 bool MWDialogue::SelectWrapper::selectCompare (float value) const
 {
-    return selectCompareImp (mSelect, value);
+    return selectCompareImp (*mSelect, value);
 }
 
 bool MWDialogue::SelectWrapper::selectCompare (bool value) const
 {
-    return selectCompareImp (mSelect, static_cast<int> (value));
+    return selectCompareImp (*mSelect, static_cast<int> (value));
+}
+
+const std::string& MWDialogue::SelectWrapper::getName() const
+{
+    return mName;
+}
+
+int MWDialogue::SelectWrapper::getNameId() const
+{
+    return mNameId;
 }
 
-std::string MWDialogue::SelectWrapper::getName() const
+void MWDialogue::SelectWrapper::setNameId (int id)
 {
-    return Misc::StringUtils::lowerCase (mSelect.mSelectRule.substr (5));
+    mNameId = id;
 }
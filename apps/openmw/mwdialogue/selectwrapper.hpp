@@ -7,8 +7,6 @@ namespace MWDialogue
 {
     class SelectWrapper
     {
-            const ESM::DialInfo::SelectStruct& mSelect;
-
         public:
 
             enum Function
@@ -57,8 +55,27 @@ namespace MWDialogue
 
         private:
 
+            const ESM::DialInfo::SelectStruct* mSelect;
+
+            // Decoded once on construction, so that repeated evaluations of the same select struct
+            // do not have to parse the select rule again.
+            Function mFunction;
+            int mArgument;
+            Type mType;
+            bool mNpcOnly;
+            std::string mName;
+            int mNameId;
+
             Function decodeFunction() const;
 
+            Function decodeFunctionType() const;
+
+            int decodeArgument() const;
+
+            Type decodeType() const;
+
+            bool decodeNpcOnly() const;
+
         public:
 
             SelectWrapper (const ESM::DialInfo::SelectStruct& select);
@@ -78,8 +95,13 @@ namespace MWDialogue
 
             bool selectCompare (bool value) const;
 
-            std::string getName() const;
+            const std::string& getName() const;
             ///< Return case-smashed name.
+
+            int getNameId() const;
+            ///< Return the interned ID of the name, or -1 if the name has not been interned.
+
+            void setNameId (int id);
     };
 }
 
@@ -1,5 +1,6 @@
 #include "itemview.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 #include <MyGUI_FactoryManager.h>
@@ -20,6 +21,10 @@ namespace MWGui
 ItemView::ItemView()
     : mModel(NULL)
     , mScrollView(NULL)
+    , mDragArea(NULL)
+    , mRows(1)
+    , mFirstVisible(0)
+    , mVisibleCount(0)
 {
 }
 
@@ -48,41 +53,36 @@ void ItemView::initialiseOverride()
         throw std::runtime_error("Item view needs a scroll view");
 
     mScrollView->setCanvasAlign(MyGUI::Align::Left | MyGUI::Align::Top);
+
+    MyGUI::Gui::getInstance().eventFrameStart += MyGUI::newDelegate(this, &ItemView::onFrame);
+}
+
+void ItemView::shutdownOverride()
+{
+    MyGUI::Gui::getInstance().eventFrameStart -= MyGUI::newDelegate(this, &ItemView::onFrame);
+
+    Base::shutdownOverride();
 }
 
 void ItemView::layoutWidgets()
 {
-    if (!mScrollView->getChildCount())
+    if (!mDragArea)
         return;
 
-    int x = 0;
-    int y = 0;
-    MyGUI::Widget* dragArea = mScrollView->getChildAt(0);
+    int itemCount = mModel ? static_cast<int>(mModel->getItemCount()) : 0;
+
     int maxHeight = mScrollView->getHeight();
 
     int rows = maxHeight/42;
     rows = std::max(rows, 1);
-    bool showScrollbar = int(std::ceil(dragArea->getChildCount()/float(rows))) > mScrollView->getWidth()/42;
+    bool showScrollbar = int(std::ceil(itemCount/float(rows))) > mScrollView->getWidth()/42;
     if (showScrollbar)
         maxHeight -= 18;
 
-    for (unsigned int i=0; i<dragArea->getChildCount(); ++i)
-    {
-        MyGUI::Widget* w = dragArea->getChildAt(i);
-
-        w->setPosition(x, y);
-
-        y += 42;
+    mRows = std::max(maxHeight/42, 1);
+    int columns = std::max(int(std::ceil(itemCount/float(mRows))), 1);
 
-        if (y > maxHeight-42 && i < dragArea->getChildCount()-1)
-        {
-            x += 42;
-            y = 0;
-        }
-    }
-    x += 42;
-
-    MyGUI::IntSize size = MyGUI::IntSize(std::max(mScrollView->getSize().width, x), mScrollView->getSize().height);
+    MyGUI::IntSize size = MyGUI::IntSize(std::max(mScrollView->getSize().width, columns*42), mScrollView->getSize().height);
 
     // Canvas size must be expressed with VScroll disabled, otherwise MyGUI would expand the scroll area when the scrollbar is hidden
     mScrollView->setVisibleVScroll(false);
@@ -90,33 +90,59 @@ void ItemView::layoutWidgets()
     mScrollView->setCanvasSize(size);
     mScrollView->setVisibleVScroll(true);
     mScrollView->setVisibleHScroll(true);
-    dragArea->setSize(size);
+    mDragArea->setSize(size);
+
+    updateVisibleItems(true);
 }
 
-void ItemView::update()
+void ItemView::updateVisibleItems(bool force)
 {
-    while (mScrollView->getChildCount())
-        MyGUI::Gui::getInstance().destroyWidget(mScrollView->getChildAt(0));
-
-    if (!mModel)
+    if (!mDragArea)
         return;
 
-    mModel->update();
+    mViewOffset = mScrollView->getViewOffset();
 
-    MyGUI::Widget* dragArea = mScrollView->createWidget<MyGUI::Widget>("",0,0,mScrollView->getWidth(),mScrollView->getHeight(),
-                                                                       MyGUI::Align::Stretch);
-    dragArea->setNeedMouseFocus(true);
-    dragArea->eventMouseButtonClick += MyGUI::newDelegate(this, &ItemView::onSelectedBackground);
-    dragArea->eventMouseWheel += MyGUI::newDelegate(this, &ItemView::onMouseWheelMoved);
+    int itemCount = mModel ? static_cast<int>(mModel->getItemCount()) : 0;
 
-    for (ItemModel::ModelIndex i=0; i<static_cast<int>(mModel->getItemCount()); ++i)
-    {
-        const ItemStack& item = mModel->getItem(i);
+    // the columns in view, including the partially visible ones at both edges
+    int firstColumn = std::max(-mViewOffset.left / 42, 0);
+    int columns = mScrollView->getWidth() / 42 + 2;
+
+    int first = std::min(firstColumn * mRows, itemCount);
+    int count = std::min(columns * mRows, itemCount - first);
 
-        ItemWidget* itemWidget = dragArea->createWidget<ItemWidget>("MW_ItemIcon",
+    if (!force && first == mFirstVisible && count == mVisibleCount)
+        return;
+
+    mFirstVisible = first;
+    mVisibleCount = count;
+
+    while (static_cast<int>(mItemWidgets.size()) < count)
+    {
+        ItemWidget* itemWidget = mDragArea->createWidget<ItemWidget>("MW_ItemIcon",
             MyGUI::IntCoord(0, 0, 42, 42), MyGUI::Align::Default);
         itemWidget->setUserString("ToolTipType", "ItemModelIndex");
-        itemWidget->setUserData(std::make_pair(i, mModel));
+
+        itemWidget->eventMouseButtonClick += MyGUI::newDelegate(this, &ItemView::onSelectedItem);
+        itemWidget->eventMouseWheel += MyGUI::newDelegate(this, &ItemView::onMouseWheelMoved);
+
+        mItemWidgets.push_back(itemWidget);
+    }
+
+    for (int i=0; i<static_cast<int>(mItemWidgets.size()); ++i)
+    {
+        ItemWidget* itemWidget = mItemWidgets[i];
+        if (i >= count)
+        {
+            itemWidget->setVisible(false);
+            continue;
+        }
+
+        ItemModel::ModelIndex index = first + i;
+        const ItemStack& item = mModel->getItem(index);
+
+        itemWidget->setPosition((index / mRows) * 42, (index % mRows) * 42);
+        itemWidget->setUserData(std::make_pair(index, mModel));
         ItemWidget::ItemState state = ItemWidget::None;
         if (item.mType == ItemStack::Type_Barter)
             state = ItemWidget::Barter;
@@ -124,17 +150,31 @@ void ItemView::update()
             state = ItemWidget::Equip;
         itemWidget->setItem(item.mBase, state);
         itemWidget->setCount(item.mCount);
+        itemWidget->setVisible(true);
+    }
+}
 
-        itemWidget->eventMouseButtonClick += MyGUI::newDelegate(this, &ItemView::onSelectedItem);
-        itemWidget->eventMouseWheel += MyGUI::newDelegate(this, &ItemView::onMouseWheelMoved);
+void ItemView::update()
+{
+    if (!mDragArea)
+    {
+        mDragArea = mScrollView->createWidget<MyGUI::Widget>("",0,0,mScrollView->getWidth(),mScrollView->getHeight(),
+                                                             MyGUI::Align::Stretch);
+        mDragArea->setNeedMouseFocus(true);
+        mDragArea->eventMouseButtonClick += MyGUI::newDelegate(this, &ItemView::onSelectedBackground);
+        mDragArea->eventMouseWheel += MyGUI::newDelegate(this, &ItemView::onMouseWheelMoved);
     }
 
+    if (mModel)
+        mModel->update();
+
     layoutWidgets();
 }
 
 void ItemView::resetScrollBars()
 {
     mScrollView->setViewOffset(MyGUI::IntPoint(0, 0));
+    updateVisibleItems(false);
 }
 
 void ItemView::onSelectedItem(MyGUI::Widget *sender)
@@ -154,6 +194,15 @@ void ItemView::onMouseWheelMoved(MyGUI::Widget *_sender, int _rel)
         mScrollView->setViewOffset(MyGUI::IntPoint(0, 0));
     else
         mScrollView->setViewOffset(MyGUI::IntPoint(static_cast<int>(mScrollView->getViewOffset().left + _rel*0.3f), 0));
+
+    updateVisibleItems(false);
+}
+
+void ItemView::onFrame(float dt)
+{
+    // dragging the scroll bar
+    if (getInheritedVisible() && mScrollView->getViewOffset() != mViewOffset)
+        updateVisibleItems(false);
 }
 
 void ItemView::setSize(const MyGUI::IntSize &_value)
@@ -1,6 +1,8 @@
 #ifndef MWGUI_ITEMVIEW_H
 #define MWGUI_ITEMVIEW_H
 
+#include <vector>
+
 #include <MyGUI_Widget.h>
 
 #include "itemmodel.hpp"
@@ -8,6 +10,11 @@
 namespace MWGui
 {
 
+    class ItemWidget;
+
+    /// @brief Shows the items of an ItemModel in columns of icons
+    ///
+    /// Widgets are only created for the columns in view, and are reused for other items when the view is scrolled.
     class ItemView : public MyGUI::Widget
     {
     MYGUI_RTTI_DERIVED(ItemView)
@@ -34,9 +41,16 @@ namespace MWGui
 
     private:
         virtual void initialiseOverride();
+        virtual void shutdownOverride();
 
         void layoutWidgets();
 
+        /// Assign the items in view to widgets.
+        /// @param force Refill widgets even if they show the same index as before, e.g. after the model was updated.
+        void updateVisibleItems(bool force);
+
+        void onFrame(float dt);
+
         virtual void setSize(const MyGUI::IntSize& _value);
         virtual void setCoord(const MyGUI::IntCoord& _value);
 
@@ -46,6 +60,17 @@ namespace MWGui
 
         ItemModel* mModel;
         MyGUI::ScrollView* mScrollView;
+        MyGUI::Widget* mDragArea;
+
+        int mRows;
+
+        // the widget at position i shows the item at index mFirstVisible + i
+        std::vector<ItemWidget*> mItemWidgets;
+        int mFirstVisible;
+        int mVisibleCount;
+
+        // the scroll view has no event for scrolling, so its offset is checked every frame
+        MyGUI::IntPoint mViewOffset;
 
     };
 
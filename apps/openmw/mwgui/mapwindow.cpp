@@ -385,10 +385,13 @@ namespace MWGui
                 osg::ref_ptr<osg::Texture2D> texture = mLocalMapRender->getMapTexture(mapX, mapY);
                 if (texture)
                 {
+                    float left, bottom, right, top;
+                    mLocalMapRender->getMapTextureCoords(mapX, mapY, left, bottom, right, top);
+
                     boost::shared_ptr<MyGUI::ITexture> guiTex (new osgMyGUI::OSGTexture(texture));
                     textures.push_back(guiTex);
                     box->setRenderItemTexture(guiTex.get());
-                    box->getSubWidgetMain()->_setUVSet(MyGUI::FloatRect(0.f, 1.f, 1.f, 0.f));
+                    box->getSubWidgetMain()->_setUVSet(MyGUI::FloatRect(left, top, right, bottom));
                 }
                 else
                     box->setRenderItemTexture(NULL);
@@ -587,7 +590,8 @@ namespace MWGui
 
     // ------------------------------------------------------------------------------------------
 
-    MapWindow::MapWindow(CustomMarkerCollection &customMarkers, DragAndDrop* drag, MWRender::LocalMap* localMapRender)
+    MapWindow::MapWindow(CustomMarkerCollection &customMarkers, DragAndDrop* drag, MWRender::LocalMap* localMapRender,
+                         const std::string& cachePath)
         : WindowPinnableBase("openmw_map_window.layout")
         , LocalMapBase(customMarkers, localMapRender)
         , NoDrop(drag, mMainWidget)
@@ -597,7 +601,7 @@ namespace MWGui
         , mGlobal(false)
         , mEventBoxGlobal(NULL)
         , mEventBoxLocal(NULL)
-        , mGlobalMapRender(new MWRender::GlobalMap(localMapRender->getRoot()))
+        , mGlobalMapRender(new MWRender::GlobalMap(localMapRender->getRoot(), cachePath))
         , mEditNoteDialog()
     {
         static bool registered = false;
@@ -811,7 +815,11 @@ namespace MWGui
 
         for (std::vector<CellId>::iterator it = mQueuedToExplore.begin(); it != mQueuedToExplore.end(); ++it)
         {
-            mGlobalMapRender->exploreCell(it->first, it->second, mLocalMapRender->getMapTexture(it->first, it->second));
+            float left, bottom, right, top;
+            mLocalMapRender->getMapTextureCoords(it->first, it->second, left, bottom, right, top);
+
+            mGlobalMapRender->exploreCell(it->first, it->second, mLocalMapRender->getMapTexture(it->first, it->second),
+                                          left, bottom, right, top);
         }
 
         mQueuedToExplore.clear();
@@ -1,5 +1,8 @@
 #include "sortfilteritemmodel.hpp"
 
+#include <algorithm>
+#include <map>
+
 #include <components/misc/stringops.hpp>
 
 #include <components/esm/loadalch.hpp>
@@ -20,56 +23,55 @@
 
 namespace
 {
-    bool compareType(const std::string& type1, const std::string& type2)
+    int getTypeOrder(const std::string& type)
     {
         // this defines the sorting order of types. types that are first in the vector appear before other types.
-        std::vector<std::string> mapping;
-        mapping.push_back( typeid(ESM::Weapon).name() );
-        mapping.push_back( typeid(ESM::Armor).name() );
-        mapping.push_back( typeid(ESM::Clothing).name() );
-        mapping.push_back( typeid(ESM::Potion).name() );
-        mapping.push_back( typeid(ESM::Ingredient).name() );
-        mapping.push_back( typeid(ESM::Apparatus).name() );
-        mapping.push_back( typeid(ESM::Book).name() );
-        mapping.push_back( typeid(ESM::Light).name() );
-        mapping.push_back( typeid(ESM::Miscellaneous).name() );
-        mapping.push_back( typeid(ESM::Lockpick).name() );
-        mapping.push_back( typeid(ESM::Repair).name() );
-        mapping.push_back( typeid(ESM::Probe).name() );
-
-        assert( std::find(mapping.begin(), mapping.end(), type1) != mapping.end() );
-        assert( std::find(mapping.begin(), mapping.end(), type2) != mapping.end() );
-
-        return std::find(mapping.begin(), mapping.end(), type1) < std::find(mapping.begin(), mapping.end(), type2);
+        static std::vector<std::string> mapping;
+        if (mapping.empty())
+        {
+            mapping.push_back( typeid(ESM::Weapon).name() );
+            mapping.push_back( typeid(ESM::Armor).name() );
+            mapping.push_back( typeid(ESM::Clothing).name() );
+            mapping.push_back( typeid(ESM::Potion).name() );
+            mapping.push_back( typeid(ESM::Ingredient).name() );
+            mapping.push_back( typeid(ESM::Apparatus).name() );
+            mapping.push_back( typeid(ESM::Book).name() );
+            mapping.push_back( typeid(ESM::Light).name() );
+            mapping.push_back( typeid(ESM::Miscellaneous).name() );
+            mapping.push_back( typeid(ESM::Lockpick).name() );
+            mapping.push_back( typeid(ESM::Repair).name() );
+            mapping.push_back( typeid(ESM::Probe).name() );
+        }
+
+        std::vector<std::string>::const_iterator found = std::find(mapping.begin(), mapping.end(), type);
+        assert( found != mapping.end() );
+
+        return found - mapping.begin();
     }
 
-    struct Compare
+}
+
+namespace MWGui
+{
+
+    struct SortFilterItemModel::CompareEntries
     {
         bool mSortByType;
-        Compare() : mSortByType(true) {}
-        bool operator() (const MWGui::ItemStack& left, const MWGui::ItemStack& right)
+        CompareEntries(bool sortByType) : mSortByType(sortByType) {}
+        bool operator() (const SortEntry& left, const SortEntry& right) const
         {
-            if (mSortByType && left.mType != right.mType)
-                return left.mType < right.mType;
-
-            if (left.mBase.getTypeName() == right.mBase.getTypeName())
-            {
-                std::string leftName = Misc::StringUtils::lowerCase(left.mBase.getClass().getName(left.mBase));
-                std::string rightName = Misc::StringUtils::lowerCase(right.mBase.getClass().getName(right.mBase));
+            if (mSortByType && left.mItem.mType != right.mItem.mType)
+                return left.mItem.mType < right.mItem.mType;
 
-                return leftName.compare(rightName) < 0;
-            }
-            else
-                return compareType(left.mBase.getTypeName(), right.mBase.getTypeName());
+            if (left.mTypeOrder != right.mTypeOrder)
+                return left.mTypeOrder < right.mTypeOrder;
+            return left.mName < right.mName;
         }
     };
-}
-
-namespace MWGui
-{
 
     SortFilterItemModel::SortFilterItemModel(ItemModel *sourceModel)
-        : mCategory(Category_All)
+        : mEntriesSortedByType(true)
+        , mCategory(Category_All)
         , mFilter(0)
         , mSortByType(true)
     {
@@ -143,14 +145,14 @@ namespace MWGui
     {
         if (index < 0)
             throw std::runtime_error("Invalid index supplied");
-        if (mItems.size() <= static_cast<size_t>(index))
+        if (mEntries.size() <= static_cast<size_t>(index))
             throw std::runtime_error("Item index out of range");
-        return mItems[index];
+        return mEntries[index].mItem;
     }
 
     size_t SortFilterItemModel::getItemCount()
     {
-        return mItems.size();
+        return mEntries.size();
     }
 
     void SortFilterItemModel::setCategory (int category)
@@ -167,9 +169,17 @@ namespace MWGui
     {
         mSourceModel->update();
 
-        size_t count = mSourceModel->getItemCount();
+        // entries of the last update by item. The ID guards against a new item that took the place of a removed one.
+        typedef std::map<std::pair<MWWorld::Ptr, int>, size_t> EntryIndex;
+        EntryIndex previous;
+        for (size_t i=0; i<mEntries.size(); ++i)
+            previous[std::make_pair(mEntries[i].mItem.mBase, static_cast<int>(mEntries[i].mItem.mType))] = i;
+
+        std::vector<ItemStack> kept (mEntries.size());
+        std::vector<bool> isKept (mEntries.size(), false);
+        std::vector<SortEntry> added;
 
-        mItems.clear();
+        size_t count = mSourceModel->getItemCount();
         for (size_t i=0; i<count; ++i)
         {
             ItemStack item = mSourceModel->getItem(i);
@@ -184,13 +194,55 @@ namespace MWGui
                 }
             }
 
-            if (item.mCount > 0 && filterAccepts(item))
-                mItems.push_back(item);
+            if (item.mCount == 0 || !filterAccepts(item))
+                continue;
+
+            const std::string& id = item.mBase.getCellRef().getRefId();
+
+            EntryIndex::const_iterator found = previous.find(std::make_pair(item.mBase, static_cast<int>(item.mType)));
+            if (found != previous.end() && !isKept[found->second] && mEntries[found->second].mId == id)
+            {
+                kept[found->second] = item;
+                isKept[found->second] = true;
+                continue;
+            }
+
+            SortEntry entry;
+            entry.mItem = item;
+            entry.mId = id;
+            entry.mTypeOrder = getTypeOrder(item.mBase.getTypeName());
+            entry.mName = Misc::StringUtils::lowerCase(item.mBase.getClass().getName(item.mBase));
+            added.push_back(entry);
+        }
+
+        // the remaining items are still in order, with their counts and flags updated
+        std::vector<SortEntry> entries;
+        entries.reserve(count);
+        for (size_t i=0; i<mEntries.size(); ++i)
+        {
+            if (!isKept[i])
+                continue;
+            entries.push_back(mEntries[i]);
+            entries.back().mItem = kept[i];
+        }
+
+        CompareEntries cmp (mSortByType);
+        if (mSortByType != mEntriesSortedByType)
+        {
+            entries.insert(entries.end(), added.begin(), added.end());
+            std::sort(entries.begin(), entries.end(), cmp);
+        }
+        else if (!added.empty())
+        {
+            std::sort(added.begin(), added.end(), cmp);
+
+            size_t middle = entries.size();
+            entries.insert(entries.end(), added.begin(), added.end());
+            std::inplace_merge(entries.begin(), entries.begin() + middle, entries.end(), cmp);
         }
 
-        Compare cmp;
-        cmp.mSortByType = mSortByType;
-        std::sort(mItems.begin(), mItems.end(), cmp);
+        mEntries.swap(entries);
+        mEntriesSortedByType = mSortByType;
     }
 
 }
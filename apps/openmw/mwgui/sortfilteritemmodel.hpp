@@ -1,6 +1,9 @@
 #ifndef MWGUI_SORT_FILTER_ITEM_MODEL_H
 #define MWGUI_SORT_FILTER_ITEM_MODEL_H
 
+#include <string>
+#include <vector>
+
 #include "itemmodel.hpp"
 
 namespace MWGui
@@ -42,7 +45,21 @@ namespace MWGui
 
 
     private:
-        std::vector<ItemStack> mItems;
+        // an item with its sort key, type order and lower case name, so the names are not looked up for each
+        // comparison
+        struct SortEntry
+        {
+            ItemStack mItem;
+            std::string mId;
+            int mTypeOrder;
+            std::string mName;
+        };
+        struct CompareEntries;
+
+        // the items of the last update, sorted. Items that are still there keep their entry and their place, so
+        // an update only has to compute the keys of and sort the items that were added.
+        std::vector<SortEntry> mEntries;
+        bool mEntriesSortedByType;
 
         std::vector<std::pair<MWWorld::Ptr, size_t> > mDragItems;
 
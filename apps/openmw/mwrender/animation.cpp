@@ -292,6 +292,9 @@ namespace MWRender
         , mTextKeyListener(NULL)
         , mHeadYawRadians(0.f)
         , mHeadPitchRadians(0.f)
+        , mUpdateLodDistance(0.f)
+        , mMaxUpdateInterval(1)
+        , mHasExtraLight(false)
     {
         for(size_t i = 0;i < sNumBlendMasks;i++)
             mAnimationTimePtr[i].reset(new AnimationTime);
@@ -318,6 +321,24 @@ namespace MWRender
         }
     }
 
+    void Animation::setUpdateLod(float distance, unsigned int maxInterval)
+    {
+        mUpdateLodDistance = distance;
+        mMaxUpdateInterval = maxInterval;
+        applyUpdateLod();
+    }
+
+    void Animation::applyUpdateLod()
+    {
+        if (SceneUtil::Skeleton* skel = dynamic_cast<SceneUtil::Skeleton*>(mObjectRoot.get()))
+        {
+            if (mHasExtraLight)
+                skel->setUpdateLod(0.f, 1);
+            else
+                skel->setUpdateLod(mUpdateLodDistance, mMaxUpdateInterval);
+        }
+    }
+
     void Animation::updatePtr(const MWWorld::Ptr &ptr)
     {
         mPtr = ptr;
@@ -942,6 +963,7 @@ namespace MWRender
         mActiveControllers.clear();
         mAccumRoot = NULL;
         mAccumCtrl = NULL;
+        mHasExtraLight = false;
 
         if (!forceskeleton)
             mObjectRoot = mResourceSystem->getSceneManager()->createInstance(model, mInsert);
@@ -977,6 +999,8 @@ namespace MWRender
         mNodeMap = visitor.getNodeMap();
 
         mObjectRoot->addCullCallback(new SceneUtil::LightListCallback);
+
+        applyUpdateLod();
     }
 
     osg::Group* Animation::getObjectRoot()
@@ -1055,6 +1079,9 @@ namespace MWRender
             attachTo = trans;
         }
 
+        mHasExtraLight = true;
+        applyUpdateLod();
+
         osg::ref_ptr<SceneUtil::LightSource> lightSource = new SceneUtil::LightSource;
         osg::Light* light = new osg::Light;
         lightSource->setLight(light);
@@ -1358,6 +1385,14 @@ namespace MWRender
             addExtraLight(getOrCreateObjectRoot(), ptr.get<ESM::Light>()->mBase);
     }
 
+    ObjectAnimation::ObjectAnimation(const MWWorld::Ptr &ptr, osg::ref_ptr<osg::Node> sharedNode, Resource::ResourceSystem* resourceSystem)
+        : Animation(ptr, osg::ref_ptr<osg::Group>(ptr.getRefData().getBaseNode()), resourceSystem)
+    {
+        // the light list depends on the position of this object, so it goes on our own root rather than the shared node
+        getOrCreateObjectRoot()->addChild(sharedNode);
+        mObjectRoot->addCullCallback(new SceneUtil::LightListCallback);
+    }
+
     Animation::AnimState::~AnimState()
     {
 
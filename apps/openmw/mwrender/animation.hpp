@@ -243,6 +243,13 @@ protected:
 
     osg::ref_ptr<SceneUtil::LightSource> mGlowLight;
 
+    float mUpdateLodDistance;
+    unsigned int mMaxUpdateInterval;
+    bool mHasExtraLight; // lights below the object root are found in the update traversal, so it can't be throttled
+
+    /// Apply the update LOD to the skeleton of the object root, if one exists.
+    void applyUpdateLod();
+
     /* Sets the appropriate animations on the bone groups based on priority.
      */
     void resetActiveGroups();
@@ -306,6 +313,10 @@ public:
     /// @see SceneUtil::Skeleton::setActive
     void setActive(bool active);
 
+    /// Set the update LOD of the object skeleton, if one exists. Kept when the object root is rebuilt.
+    /// @see SceneUtil::Skeleton::setUpdateLod
+    void setUpdateLod(float distance, unsigned int maxInterval);
+
     osg::Group* getOrCreateObjectRoot();
 
     osg::Group* getObjectRoot();
@@ -432,6 +443,11 @@ private:
 class ObjectAnimation : public Animation {
 public:
     ObjectAnimation(const MWWorld::Ptr& ptr, const std::string &model, Resource::ResourceSystem* resourceSystem, bool animated, bool allowLight);
+
+    /// Use a scene instance shared with other objects, instead of creating a copy of the model for this object.
+    /// @note The nodes of \a sharedNode are not added to the node map, so they can not be modified through this object.
+    /// @see Resource::SceneManager::getSharedInstance
+    ObjectAnimation(const MWWorld::Ptr& ptr, osg::ref_ptr<osg::Node> sharedNode, Resource::ResourceSystem* resourceSystem);
 };
 
 }
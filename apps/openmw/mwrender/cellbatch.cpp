@@ -0,0 +1,116 @@
+#include "cellbatch.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include <osg/Group>
+
+#include <components/sceneutil/workqueue.hpp>
+
+#include "mergestatics.hpp"
+#include "vismask.hpp"
+
+namespace MWRender
+{
+
+    CellBatch::CellBatch(osg::Group *parentNode)
+        : mParentNode(parentNode)
+        , mAttached(false)
+    {
+    }
+
+    CellBatch::~CellBatch()
+    {
+        if (mAttached)
+            mParentNode->removeChild(mResult->mNode);
+    }
+
+    void CellBatch::addObject(const MWWorld::Ptr &ptr, osg::Node *objectRoot, osg::Node *sharedNode)
+    {
+        Object object;
+        object.mRoot = objectRoot;
+        object.mSharedNode = sharedNode;
+        object.mIndex = -1;
+        mObjects[ptr] = object;
+    }
+
+    void CellBatch::removeObject(const MWWorld::Ptr &ptr)
+    {
+        ObjectMap::iterator found = mObjects.find(ptr);
+        if (found == mObjects.end())
+            return;
+
+        // if the merge is still running, update() takes care of it
+        if (mAttached && found->second.mIndex != -1)
+        {
+            removeFromMerge(found->second.mIndex);
+            found->second.mRoot->setNodeMask(~0u);
+        }
+
+        mObjects.erase(found);
+    }
+
+    void CellBatch::moveObject(const MWWorld::Ptr &ptr)
+    {
+        // the merge picks up the current transformation when it is started
+        if (mTicket)
+            removeObject(ptr);
+    }
+
+    void CellBatch::merge(SceneUtil::WorkQueue *workQueue)
+    {
+        if (mTicket || mObjects.empty())
+            return;
+
+        mResult = new MergeResult;
+        std::auto_ptr<MergeStaticsWorkItem> item (new MergeStaticsWorkItem(mResult, true));
+
+        for (ObjectMap::iterator it = mObjects.begin(); it != mObjects.end(); ++it)
+        {
+            // the merged geometry is attached next to the object's base node
+            osg::Matrix transform;
+            it->first.getRefData().getBaseNode()->computeLocalToWorldMatrix(transform, NULL);
+            item->addInput(it->second.mSharedNode, transform);
+
+            it->second.mIndex = mMerged.size();
+            mMerged.push_back(it->first);
+        }
+
+        mTicket = workQueue->addWorkItem(item.release());
+    }
+
+    void CellBatch::update()
+    {
+        if (mAttached || !mTicket || !mTicket->isDone())
+            return;
+
+        for (unsigned int i=0; i<mMerged.size(); ++i)
+        {
+            ObjectMap::iterator found = mObjects.find(mMerged[i]);
+            if (found == mObjects.end() || found->second.mIndex != static_cast<int>(i))
+                removeFromMerge(i);
+            else if (mResult->mMerged[i])
+                found->second.mRoot->setNodeMask(Mask_MergedObject);
+            else
+                found->second.mIndex = -1;
+        }
+
+        mResult->mNode->setNodeMask(Mask_MergedStatics);
+        mParentNode->addChild(mResult->mNode);
+        mAttached = true;
+    }
+
+    void CellBatch::removeFromMerge(int index)
+    {
+        std::vector<MergedRange>& ranges = mResult->mRanges[index];
+        for (std::vector<MergedRange>::iterator it = ranges.begin(); it != ranges.end(); ++it)
+        {
+            // collapse the triangles rather than erasing them, so the other ranges stay valid
+            osg::DrawElementsUInt::iterator first = it->mIndices->begin() + it->mFirst;
+            std::fill(first, first + it->mCount, *first);
+            it->mIndices->dirty();
+        }
+        ranges.clear();
+    }
+
+}
@@ -0,0 +1,84 @@
+#ifndef GAME_RENDER_CELLBATCH_H
+#define GAME_RENDER_CELLBATCH_H
+
+#include <map>
+#include <vector>
+
+#include <osg/ref_ptr>
+
+#include "../mwworld/ptr.hpp"
+
+namespace osg
+{
+    class Group;
+    class Node;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+    class WorkTicket;
+}
+
+namespace MWRender
+{
+
+    class MergeResult;
+
+    /// @brief Draws the static objects of a cell as a few merged geometries
+    ///
+    /// The geometry of objects using a shared scene instance (see Resource::SceneManager::getSharedInstance) is
+    /// transformed into combined vertex buffers, one per StateSet and area of the cell, on a worker thread. Once
+    /// the merge is done, the nodes of the merged objects are only used for intersections. Objects that are moved,
+    /// disabled or deleted afterwards are removed from the merged geometry and drawn on their own again.
+    class CellBatch
+    {
+    public:
+        CellBatch(osg::Group* parentNode);
+        ~CellBatch();
+
+        /// @param objectRoot Node drawing the object on its own, with \a sharedNode as its only child.
+        void addObject(const MWWorld::Ptr& ptr, osg::Node* objectRoot, osg::Node* sharedNode);
+
+        /// Remove the given object from the batch and draw it on its own again.
+        void removeObject(const MWWorld::Ptr& ptr);
+
+        /// The transformation of the given object is about to change, so it can not be part of the merge anymore.
+        /// @note Before the merge has started, the object stays in the batch.
+        void moveObject(const MWWorld::Ptr& ptr);
+
+        /// Start merging the objects added so far on a worker thread.
+        /// @note Objects added after this call are not merged.
+        void merge(SceneUtil::WorkQueue* workQueue);
+
+        /// Attach the merged geometry, if the worker thread is done with it.
+        void update();
+
+    private:
+        struct Object
+        {
+            osg::ref_ptr<osg::Node> mRoot;
+            osg::ref_ptr<osg::Node> mSharedNode;
+            int mIndex; // index in the merge, -1 if the object is not part of it
+        };
+
+        typedef std::map<MWWorld::Ptr, Object> ObjectMap;
+        ObjectMap mObjects;
+
+        std::vector<MWWorld::Ptr> mMerged; // by index in the merge
+
+        osg::ref_ptr<osg::Group> mParentNode;
+        osg::ref_ptr<MergeResult> mResult;
+        osg::ref_ptr<SceneUtil::WorkTicket> mTicket;
+        bool mAttached;
+
+        /// Remove the triangles of an object from the merged geometry.
+        void removeFromMerge(int index);
+
+        void operator = (const CellBatch&);
+        CellBatch(const CellBatch&);
+    };
+
+}
+
+#endif
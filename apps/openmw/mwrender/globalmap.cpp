@@ -1,6 +1,15 @@
 #include "globalmap.hpp"
 
+#include <algorithm>
 #include <climits>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <OpenThreads/Thread>
 
 #include <osg/Image>
 #include <osg/Texture2D>
@@ -23,10 +32,165 @@
 #include "../mwworld/esmstore.hpp"
 
 #include "vismask.hpp"
+#include "util.hpp"
 
 namespace
 {
 
+    int getNumThreads()
+    {
+        return std::max(1, OpenThreads::GetNumberOfProcessors());
+    }
+
+    /// Number of columns of cells coloured by one work item
+    const int sColumnsPerWorkItem = 8;
+
+    /// Colours a range of columns of cells in the base map image
+    class CreateMapWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        CreateMapWorkItem(osg::Image* image, int cellSize, int firstColumn, int columns, int rows)
+            : mImage(image)
+            , mCellSize(cellSize)
+            , mFirstColumn(firstColumn)
+            , mColumns(columns)
+            , mRows(rows)
+            , mHeights(columns*rows*81, SCHAR_MIN)
+        {
+        }
+
+        /// Height samples (ESM::Land::mWnam) of the cell in the given column and row, relative to
+        /// the first column of this work item. Cells without land keep the lowest value.
+        signed char* getHeights(int column, int row)
+        {
+            return &mHeights[(column * mRows + row) * 81];
+        }
+
+        virtual void doWork()
+        {
+            int width = mImage->s();
+            int height = mImage->t();
+            unsigned char* data = mImage->data();
+
+            for (int column = 0; column < mColumns; ++column)
+            {
+                for (int row = 0; row < mRows; ++row)
+                {
+                    const signed char* heights = getHeights(column, row);
+
+                    for (int cellY=0; cellY<mCellSize; ++cellY)
+                    {
+                        for (int cellX=0; cellX<mCellSize; ++cellX)
+                        {
+                            int vertexX = static_cast<int>(float(cellX)/float(mCellSize) * 9);
+                            int vertexY = static_cast<int>(float(cellY) / float(mCellSize) * 9);
+
+                            int texelX = (mFirstColumn + column) * mCellSize + cellX;
+                            int texelY = (height-1) - (row * mCellSize + cellY);
+
+                            unsigned char r,g,b;
+
+                            float y = (heights[vertexY * 9 + vertexX] << 4) / 2048.f;
+                            if (y < 0)
+                            {
+                                r = static_cast<unsigned char>(14 * y + 38);
+                                g = static_cast<unsigned char>(20 * y + 56);
+                                b = static_cast<unsigned char>(18 * y + 51);
+                            }
+                            else if (y < 0.3f)
+                            {
+                                if (y < 0.1f)
+                                    y *= 8.f;
+                                else
+                                {
+                                    y -= 0.1f;
+                                    y += 0.8f;
+                                }
+                                r = static_cast<unsigned char>(66 - 32 * y);
+                                g = static_cast<unsigned char>(48 - 23 * y);
+                                b = static_cast<unsigned char>(33 - 16 * y);
+                            }
+                            else
+                            {
+                                y -= 0.3f;
+                                y *= 1.428f;
+                                r = static_cast<unsigned char>(34 - 29 * y);
+                                g = static_cast<unsigned char>(25 - 20 * y);
+                                b = static_cast<unsigned char>(17 - 12 * y);
+                            }
+
+                            data[texelY * width * 3 + texelX * 3] = r;
+                            data[texelY * width * 3 + texelX * 3+1] = g;
+                            data[texelY * width * 3 + texelX * 3+2] = b;
+                        }
+                    }
+                }
+            }
+
+            mTicket->signalDone();
+        }
+
+    private:
+        osg::ref_ptr<osg::Image> mImage;
+        int mCellSize;
+        int mFirstColumn;
+        int mColumns;
+        int mRows;
+        std::vector<signed char> mHeights;
+    };
+
+    /// Writes the base map image and the key it belongs to into the cache directory
+    class WriteCacheWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        WriteCacheWorkItem(const boost::filesystem::path& path, const std::string& key, osg::Image* image)
+            : mPath(path)
+            , mKey(key)
+            , mImage(image)
+        {
+        }
+
+        virtual void doWork()
+        {
+            try
+            {
+                write();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Can't write global map cache: " << e.what() << std::endl;
+            }
+
+            mTicket->signalDone();
+        }
+
+    private:
+        void write()
+        {
+            osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("png");
+            if (!readerwriter)
+                throw std::runtime_error("no png readerwriter found");
+
+            boost::filesystem::create_directories(mPath);
+
+            // remove the key first, so an incomplete image is never used
+            boost::filesystem::remove(mPath / "globalmap.key");
+
+            boost::filesystem::ofstream image(mPath / "globalmap.png", std::ios::binary);
+            osgDB::ReaderWriter::WriteResult result = readerwriter->writeImage(*mImage, image);
+            image.close();
+            if (!result.success() || image.fail())
+                throw std::runtime_error("failed to write image");
+
+            boost::filesystem::ofstream key(mPath / "globalmap.key", std::ios::binary);
+            key << mKey;
+        }
+
+        boost::filesystem::path mPath;
+        std::string mKey;
+        osg::ref_ptr<osg::Image> mImage;
+    };
+
     // Create a screen-aligned quad with given texture coordinates.
     // Assumes a top-left origin of the sampled image.
     osg::ref_ptr<osg::Geometry> createTexturedQuad(float leftTexCoord, float topTexCoord, float rightTexCoord, float bottomTexCoord)
@@ -97,8 +261,9 @@ namespace
 namespace MWRender
 {
 
-    GlobalMap::GlobalMap(osg::Group* root)
-        : mRoot(root)
+    GlobalMap::GlobalMap(osg::Group* root, const std::string& cachePath)
+        : mCachePath(cachePath)
+        , mRoot(root)
         , mWidth(0)
         , mHeight(0)
         , mMinX(0), mMaxX(0)
@@ -110,6 +275,9 @@ namespace MWRender
 
     GlobalMap::~GlobalMap()
     {
+        // don't drop a cache that is still being written
+        if (mWriteCacheTicket)
+            mWriteCacheTicket->waitTillDone();
     }
 
     void GlobalMap::render (Loading::Listener* loadingListener)
@@ -139,79 +307,63 @@ namespace MWRender
         loadingListener->setProgressRange((mMaxX-mMinX+1) * (mMaxY-mMinY+1));
         loadingListener->setProgress(0);
 
-        osg::ref_ptr<osg::Image> image = new osg::Image;
-        image->allocateImage(mWidth, mHeight, 1, GL_RGB, GL_UNSIGNED_BYTE);
-        unsigned char* data = image->data();
+        std::string key = getCacheKey();
+
+        osg::ref_ptr<osg::Image> image = readCache(key);
 
-        for (int x = mMinX; x <= mMaxX; ++x)
+        if (!image)
         {
-            for (int y = mMinY; y <= mMaxY; ++y)
-            {
-                ESM::Land* land = esmStore.get<ESM::Land>().search (x,y);
+            image = new osg::Image;
+            image->allocateImage(mWidth, mHeight, 1, GL_RGB, GL_UNSIGNED_BYTE);
 
-                if (land)
-                {
-                    int mask = ESM::Land::DATA_WNAM;
-                    if (!land->isDataLoaded(mask))
-                        land->loadData(mask);
-                }
+            if (!mWorkQueue.get())
+                mWorkQueue.reset(new SceneUtil::WorkQueue(getNumThreads()));
 
-                for (int cellY=0; cellY<mCellSize; ++cellY)
-                {
-                    for (int cellX=0; cellX<mCellSize; ++cellX)
-                    {
-                        int vertexX = static_cast<int>(float(cellX)/float(mCellSize) * 9);
-                        int vertexY = static_cast<int>(float(cellY) / float(mCellSize) * 9);
+            // Land data is read here, since the readers can't be shared between threads. The
+            // colouring is done by the work queue meanwhile.
+            std::vector<osg::ref_ptr<SceneUtil::WorkTicket> > tickets;
 
+            for (int firstX = mMinX; firstX <= mMaxX; firstX += sColumnsPerWorkItem)
+            {
+                int columns = std::min(sColumnsPerWorkItem, mMaxX-firstX+1);
 
-                        int texelX = (x-mMinX) * mCellSize + cellX;
-                        int texelY = (mHeight-1) - ((y-mMinY) * mCellSize + cellY);
+                std::auto_ptr<CreateMapWorkItem> item (
+                    new CreateMapWorkItem(image, mCellSize, firstX-mMinX, columns, mMaxY-mMinY+1));
 
-                        unsigned char r,g,b;
+                for (int x = firstX; x < firstX+columns; ++x)
+                {
+                    for (int y = mMinY; y <= mMaxY; ++y)
+                    {
+                        ESM::Land* land = esmStore.get<ESM::Land>().search (x,y);
 
-                        float y = 0;
-                        if (land && land->mDataTypes & ESM::Land::DATA_WNAM)
-                            y = (land->mLandData->mWnam[vertexY * 9 + vertexX] << 4) / 2048.f;
-                        else
-                            y = (SCHAR_MIN << 4) / 2048.f;
-                        if (y < 0)
+                        if (land)
                         {
-                            r = static_cast<unsigned char>(14 * y + 38);
-                            g = static_cast<unsigned char>(20 * y + 56);
-                            b = static_cast<unsigned char>(18 * y + 51);
-                        }
-                        else if (y < 0.3f)
-                        {
-                            if (y < 0.1f)
-                                y *= 8.f;
-                            else
-                            {
-                                y -= 0.1f;
-                                y += 0.8f;
-                            }
-                            r = static_cast<unsigned char>(66 - 32 * y);
-                            g = static_cast<unsigned char>(48 - 23 * y);
-                            b = static_cast<unsigned char>(33 - 16 * y);
-                        }
-                        else
-                        {
-                            y -= 0.3f;
-                            y *= 1.428f;
-                            r = static_cast<unsigned char>(34 - 29 * y);
-                            g = static_cast<unsigned char>(25 - 20 * y);
-                            b = static_cast<unsigned char>(17 - 12 * y);
+                            int mask = ESM::Land::DATA_WNAM;
+                            if (!land->isDataLoaded(mask))
+                                land->loadData(mask);
+
+                            if (land->mDataTypes & ESM::Land::DATA_WNAM)
+                                std::copy(land->mLandData->mWnam, land->mLandData->mWnam+81,
+                                          item->getHeights(x-firstX, y-mMinY));
                         }
 
-                        data[texelY * mWidth * 3 + texelX * 3] = r;
-                        data[texelY * mWidth * 3 + texelX * 3+1] = g;
-                        data[texelY * mWidth * 3 + texelX * 3+2] = b;
+                        loadingListener->increaseProgress();
+                        if (land)
+                            land->unloadData();
                     }
                 }
-                loadingListener->increaseProgress();
-                if (land)
-                    land->unloadData();
+
+                tickets.push_back(mWorkQueue->addWorkItem(item.release()));
             }
+
+            for (std::vector<osg::ref_ptr<SceneUtil::WorkTicket> >::iterator it = tickets.begin(); it != tickets.end(); ++it)
+                (*it)->waitTillDone();
+
+            if (!key.empty())
+                writeCache(key, image);
         }
+        else
+            loadingListener->setProgress((mMaxX-mMinX+1) * (mMaxY-mMinY+1));
 
         mBaseTexture = new osg::Texture2D;
         mBaseTexture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
@@ -223,9 +375,84 @@ namespace MWRender
 
         clear();
 
+        releaseWorkQueue();
+
         loadingListener->loadingOff();
     }
 
+    std::string GlobalMap::getCacheKey()
+    {
+        if (mCachePath.empty())
+            return std::string();
+
+        std::ostringstream key;
+        key << "cell size " << mCellSize << "\n"
+            << "bounds " << mMinX << " " << mMaxX << " " << mMinY << " " << mMaxY << "\n";
+
+        try
+        {
+            key << getContentFilesKey();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Can't use global map cache: " << e.what() << std::endl;
+            return std::string();
+        }
+
+        return key.str();
+    }
+
+    osg::ref_ptr<osg::Image> GlobalMap::readCache(const std::string& key)
+    {
+        if (key.empty())
+            return osg::ref_ptr<osg::Image>();
+
+        boost::filesystem::path path (mCachePath);
+
+        boost::filesystem::ifstream keyStream(path / "globalmap.key", std::ios::binary);
+        if (!keyStream.is_open())
+            return osg::ref_ptr<osg::Image>();
+
+        std::ostringstream cachedKey;
+        cachedKey << keyStream.rdbuf();
+
+        if (cachedKey.str() != key)
+            return osg::ref_ptr<osg::Image>();
+
+        osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("png");
+        if (!readerwriter)
+            return osg::ref_ptr<osg::Image>();
+
+        boost::filesystem::ifstream imageStream(path / "globalmap.png", std::ios::binary);
+        osgDB::ReaderWriter::ReadResult result = readerwriter->readImage(imageStream);
+        if (!result.success())
+        {
+            std::cerr << "Can't read global map cache: " << result.message() << " code " << result.status() << std::endl;
+            return osg::ref_ptr<osg::Image>();
+        }
+
+        osg::ref_ptr<osg::Image> image = result.getImage();
+        if (image->s() != mWidth || image->t() != mHeight || image->getPixelFormat() != GL_RGB
+                || image->getDataType() != GL_UNSIGNED_BYTE)
+            return osg::ref_ptr<osg::Image>();
+
+        return image;
+    }
+
+    void GlobalMap::writeCache(const std::string& key, osg::ref_ptr<osg::Image> image)
+    {
+        mWriteCacheTicket = mWorkQueue->addWorkItem(new WriteCacheWorkItem(mCachePath, key, image));
+    }
+
+    void GlobalMap::releaseWorkQueue()
+    {
+        if (mWriteCacheTicket && !mWriteCacheTicket->isDone())
+            return;
+
+        mWriteCacheTicket = NULL;
+        mWorkQueue.reset();
+    }
+
     void GlobalMap::worldPosToImageSpace(float x, float z, float& imageX, float& imageY)
     {
         imageX = float(x / 8192.f - mMinX) / (mMaxX - mMinX + 1);
@@ -300,7 +527,8 @@ namespace MWRender
         mActiveCameras.push_back(camera);
     }
 
-    void GlobalMap::exploreCell(int cellX, int cellY, osg::ref_ptr<osg::Texture2D> localMapTexture)
+    void GlobalMap::exploreCell(int cellX, int cellY, osg::ref_ptr<osg::Texture2D> localMapTexture,
+                                float left, float bottom, float right, float top)
     {
         if (!localMapTexture)
             return;
@@ -311,7 +539,8 @@ namespace MWRender
         if (cellX > mMaxX || cellX < mMinX || cellY > mMaxY || cellY < mMinY)
             return;
 
-        requestOverlayTextureUpdate(originX, originY, mCellSize, mCellSize, localMapTexture, false, true);
+        requestOverlayTextureUpdate(originX, originY, mCellSize, mCellSize, localMapTexture, false, true,
+                                    left, 1.f-top, right, 1.f-bottom);
     }
 
     void GlobalMap::clear()
@@ -503,6 +732,9 @@ namespace MWRender
 
     void GlobalMap::cleanupCameras()
     {
+        if (mWorkQueue.get())
+            releaseWorkQueue();
+
         for (CameraVector::iterator it = mCamerasPendingRemoval.begin(); it != mCamerasPendingRemoval.end(); ++it)
             mRoot->removeChild(*it);
         mCamerasPendingRemoval.clear();
@@ -1,11 +1,14 @@
 #ifndef GAME_RENDER_GLOBALMAP_H
 #define GAME_RENDER_GLOBALMAP_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <osg/ref_ptr>
 
+#include <components/sceneutil/workqueue.hpp>
+
 namespace osg
 {
     class Texture2D;
@@ -30,7 +33,8 @@ namespace MWRender
     class GlobalMap
     {
     public:
-        GlobalMap(osg::Group* root);
+        /// @param cachePath Directory the base map is cached in, to skip creating it on the next start
+        GlobalMap(osg::Group* root, const std::string& cachePath);
         ~GlobalMap();
 
         void render(Loading::Listener* loadingListener);
@@ -44,7 +48,9 @@ namespace MWRender
 
         void cellTopLeftCornerToImageSpace(int x, int y, float& imageX, float& imageY);
 
-        void exploreCell (int cellX, int cellY, osg::ref_ptr<osg::Texture2D> localMapTexture);
+        /// @param left, bottom, right, top part of \a localMapTexture covered by the cell (origin at the bottom left)
+        void exploreCell (int cellX, int cellY, osg::ref_ptr<osg::Texture2D> localMapTexture,
+                          float left = 0.f, float bottom = 0.f, float right = 1.f, float top = 1.f);
 
         /// Clears the overlay
         void clear();
@@ -68,6 +74,14 @@ namespace MWRender
         osg::ref_ptr<osg::Texture2D> getOverlayTexture();
 
     private:
+        /// Identifies the content the base map is created from. Empty, if it can't be determined.
+        std::string getCacheKey();
+
+        osg::ref_ptr<osg::Image> readCache(const std::string& key);
+
+        /// Write the cache in the background.
+        void writeCache(const std::string& key, osg::ref_ptr<osg::Image> image);
+
         /**
          * Request rendering a 2d quad onto mOverlayTexture.
          * x, y, width and height are the destination coordinates.
@@ -78,6 +92,15 @@ namespace MWRender
 
         int mCellSize;
 
+        std::string mCachePath;
+
+        // only exists while the map is created and its cache is written, see releaseWorkQueue()
+        std::auto_ptr<SceneUtil::WorkQueue> mWorkQueue;
+        osg::ref_ptr<SceneUtil::WorkTicket> mWriteCacheTicket;
+
+        /// Stop the worker threads once the cache has been written.
+        void releaseWorkQueue();
+
         osg::ref_ptr<osg::Group> mRoot;
 
         typedef std::vector<osg::ref_ptr<osg::Camera> > CameraVector;
@@ -1,6 +1,7 @@
 #include "localmap.hpp"
 
 #include <iostream>
+#include <climits>
 #include <stdint.h>
 
 #include <osg/LightModel>
@@ -91,6 +92,8 @@ LocalMap::~LocalMap()
         mRoot->removeChild(*it);
     for (CameraVector::iterator it = mCamerasPendingRemoval.begin(); it != mCamerasPendingRemoval.end(); ++it)
         mRoot->removeChild(*it);
+    for (CameraVector::iterator it = mCameraPool.begin(); it != mCameraPool.end(); ++it)
+        mRoot->removeChild(*it);
 }
 
 const osg::Vec2f LocalMap::rotatePoint(const osg::Vec2f& point, const osg::Vec2f& center, const float angle)
@@ -108,14 +111,16 @@ void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
 {
     if (!mInterior)
     {
-        const MapSegment& segment = mSegments[std::make_pair(cell->getCell()->getGridX(), cell->getCell()->getGridY())];
+        MapSegment& segment = mSegments[std::make_pair(cell->getCell()->getGridX(), cell->getCell()->getGridY())];
 
-        if (segment.mFogOfWarImage && segment.mHasFogState)
+        // the fog state of the cell is still up to date, unless the segment has been explored further
+        if (segment.mFogOfWarImage && segment.mHasFogState && (segment.mChanged || !cell->getFog()))
         {
             std::auto_ptr<ESM::FogState> fog (new ESM::FogState());
             fog->mFogTextures.push_back(ESM::FogTexture());
 
             segment.saveFogOfWar(fog->mFogTextures.back());
+            segment.mChanged = false;
 
             cell->setFog(fog.release());
         }
@@ -129,6 +134,14 @@ void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
         const int segsX = static_cast<int>(std::ceil(length.x() / mMapWorldSize));
         const int segsY = static_cast<int>(std::ceil(length.y() / mMapWorldSize));
 
+        bool changed = !cell->getFog();
+        for (int x=0; x<segsX && !changed; ++x)
+            for (int y=0; y<segsY && !changed; ++y)
+                changed = mSegments[std::make_pair(x,y)].mChanged;
+
+        if (!changed)
+            return;
+
         std::auto_ptr<ESM::FogState> fog (new ESM::FogState());
 
         fog->mBounds.mMinX = mBounds.xMin();
@@ -143,13 +156,13 @@ void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
         {
             for (int y=0; y<segsY; ++y)
             {
-                const MapSegment& segment = mSegments[std::make_pair(x,y)];
+                MapSegment& segment = mSegments[std::make_pair(x,y)];
 
                 fog->mFogTextures.push_back(ESM::FogTexture());
 
                 // saving even if !segment.mHasFogState so we don't mess up the segmenting
-                // plus, older openmw versions can't deal with empty images
                 segment.saveFogOfWar(fog->mFogTextures.back());
+                segment.mChanged = false;
 
                 fog->mFogTextures.back().mX = x;
                 fog->mFogTextures.back().mY = y;
@@ -162,84 +175,122 @@ void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
 
 osg::ref_ptr<osg::Camera> LocalMap::createOrthographicCamera(float x, float y, float width, float height, const osg::Vec3d& upVector, float zmin, float zmax)
 {
-    osg::ref_ptr<osg::Camera> camera (new osg::Camera);
+    osg::ref_ptr<osg::Camera> camera;
+
+    if (!mCameraPool.empty())
+    {
+        camera = mCameraPool.back();
+        mCameraPool.pop_back();
+    }
+    else
+    {
+        camera = new osg::Camera;
+
+        camera->setComputeNearFarMode(osg::Camera::DO_NOT_COMPUTE_NEAR_FAR);
+        camera->setReferenceFrame(osg::Camera::ABSOLUTE_RF);
+        camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT, osg::Camera::PIXEL_BUFFER_RTT);
+        camera->setClearColor(osg::Vec4(0.f, 0.f, 0.f, 1.f));
+        camera->setClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        camera->setRenderOrder(osg::Camera::PRE_RENDER);
+
+        camera->setCullMask(Mask_Scene|Mask_Water|Mask_Terrain|Mask_MergedStatics);
+
+        osg::ref_ptr<osg::StateSet> stateset = new osg::StateSet;
+        stateset->setMode(GL_LIGHTING, osg::StateAttribute::ON);
+        stateset->setMode(GL_NORMALIZE, osg::StateAttribute::ON);
+        stateset->setMode(GL_CULL_FACE, osg::StateAttribute::ON);
+        stateset->setMode(GL_FOG, osg::StateAttribute::OFF|osg::StateAttribute::OVERRIDE);
+
+        osg::ref_ptr<osg::LightModel> lightmodel = new osg::LightModel;
+        lightmodel->setAmbientIntensity(osg::Vec4(0.3f, 0.3f, 0.3f, 1.f));
+        stateset->setAttributeAndModes(lightmodel, osg::StateAttribute::ON|osg::StateAttribute::OVERRIDE);
+
+        osg::ref_ptr<osg::Light> light = new osg::Light;
+        light->setPosition(osg::Vec4(-0.3f, -0.3f, 0.7f, 0.f));
+        light->setDiffuse(osg::Vec4(0.7f, 0.7f, 0.7f, 1.f));
+        light->setAmbient(osg::Vec4(0,0,0,1));
+        light->setSpecular(osg::Vec4(0,0,0,0));
+        light->setLightNum(0);
+        light->setConstantAttenuation(1.f);
+        light->setLinearAttenuation(0.f);
+        light->setQuadraticAttenuation(0.f);
+
+        osg::ref_ptr<osg::LightSource> lightSource = new osg::LightSource;
+        lightSource->setLight(light);
+
+        lightSource->setStateSetModes(*stateset, osg::StateAttribute::ON|osg::StateAttribute::OVERRIDE);
+
+        camera->addChild(lightSource);
+        camera->setStateSet(stateset);
+        camera->setGraphicsContext(mViewer->getCamera()->getGraphicsContext());
+
+        mRoot->addChild(camera);
+    }
 
     camera->setProjectionMatrixAsOrtho(-width/2, width/2, -height/2, height/2, 5, (zmax-zmin) + 10);
-    camera->setComputeNearFarMode(osg::Camera::DO_NOT_COMPUTE_NEAR_FAR);
     camera->setViewMatrixAsLookAt(osg::Vec3d(x, y, zmax + 5), osg::Vec3d(x, y, zmin), upVector);
-    camera->setReferenceFrame(osg::Camera::ABSOLUTE_RF);
-    camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT, osg::Camera::PIXEL_BUFFER_RTT);
-    camera->setClearColor(osg::Vec4(0.f, 0.f, 0.f, 1.f));
-    camera->setClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    camera->setRenderOrder(osg::Camera::PRE_RENDER);
-
-    camera->setCullMask(Mask_Scene|Mask_Water|Mask_Terrain);
     camera->setNodeMask(Mask_RenderToTexture);
-
-    osg::ref_ptr<osg::StateSet> stateset = new osg::StateSet;
-    stateset->setMode(GL_LIGHTING, osg::StateAttribute::ON);
-    stateset->setMode(GL_NORMALIZE, osg::StateAttribute::ON);
-    stateset->setMode(GL_CULL_FACE, osg::StateAttribute::ON);
-    stateset->setMode(GL_FOG, osg::StateAttribute::OFF|osg::StateAttribute::OVERRIDE);
-
-    osg::ref_ptr<osg::LightModel> lightmodel = new osg::LightModel;
-    lightmodel->setAmbientIntensity(osg::Vec4(0.3f, 0.3f, 0.3f, 1.f));
-    stateset->setAttributeAndModes(lightmodel, osg::StateAttribute::ON|osg::StateAttribute::OVERRIDE);
-
-    osg::ref_ptr<osg::Light> light = new osg::Light;
-    light->setPosition(osg::Vec4(-0.3f, -0.3f, 0.7f, 0.f));
-    light->setDiffuse(osg::Vec4(0.7f, 0.7f, 0.7f, 1.f));
-    light->setAmbient(osg::Vec4(0,0,0,1));
-    light->setSpecular(osg::Vec4(0,0,0,0));
-    light->setLightNum(0);
-    light->setConstantAttenuation(1.f);
-    light->setLinearAttenuation(0.f);
-    light->setQuadraticAttenuation(0.f);
-
-    osg::ref_ptr<osg::LightSource> lightSource = new osg::LightSource;
-    lightSource->setLight(light);
-
-    lightSource->setStateSetModes(*stateset, osg::StateAttribute::ON|osg::StateAttribute::OVERRIDE);
-
-    camera->addChild(lightSource);
-    camera->setStateSet(stateset);
-    camera->setGraphicsContext(mViewer->getCamera()->getGraphicsContext());
-    camera->setViewport(0, 0, mMapResolution, mMapResolution);
     camera->setUpdateCallback(new CameraUpdateCallback(camera, this));
 
     return camera;
 }
 
-void LocalMap::setupRenderToTexture(osg::ref_ptr<osg::Camera> camera, int x, int y)
+void LocalMap::setupRenderToTexture(osg::ref_ptr<osg::Camera> camera, int firstX, int firstY, int columns, int rows, const SegmentVector& segments)
 {
     osg::ref_ptr<osg::Texture2D> texture (new osg::Texture2D);
-    texture->setTextureSize(mMapResolution, mMapResolution);
+    texture->setTextureSize(columns*mMapResolution, rows*mMapResolution);
     texture->setInternalFormat(GL_RGB);
     texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
     texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
     texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
     texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
 
+    camera->setViewport(0, 0, columns*mMapResolution, rows*mMapResolution);
     camera->attach(osg::Camera::COLOR_BUFFER, texture);
 
     camera->addChild(mSceneRoot);
-    mRoot->addChild(camera);
     mActiveCameras.push_back(camera);
 
-    MapSegment& segment = mSegments[std::make_pair(x, y)];
-    segment.mMapTexture = texture;
+    for (SegmentVector::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        MapSegment& segment = mSegments[*it];
+        segment.mMapTexture = texture;
+
+        int column = it->first - firstX;
+        int row = it->second - firstY;
+        segment.mMapTextureCoords = osg::Vec4f(float(column)/columns, float(row)/rows,
+                                               float(column+1)/columns, float(row+1)/rows);
+    }
+}
+
+int LocalMap::getMaxBatchSize() const
+{
+    return std::max(1, sMaxBatchResolution / mMapResolution);
+}
+
+void LocalMap::requestSegments(int firstX, int firstY, int columns, int rows, const SegmentVector& segments,
+                               const osg::Vec2f& center, const osg::Vec3d& upVector, float zmin, float zmax)
+{
+    osg::ref_ptr<osg::Camera> camera = createOrthographicCamera(center.x(), center.y(), columns*mMapWorldSize, rows*mMapWorldSize,
+                                                                upVector, zmin, zmax);
+    setupRenderToTexture(camera, firstX, firstY, columns, rows, segments);
 }
 
 void LocalMap::requestMap(std::set<MWWorld::CellStore*> cells)
 {
+    std::vector<MWWorld::CellStore*> exteriors;
+
     for (std::set<MWWorld::CellStore*>::iterator it = cells.begin(); it != cells.end(); ++it)
     {
         MWWorld::CellStore* cell = *it;
         if (cell->isExterior())
-            requestExteriorMap(cell);
+            exteriors.push_back(cell);
         else
             requestInteriorMap(cell);
     }
+
+    if (!exteriors.empty())
+        requestExteriorMap(exteriors);
 }
 
 void LocalMap::removeCell(MWWorld::CellStore *cell)
@@ -261,6 +312,20 @@ osg::ref_ptr<osg::Texture2D> LocalMap::getMapTexture(int x, int y)
         return found->second.mMapTexture;
 }
 
+void LocalMap::getMapTextureCoords(int x, int y, float& left, float& bottom, float& right, float& top)
+{
+    osg::Vec4f coords (0.f, 0.f, 1.f, 1.f);
+
+    SegmentMap::iterator found = mSegments.find(std::make_pair(x, y));
+    if (found != mSegments.end() && found->second.mMapTexture)
+        coords = found->second.mMapTextureCoords;
+
+    left = coords.x();
+    bottom = coords.y();
+    right = coords.z();
+    top = coords.w();
+}
+
 osg::ref_ptr<osg::Texture2D> LocalMap::getFogOfWarTexture(int x, int y)
 {
     SegmentMap::iterator found = mSegments.find(std::make_pair(x, y));
@@ -289,43 +354,79 @@ void LocalMap::cleanupCameras()
 
     for (CameraVector::iterator it = mCamerasPendingRemoval.begin(); it != mCamerasPendingRemoval.end(); ++it)
     {
-        (*it)->removeChildren(0, (*it)->getNumChildren());
-        (*it)->setGraphicsContext(NULL);
-        mRoot->removeChild(*it);
+        // keep the camera (and its state) around for the next request
+        osg::Camera* camera = *it;
+        camera->setNodeMask(0);
+        camera->setUpdateCallback(NULL);
+        camera->removeChild(mSceneRoot);
+        camera->detach(osg::Camera::COLOR_BUFFER);
+        // the render stage has been set up for the old texture
+        camera->setRenderingCache(NULL);
+        mCameraPool.push_back(camera);
     }
 
     mCamerasPendingRemoval.clear();
 }
 
-void LocalMap::requestExteriorMap(MWWorld::CellStore* cell)
+void LocalMap::requestExteriorMap(const std::vector<MWWorld::CellStore*>& cells)
 {
     mInterior = false;
 
-    int x = cell->getCell()->getGridX();
-    int y = cell->getCell()->getGridY();
-
     osg::BoundingSphere bound = mViewer->getSceneData()->getBound();
     float zmin = bound.center().z() - bound.radius();
     float zmax = bound.center().z() + bound.radius();
 
-    osg::ref_ptr<osg::Camera> camera = createOrthographicCamera(x*mMapWorldSize + mMapWorldSize/2.f, y*mMapWorldSize + mMapWorldSize/2.f, mMapWorldSize, mMapWorldSize,
-                                                                osg::Vec3d(0,1,0), zmin, zmax);
-    setupRenderToTexture(camera, cell->getCell()->getGridX(), cell->getCell()->getGridY());
+    SegmentVector segments;
+    int minX = INT_MAX, minY = INT_MAX, maxX = INT_MIN, maxY = INT_MIN;
 
-    MapSegment& segment = mSegments[std::make_pair(cell->getCell()->getGridX(), cell->getCell()->getGridY())];
-    if (!segment.mFogOfWarImage)
+    for (std::vector<MWWorld::CellStore*>::const_iterator it = cells.begin(); it != cells.end(); ++it)
     {
-        if (cell->getFog())
-            segment.loadFogOfWar(cell->getFog()->mFogTextures.back());
-        else
-            segment.initFogOfWar();
+        MWWorld::CellStore* cell = *it;
+
+        int x = cell->getCell()->getGridX();
+        int y = cell->getCell()->getGridY();
+
+        segments.push_back(std::make_pair(x, y));
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+
+        MapSegment& segment = mSegments[std::make_pair(x, y)];
+        if (!segment.mFogOfWarImage)
+        {
+            if (cell->getFog())
+                segment.loadFogOfWar(cell->getFog()->mFogTextures.back());
+            else
+                segment.initFogOfWar();
+        }
+    }
+
+    int columns = maxX-minX+1;
+    int rows = maxY-minY+1;
+
+    // Render all cells in one pass, unless that would render too many cells that were not requested.
+    // The usual requests (the whole grid, or a new row or column of it) pass this test.
+    if (columns <= getMaxBatchSize() && rows <= getMaxBatchSize() && 2*segments.size() >= std::size_t(columns*rows))
+    {
+        requestSegments(minX, minY, columns, rows, segments,
+                        osg::Vec2f((minX + columns/2.f) * mMapWorldSize, (minY + rows/2.f) * mMapWorldSize),
+                        osg::Vec3d(0,1,0), zmin, zmax);
+        return;
+    }
+
+    for (SegmentVector::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        requestSegments(it->first, it->second, 1, 1, SegmentVector(1, *it),
+                        osg::Vec2f(it->first*mMapWorldSize + mMapWorldSize/2.f, it->second*mMapWorldSize + mMapWorldSize/2.f),
+                        osg::Vec3d(0,1,0), zmin, zmax);
     }
 }
 
 void LocalMap::requestInteriorMap(MWWorld::CellStore* cell)
 {
     osg::ComputeBoundsVisitor computeBoundsVisitor;
-    computeBoundsVisitor.setTraversalMask(Mask_Scene|Mask_Terrain);
+    computeBoundsVisitor.setTraversalMask(Mask_Scene|Mask_Terrain|Mask_MergedStatics);
     mSceneRoot->accept(computeBoundsVisitor);
 
     osg::BoundingBox bounds = computeBoundsVisitor.getBoundingBox();
@@ -412,26 +513,40 @@ void LocalMap::requestInteriorMap(MWWorld::CellStore* cell)
     const int segsX = static_cast<int>(std::ceil(length.x() / mMapWorldSize));
     const int segsY = static_cast<int>(std::ceil(length.y() / mMapWorldSize));
 
-    int i = 0;
-    for (int x=0; x<segsX; ++x)
+    // render blocks of segments in one pass each
+    const int maxBatchSize = getMaxBatchSize();
+    osg::Quat cameraOrient (mAngle, osg::Vec3d(0,0,-1));
+
+    for (int firstX=0; firstX<segsX; firstX+=maxBatchSize)
     {
-        for (int y=0; y<segsY; ++y)
+        for (int firstY=0; firstY<segsY; firstY+=maxBatchSize)
         {
-            osg::Vec2f start = min + osg::Vec2f(mMapWorldSize*x, mMapWorldSize*y);
-            osg::Vec2f newcenter = start + osg::Vec2f(mMapWorldSize/2.f, mMapWorldSize/2.f);
+            int columns = std::min(maxBatchSize, segsX-firstX);
+            int rows = std::min(maxBatchSize, segsY-firstY);
+
+            SegmentVector segments;
+            for (int x=firstX; x<firstX+columns; ++x)
+                for (int y=firstY; y<firstY+rows; ++y)
+                    segments.push_back(std::make_pair(x, y));
+
+            osg::Vec2f start = min + osg::Vec2f(mMapWorldSize*firstX, mMapWorldSize*firstY);
+            osg::Vec2f newcenter = start + osg::Vec2f(mMapWorldSize*columns/2.f, mMapWorldSize*rows/2.f);
 
-            osg::Quat cameraOrient (mAngle, osg::Vec3d(0,0,-1));
             osg::Vec2f a = newcenter - center;
             osg::Vec3f rotatedCenter = cameraOrient * (osg::Vec3f(a.x(), a.y(), 0));
 
             osg::Vec2f pos = osg::Vec2f(rotatedCenter.x(), rotatedCenter.y()) + center;
 
-            osg::ref_ptr<osg::Camera> camera = createOrthographicCamera(pos.x(), pos.y(),
-                                                                        mMapWorldSize, mMapWorldSize,
-                                                                        osg::Vec3f(north.x(), north.y(), 0.f), zMin, zMax);
-
-            setupRenderToTexture(camera, x, y);
+            requestSegments(firstX, firstY, columns, rows, segments, pos,
+                            osg::Vec3f(north.x(), north.y(), 0.f), zMin, zMax);
+        }
+    }
 
+    int i = 0;
+    for (int x=0; x<segsX; ++x)
+    {
+        for (int y=0; y<segsY; ++y)
+        {
             MapSegment& segment = mSegments[std::make_pair(x,y)];
             if (!segment.mFogOfWarImage)
             {
@@ -491,8 +606,8 @@ bool LocalMap::isPositionExplored (float nX, float nY, int x, int y, bool interi
     int texU = static_cast<int>((sFogOfWarResolution - 1) * nX);
     int texV = static_cast<int>((sFogOfWarResolution - 1) * nY);
 
-    uint32_t clr = ((const uint32_t*)segment.mFogOfWarImage->data())[texV * sFogOfWarResolution + texU];
-    uint8_t alpha = (clr >> 24);
+    uint8_t alpha = segment.mFogOfWarImage->data()[texV * sFogOfWarResolution + texU];
+    // a multiple of 8, so the saved fog (see ESM::FogTexture::quantize) gives the same answer
     return alpha < 200;
 }
 
@@ -558,6 +673,8 @@ void LocalMap::updatePlayer (const osg::Vec3f& position, const osg::Quat& orient
             if (!segment.mFogOfWarImage || !segment.mMapTexture)
                 continue;
 
+            bool changed = false;
+
             unsigned char* data = segment.mFogOfWarImage->data();
             for (int texV = 0; texV<sFogOfWarResolution; ++texV)
             {
@@ -566,24 +683,32 @@ void LocalMap::updatePlayer (const osg::Vec3f& position, const osg::Quat& orient
                     float sqrDist = square((texU + mx*(sFogOfWarResolution-1)) - u*(sFogOfWarResolution-1))
                             + square((texV + my*(sFogOfWarResolution-1)) - v*(sFogOfWarResolution-1));
 
-                    uint32_t clr = *(uint32_t*)data;
-                    uint8_t alpha = (clr >> 24);
+                    uint8_t alpha = std::min( *data, (uint8_t) (std::max(0.f, std::min(1.f, (sqrDist/sqrExploreRadius)))*255) );
 
-                    alpha = std::min( alpha, (uint8_t) (std::max(0.f, std::min(1.f, (sqrDist/sqrExploreRadius)))*255) );
-                    *(uint32_t*)data = (uint32_t) (alpha << 24);
+                    if (alpha != *data)
+                    {
+                        *data = alpha;
+                        changed = true;
+                    }
 
-                    data += 4;
+                    ++data;
                 }
             }
 
             segment.mHasFogState = true;
-            segment.mFogOfWarImage->dirty();
+
+            if (changed)
+            {
+                segment.mChanged = true;
+                segment.mFogOfWarImage->dirty();
+            }
         }
     }
 }
 
 LocalMap::MapSegment::MapSegment()
     : mHasFogState(false)
+    , mChanged(false)
 {
 }
 
@@ -604,19 +729,23 @@ void LocalMap::MapSegment::createFogOfWarTexture()
     mFogOfWarTexture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
     mFogOfWarTexture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
     mFogOfWarTexture->setUnRefImageDataAfterApply(false);
+    // The image only holds the alpha channel. Uploading it to an RGBA texture keeps the colour black.
+    mFogOfWarTexture->setInternalFormat(GL_RGBA);
 }
 
-void LocalMap::MapSegment::initFogOfWar()
+void LocalMap::MapSegment::createFogOfWarImage()
 {
     mFogOfWarImage = new osg::Image;
     // Assign a PixelBufferObject for asynchronous transfer of data to the GPU
     mFogOfWarImage->setPixelBufferObject(new osg::PixelBufferObject);
-    mFogOfWarImage->allocateImage(sFogOfWarResolution, sFogOfWarResolution, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+    mFogOfWarImage->allocateImage(sFogOfWarResolution, sFogOfWarResolution, 1, GL_ALPHA, GL_UNSIGNED_BYTE);
     assert(mFogOfWarImage->isDataContiguous());
-    std::vector<uint32_t> data;
-    data.resize(sFogOfWarResolution*sFogOfWarResolution, 0xff000000);
+}
 
-    memcpy(mFogOfWarImage->data(), &data[0], data.size()*4);
+void LocalMap::MapSegment::initFogOfWar()
+{
+    createFogOfWarImage();
+    memset(mFogOfWarImage->data(), 0xff, mFogOfWarImage->getTotalSizeInBytes());
 
     createFogOfWarTexture();
     mFogOfWarTexture->setImage(mFogOfWarImage);
@@ -624,6 +753,23 @@ void LocalMap::MapSegment::initFogOfWar()
 
 void LocalMap::MapSegment::loadFogOfWar(const ESM::FogTexture &esm)
 {
+    if (!esm.mMask.empty())
+    {
+        createFogOfWarImage();
+
+        if (!esm.getMask(mFogOfWarImage->data(), mFogOfWarImage->getTotalSizeInBytes()))
+        {
+            std::cerr << "Failed to read fog: invalid mask" << std::endl;
+            initFogOfWar();
+            return;
+        }
+
+        createFogOfWarTexture();
+        mFogOfWarTexture->setImage(mFogOfWarImage);
+        mHasFogState = true;
+        return;
+    }
+
     const std::vector<char>& data = esm.mImageData;
     if (!data.size())
     {
@@ -631,7 +777,7 @@ void LocalMap::MapSegment::loadFogOfWar(const ESM::FogTexture &esm)
         return;
     }
 
-    // TODO: deprecate tga and use raw data instead
+    // TGA images are only found in saved games of older versions
 
     osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("tga");
     if (!readerwriter)
@@ -649,13 +795,29 @@ void LocalMap::MapSegment::loadFogOfWar(const ESM::FogTexture &esm)
         return;
     }
 
-    mFogOfWarImage = result.getImage();
-    mFogOfWarImage->flipVertical();
-    mFogOfWarImage->dirty();
+    osg::ref_ptr<osg::Image> image = result.getImage();
+    if (image->s() != sFogOfWarResolution || image->t() != sFogOfWarResolution
+            || osg::Image::computePixelSizeInBits(image->getPixelFormat(), image->getDataType()) != 32)
+    {
+        std::cerr << "Failed to read fog: unexpected image format" << std::endl;
+        initFogOfWar();
+        return;
+    }
+
+    image->flipVertical();
+
+    // keep the alpha channel only
+    createFogOfWarImage();
+    for (int v = 0; v<sFogOfWarResolution; ++v)
+        for (int u = 0; u<sFogOfWarResolution; ++u)
+            mFogOfWarImage->data()[v * sFogOfWarResolution + u] = image->data(u, v)[3];
 
     createFogOfWarTexture();
     mFogOfWarTexture->setImage(mFogOfWarImage);
     mHasFogState = true;
+
+    // convert to the current format on the next save
+    mChanged = true;
 }
 
 void LocalMap::MapSegment::saveFogOfWar(ESM::FogTexture &fog) const
@@ -663,27 +825,7 @@ void LocalMap::MapSegment::saveFogOfWar(ESM::FogTexture &fog) const
     if (!mFogOfWarImage)
         return;
 
-    std::ostringstream ostream;
-
-    osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("tga");
-    if (!readerwriter)
-    {
-        std::cerr << "Unable to write fog, can't find a tga ReaderWriter" << std::endl;
-        return;
-    }
-
-    // extra flips are unfortunate, but required for compatibility with older versions
-    mFogOfWarImage->flipVertical();
-    osgDB::ReaderWriter::WriteResult result = readerwriter->writeImage(*mFogOfWarImage, ostream);
-    if (!result.success())
-    {
-        std::cerr << "Unable to write fog: " << result.message() << " code " << result.status() << std::endl;
-        return;
-    }
-    mFogOfWarImage->flipVertical();
-
-    std::string data = ostream.str();
-    fog.mImageData = std::vector<char>(data.begin(), data.end());
+    fog.setMask(mFogOfWarImage->data(), mFogOfWarImage->getTotalSizeInBytes());
 }
 
 }
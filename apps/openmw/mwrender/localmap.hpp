@@ -7,6 +7,7 @@
 
 #include <osg/BoundingBox>
 #include <osg/Quat>
+#include <osg/Vec4f>
 #include <osg/ref_ptr>
 
 namespace MWWorld
@@ -51,6 +52,7 @@ namespace MWRender
 
         /**
          * Request a map render for the given cells. Render textures will be immediately created and can be retrieved with the getMapTexture function.
+         * @remarks Neighbouring segments are rendered in one pass, so several segments may share a map texture.
          */
         void requestMap (std::set<MWWorld::CellStore*> cells);
 
@@ -61,6 +63,11 @@ namespace MWRender
 
         osg::ref_ptr<osg::Texture2D> getMapTexture (int x, int y);
 
+        /**
+         * Get the part of the map texture covered by the given segment, in texture coordinates (origin at the bottom left).
+         */
+        void getMapTextureCoords (int x, int y, float& left, float& bottom, float& right, float& top);
+
         osg::ref_ptr<osg::Texture2D> getFogOfWarTexture (int x, int y);
 
         /**
@@ -115,6 +122,9 @@ namespace MWRender
 
         CameraVector mCamerasPendingRemoval;
 
+        // cameras that have finished rendering and can be used for the next request
+        CameraVector mCameraPool;
+
         struct MapSegment
         {
             MapSegment();
@@ -124,12 +134,15 @@ namespace MWRender
             void loadFogOfWar(const ESM::FogTexture& fog);
             void saveFogOfWar(ESM::FogTexture& fog) const;
             void createFogOfWarTexture();
+            void createFogOfWarImage();
 
             osg::ref_ptr<osg::Texture2D> mMapTexture;
+            osg::Vec4f mMapTextureCoords; // left, bottom, right, top
             osg::ref_ptr<osg::Texture2D> mFogOfWarTexture;
-            osg::ref_ptr<osg::Image> mFogOfWarImage;
+            osg::ref_ptr<osg::Image> mFogOfWarImage; // alpha only, 255 = unexplored
 
             bool mHasFogState;
+            bool mChanged; // explored further since the fog state of the cell has been updated
         };
 
         typedef std::map<std::pair<int, int>, MapSegment> SegmentMap;
@@ -140,17 +153,34 @@ namespace MWRender
         // the dynamic texture is a bottleneck, so don't set this too high
         static const int sFogOfWarResolution = 32;
 
+        // maximum width and height of a texture that several map segments are rendered to
+        static const int sMaxBatchResolution = 2048;
+
         // size of a map segment (for exteriors, 1 cell)
         float mMapWorldSize;
 
         float mAngle;
         const osg::Vec2f rotatePoint(const osg::Vec2f& point, const osg::Vec2f& center, const float angle);
 
-        void requestExteriorMap(MWWorld::CellStore* cell);
+        typedef std::vector<std::pair<int, int> > SegmentVector;
+
+        void requestExteriorMap(const std::vector<MWWorld::CellStore*>& cells);
         void requestInteriorMap(MWWorld::CellStore* cell);
 
+        /// Number of segments that can be rendered in one pass, along each axis
+        int getMaxBatchSize() const;
+
+        /**
+         * Render a block of map segments in one pass.
+         * @param center world position of the center of the block
+         * @param segments segments of the block that will use the resulting texture
+         */
+        void requestSegments(int firstX, int firstY, int columns, int rows, const SegmentVector& segments,
+                             const osg::Vec2f& center, const osg::Vec3d& upVector, float zmin, float zmax);
+
+        /// Take a camera from the pool, or create a new one
         osg::ref_ptr<osg::Camera> createOrthographicCamera(float left, float top, float width, float height, const osg::Vec3d& upVector, float zmin, float zmax);
-        void setupRenderToTexture(osg::ref_ptr<osg::Camera> camera, int x, int y);
+        void setupRenderToTexture(osg::ref_ptr<osg::Camera> camera, int firstX, int firstY, int columns, int rows, const SegmentVector& segments);
 
         bool mInterior;
         osg::BoundingBox mBounds;
@@ -0,0 +1,440 @@
+#include "mergestatics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <typeinfo>
+
+#include <osg/Group>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Billboard>
+#include <osg/LOD>
+#include <osg/Switch>
+#include <osg/Camera>
+#include <osg/TriangleIndexFunctor>
+
+#include <components/sceneutil/lightmanager.hpp>
+
+#include "vismask.hpp"
+
+namespace
+{
+
+    /// Size of the areas a cell is split into, so that the merged geometry can still be culled and lit by area
+    const float sChunkSize = 2048.f;
+
+    typedef std::vector<const osg::StateSet*> StateSetList;
+
+    struct CollectedGeometry
+    {
+        osg::ref_ptr<const osg::Geometry> mGeometry;
+        osg::Matrix mMatrix;
+        StateSetList mStateSets; // from the root of the scene down to the geometry
+    };
+
+    bool isTransparent(const osg::StateSet* stateset)
+    {
+        return stateset->getRenderingHint() == osg::StateSet::TRANSPARENT_BIN
+                || (stateset->getMode(GL_BLEND) & osg::StateAttribute::ON);
+    }
+
+    bool hasVertexData(const osg::Array* array, unsigned int numVertices)
+    {
+        return !array || array->getNumElements() == numVertices;
+    }
+
+    bool canMerge(const osg::Geometry& geometry)
+    {
+        // RigGeometry, MorphGeometry etc. do their own thing
+        if (typeid(geometry) != typeid(osg::Geometry))
+            return false;
+
+        const osg::Vec3Array* vertices = dynamic_cast<const osg::Vec3Array*>(geometry.getVertexArray());
+        if (!vertices || geometry.getSecondaryColorArray() || geometry.getFogCoordArray() || geometry.getNumVertexAttribArrays())
+            return false;
+
+        unsigned int numVertices = vertices->size();
+
+        if (geometry.getNormalArray() && !dynamic_cast<const osg::Vec3Array*>(geometry.getNormalArray()))
+            return false;
+        if (geometry.getColorArray() && !dynamic_cast<const osg::Vec4Array*>(geometry.getColorArray()))
+            return false;
+        if (!hasVertexData(geometry.getNormalArray(), numVertices) || !hasVertexData(geometry.getColorArray(), numVertices))
+            return false;
+
+        for (unsigned int i=0; i<geometry.getNumTexCoordArrays(); ++i)
+        {
+            const osg::Array* texCoords = geometry.getTexCoordArray(i);
+            if (texCoords && (!dynamic_cast<const osg::Vec2Array*>(texCoords) || !hasVertexData(texCoords, numVertices)))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Collects the geometry of a scene along with its transformation and state, or fails if the scene
+    /// has anything that depends on being drawn on its own (billboards, switches, cull callbacks, transparency).
+    class CollectGeometryVisitor : public osg::NodeVisitor
+    {
+    public:
+        CollectGeometryVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mFailed(false)
+        {
+        }
+
+        virtual void apply(osg::Node& node)
+        {
+            if (!enter(node))
+                return;
+            traverse(node);
+            leave(node);
+        }
+
+        virtual void apply(osg::Transform& transform)
+        {
+            if (!enter(transform))
+                return;
+
+            if (transform.getReferenceFrame() != osg::Transform::RELATIVE_RF)
+                mFailed = true;
+            else
+            {
+                osg::Matrix matrix = mMatrix;
+                transform.computeLocalToWorldMatrix(mMatrix, this);
+                traverse(transform);
+                mMatrix = matrix;
+            }
+
+            leave(transform);
+        }
+
+        virtual void apply(osg::Geode& geode)
+        {
+            if (!enter(geode))
+                return;
+
+            for (unsigned int i=0; i<geode.getNumDrawables() && !mFailed; ++i)
+            {
+                const osg::Geometry* geometry = geode.getDrawable(i)->asGeometry();
+                if (!geometry || !canMerge(*geometry)
+                        || (geometry->getStateSet() && isTransparent(geometry->getStateSet())))
+                {
+                    mFailed = true;
+                    break;
+                }
+
+                CollectedGeometry collected;
+                collected.mGeometry = geometry;
+                collected.mMatrix = mMatrix;
+                collected.mStateSets = mStateSets;
+                if (geometry->getStateSet())
+                    collected.mStateSets.push_back(geometry->getStateSet());
+                mGeometries.push_back(collected);
+            }
+
+            leave(geode);
+        }
+
+        virtual void apply(osg::Billboard&) { mFailed = true; }
+        virtual void apply(osg::Switch&) { mFailed = true; }
+        virtual void apply(osg::LOD&) { mFailed = true; }
+        virtual void apply(osg::Camera&) { mFailed = true; }
+
+        bool mFailed;
+        std::vector<CollectedGeometry> mGeometries;
+
+    private:
+        osg::Matrix mMatrix;
+        StateSetList mStateSets;
+
+        bool enter(osg::Node& node)
+        {
+            if (mFailed)
+                return false;
+
+            // hidden nodes, e.g. collision shapes
+            if ((node.getNodeMask() & ~MWRender::Mask_UpdateVisitor) == 0)
+                return false;
+
+            if (node.getNodeMask() != ~0u || node.getCullCallback()
+                    || (node.getStateSet() && isTransparent(node.getStateSet())))
+            {
+                mFailed = true;
+                return false;
+            }
+
+            if (node.getStateSet())
+                mStateSets.push_back(node.getStateSet());
+            return true;
+        }
+
+        void leave(osg::Node& node)
+        {
+            if (node.getStateSet())
+                mStateSets.pop_back();
+        }
+    };
+
+    struct BatchKey
+    {
+        int mChunkX;
+        int mChunkY;
+        StateSetList mStateSets;
+        bool mNormals;
+        bool mColors;
+        unsigned int mTexCoords; // bit mask of the texture units with coordinates
+
+        bool operator< (const BatchKey& other) const
+        {
+            if (mChunkX != other.mChunkX)
+                return mChunkX < other.mChunkX;
+            if (mChunkY != other.mChunkY)
+                return mChunkY < other.mChunkY;
+            if (mStateSets != other.mStateSets)
+                return mStateSets < other.mStateSets;
+            if (mNormals != other.mNormals)
+                return mNormals < other.mNormals;
+            if (mColors != other.mColors)
+                return mColors < other.mColors;
+            return mTexCoords < other.mTexCoords;
+        }
+    };
+
+    struct Batch
+    {
+        osg::ref_ptr<osg::Geometry> mGeometry;
+        osg::ref_ptr<osg::Vec3Array> mVertices;
+        osg::ref_ptr<osg::Vec3Array> mNormals;
+        osg::ref_ptr<osg::Vec4Array> mColors;
+        std::vector<osg::ref_ptr<osg::Vec2Array> > mTexCoords; // by texture unit
+        osg::ref_ptr<osg::DrawElementsUInt> mIndices;
+
+        void init(const BatchKey& key)
+        {
+            mGeometry = new osg::Geometry;
+            // the index buffer is changed when objects are removed from the batch
+            mGeometry->setUseDisplayList(false);
+            mGeometry->setUseVertexBufferObjects(true);
+
+            mVertices = new osg::Vec3Array;
+            mGeometry->setVertexArray(mVertices);
+            if (key.mNormals)
+            {
+                mNormals = new osg::Vec3Array;
+                mGeometry->setNormalArray(mNormals);
+            }
+            if (key.mColors)
+            {
+                mColors = new osg::Vec4Array;
+                mGeometry->setColorArray(mColors);
+            }
+            for (unsigned int unit=0; (key.mTexCoords >> unit) != 0; ++unit)
+            {
+                mTexCoords.push_back(osg::ref_ptr<osg::Vec2Array>());
+                if (key.mTexCoords & (1u << unit))
+                {
+                    mTexCoords.back() = new osg::Vec2Array;
+                    mGeometry->setTexCoordArray(unit, mTexCoords.back());
+                }
+            }
+
+            mIndices = new osg::DrawElementsUInt(GL_TRIANGLES);
+            mGeometry->addPrimitiveSet(mIndices);
+        }
+    };
+
+    struct CollectTriangles
+    {
+        osg::DrawElementsUInt* mIndices;
+        unsigned int mOffset;
+
+        void operator() (unsigned int i1, unsigned int i2, unsigned int i3)
+        {
+            mIndices->push_back(mOffset + i1);
+            mIndices->push_back(mOffset + i2);
+            mIndices->push_back(mOffset + i3);
+        }
+    };
+
+    BatchKey getBatchKey(const CollectedGeometry& collected, const osg::Matrix& transform)
+    {
+        BatchKey key;
+        key.mChunkX = static_cast<int>(std::floor(transform.getTrans().x() / sChunkSize));
+        key.mChunkY = static_cast<int>(std::floor(transform.getTrans().y() / sChunkSize));
+        key.mStateSets = collected.mStateSets;
+        key.mNormals = collected.mGeometry->getNormalArray() != NULL;
+        key.mColors = collected.mGeometry->getColorArray() != NULL;
+        key.mTexCoords = 0;
+        for (unsigned int i=0; i<collected.mGeometry->getNumTexCoordArrays(); ++i)
+            if (collected.mGeometry->getTexCoordArray(i))
+                key.mTexCoords |= (1u << i);
+        return key;
+    }
+
+    void append(Batch& batch, const CollectedGeometry& collected, const osg::Matrix& transform)
+    {
+        const osg::Geometry& geometry = *collected.mGeometry;
+        osg::Matrix matrix = collected.mMatrix * transform;
+        // transform3x3 with the inverse, instead of the other way round, applies the inverse transpose
+        osg::Matrix normalMatrix = osg::Matrix::inverse(matrix);
+
+        unsigned int offset = batch.mVertices->size();
+
+        const osg::Vec3Array* vertices = static_cast<const osg::Vec3Array*>(geometry.getVertexArray());
+        for (osg::Vec3Array::const_iterator it = vertices->begin(); it != vertices->end(); ++it)
+            batch.mVertices->push_back(*it * matrix);
+
+        if (batch.mNormals)
+        {
+            const osg::Vec3Array* normals = static_cast<const osg::Vec3Array*>(geometry.getNormalArray());
+            for (osg::Vec3Array::const_iterator it = normals->begin(); it != normals->end(); ++it)
+            {
+                osg::Vec3f normal = osg::Matrix::transform3x3(normalMatrix, *it);
+                normal.normalize();
+                batch.mNormals->push_back(normal);
+            }
+        }
+
+        if (batch.mColors)
+        {
+            const osg::Vec4Array* colors = static_cast<const osg::Vec4Array*>(geometry.getColorArray());
+            batch.mColors->insert(batch.mColors->end(), colors->begin(), colors->end());
+        }
+
+        for (unsigned int unit=0; unit<batch.mTexCoords.size(); ++unit)
+        {
+            if (!batch.mTexCoords[unit])
+                continue;
+            const osg::Vec2Array* texCoords = static_cast<const osg::Vec2Array*>(geometry.getTexCoordArray(unit));
+            batch.mTexCoords[unit]->insert(batch.mTexCoords[unit]->end(), texCoords->begin(), texCoords->end());
+        }
+
+        osg::TriangleIndexFunctor<CollectTriangles> functor;
+        functor.mIndices = batch.mIndices.get();
+        functor.mOffset = offset;
+        geometry.accept(functor);
+    }
+
+}
+
+namespace MWRender
+{
+
+    MergeStaticsWorkItem::MergeStaticsWorkItem(MergeResult* result, bool lightList)
+        : mResult(result)
+        , mLightList(lightList)
+    {
+    }
+
+    void MergeStaticsWorkItem::addInput(osg::Node *node, const osg::Matrix &transform)
+    {
+        Input input;
+        input.mNode = node;
+        input.mTransform = transform;
+        mInputs.push_back(input);
+    }
+
+    void MergeStaticsWorkItem::doWork()
+    {
+        // an exception must not keep the ticket from being signalled, or end the worker thread
+        try
+        {
+            merge();
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Failed to merge static objects: " << e.what() << std::endl;
+            leaveUnmerged();
+        }
+        catch (...)
+        {
+            std::cerr << "Failed to merge static objects: unknown error" << std::endl;
+            leaveUnmerged();
+        }
+
+        mTicket->signalDone();
+    }
+
+    void MergeStaticsWorkItem::leaveUnmerged()
+    {
+        mResult->mRanges.clear();
+        mResult->mRanges.resize(mInputs.size());
+        mResult->mMerged.assign(mInputs.size(), false);
+        mResult->mNode = new osg::Group;
+    }
+
+    void MergeStaticsWorkItem::merge()
+    {
+        typedef std::map<BatchKey, Batch> BatchMap;
+        BatchMap batches;
+
+        mResult->mRanges.resize(mInputs.size());
+        mResult->mMerged.resize(mInputs.size(), false);
+
+        for (unsigned int i=0; i<mInputs.size(); ++i)
+        {
+            // the shared scene is not modified by anyone, so it is safe to read it here
+            CollectGeometryVisitor visitor;
+            mInputs[i].mNode->accept(visitor);
+            if (visitor.mFailed)
+                continue;
+
+            for (std::vector<CollectedGeometry>::const_iterator it = visitor.mGeometries.begin(); it != visitor.mGeometries.end(); ++it)
+            {
+                BatchKey key = getBatchKey(*it, mInputs[i].mTransform);
+                Batch& batch = batches[key];
+                if (!batch.mGeometry)
+                    batch.init(key);
+
+                MergedRange range;
+                range.mIndices = batch.mIndices;
+                range.mFirst = batch.mIndices->size();
+                append(batch, *it, mInputs[i].mTransform);
+                range.mCount = batch.mIndices->size() - range.mFirst;
+
+                if (range.mCount)
+                    mResult->mRanges[i].push_back(range);
+            }
+
+            mResult->mMerged[i] = true;
+        }
+
+        mResult->mNode = new osg::Group;
+
+        std::map<std::pair<int, int>, osg::ref_ptr<osg::Geode> > geodes;
+        std::map<StateSetList, osg::ref_ptr<osg::StateSet> > stateSets;
+
+        for (BatchMap::iterator it = batches.begin(); it != batches.end(); ++it)
+        {
+            if (it->second.mIndices->empty())
+                continue;
+
+            osg::ref_ptr<osg::Geode>& geode = geodes[std::make_pair(it->first.mChunkX, it->first.mChunkY)];
+            if (!geode)
+            {
+                geode = new osg::Geode;
+                if (mLightList)
+                    geode->addCullCallback(new SceneUtil::LightListCallback);
+                mResult->mNode->addChild(geode);
+            }
+
+            if (!it->first.mStateSets.empty())
+            {
+                osg::ref_ptr<osg::StateSet>& stateSet = stateSets[it->first.mStateSets];
+                if (!stateSet)
+                {
+                    stateSet = new osg::StateSet;
+                    for (StateSetList::const_iterator state = it->first.mStateSets.begin(); state != it->first.mStateSets.end(); ++state)
+                        stateSet->merge(**state);
+                }
+                it->second.mGeometry->setStateSet(stateSet);
+            }
+
+            geode->addDrawable(it->second.mGeometry);
+        }
+    }
+
+}
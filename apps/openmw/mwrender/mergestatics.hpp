@@ -0,0 +1,74 @@
+#ifndef GAME_RENDER_MERGESTATICS_H
+#define GAME_RENDER_MERGESTATICS_H
+
+#include <vector>
+
+#include <osg/ref_ptr>
+#include <osg/Referenced>
+#include <osg/Matrix>
+#include <osg/PrimitiveSet>
+
+#include <components/sceneutil/workqueue.hpp>
+
+namespace osg
+{
+    class Group;
+    class Node;
+}
+
+namespace MWRender
+{
+
+    /// Triangles of an object in one of the merged geometries
+    struct MergedRange
+    {
+        osg::ref_ptr<osg::DrawElementsUInt> mIndices;
+        unsigned int mFirst;
+        unsigned int mCount;
+    };
+
+    class MergeResult : public osg::Referenced
+    {
+    public:
+        osg::ref_ptr<osg::Group> mNode;
+
+        // by index of the input
+        std::vector<std::vector<MergedRange> > mRanges;
+        std::vector<bool> mMerged;
+    };
+
+    /// @brief Transforms the geometry of static scenes into combined vertex buffers
+    ///
+    /// There is one geometry per StateSet and area. Scenes with anything that depends on being drawn on its own
+    /// (billboards, switches, cull callbacks, transparency) are left out.
+    class MergeStaticsWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        /// @param lightList Add light lists to the merged geometry, one per area.
+        MergeStaticsWorkItem(MergeResult* result, bool lightList);
+
+        /// @param node Scene instance that is not modified by anyone, see Resource::SceneManager::getSharedInstance
+        void addInput(osg::Node* node, const osg::Matrix& transform);
+
+        virtual void doWork();
+
+    private:
+        void merge();
+
+        /// Give a result that leaves all inputs to be drawn on their own.
+        void leaveUnmerged();
+
+        struct Input
+        {
+            osg::ref_ptr<osg::Node> mNode;
+            osg::Matrix mTransform;
+        };
+
+        std::vector<Input> mInputs;
+        osg::ref_ptr<MergeResult> mResult;
+        bool mLightList;
+    };
+
+}
+
+#endif
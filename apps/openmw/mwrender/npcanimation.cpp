@@ -30,6 +30,7 @@
 
 #include "camera.hpp"
 #include "rotatecontroller.hpp"
+#include "partloader.hpp"
 
 namespace
 {
@@ -263,6 +264,9 @@ const NpcAnimation::PartBoneMap NpcAnimation::sPartList = createPartListMap();
 
 NpcAnimation::~NpcAnimation()
 {
+    if (mPartLoader)
+        mPartLoader->removeWaiting(this);
+
     if (!mListenerDisabled
             // No need to getInventoryStore() to reset, if none exists
             // This is to avoid triggering the listener via ensureCustomData()->autoEquip()->fireEquipmentChanged()
@@ -271,9 +275,11 @@ NpcAnimation::~NpcAnimation()
         mPtr.getClass().getInventoryStore(mPtr).setListener(NULL, mPtr);
 }
 
-NpcAnimation::NpcAnimation(const MWWorld::Ptr& ptr, osg::ref_ptr<osg::Group> parentNode, Resource::ResourceSystem* resourceSystem, bool disableListener, bool disableSounds, ViewMode viewMode)
+NpcAnimation::NpcAnimation(const MWWorld::Ptr& ptr, osg::ref_ptr<osg::Group> parentNode, Resource::ResourceSystem* resourceSystem, bool disableListener, bool disableSounds, ViewMode viewMode, PartLoader* partLoader)
   : Animation(ptr, parentNode, resourceSystem),
     mListenerDisabled(disableListener),
+    mPartLoader(partLoader),
+    mHiddenUntilPrepared(false),
     mViewMode(viewMode),
     mShowWeapons(false),
     mShowCarriedLeft(true),
@@ -412,6 +418,15 @@ void NpcAnimation::updateNpcBase()
 
     for(size_t i = 0;i < ESM::PRT_Count;i++)
         removeIndividualPart((ESM::PartReferenceType)i);
+
+    // the new object root has no body parts yet, hide it until the first batch is attached,
+    // rather than showing the weapon and shield floating on their own
+    if (mPartLoader && mObjectRoot)
+    {
+        mObjectRoot->setNodeMask(0);
+        mHiddenUntilPrepared = true;
+    }
+
     updateParts();
 
     mWeaponAnimationTime->updateStartTime();
@@ -518,7 +533,10 @@ void NpcAnimation::updateParts()
             addOrReplaceIndividualPart(ESM::PRT_Hair, -1,1, mHairModel);
     }
     if(mViewMode == VM_HeadOnly)
+    {
+        prepareParts();
         return;
+    }
 
     if(mPartPriorities[ESM::PRT_Shield] < 1)
     {
@@ -659,6 +677,8 @@ void NpcAnimation::updateParts()
 
     if (wasArrowAttached)
         attachArrow();
+
+    prepareParts();
 }
 
 PartHolderPtr NpcAnimation::insertBoundedPart(const std::string& model, const std::string& bonename, const std::string& bonefilter, bool enchantedGlow, osg::Vec4f* glowColor)
@@ -694,6 +714,11 @@ void NpcAnimation::removeIndividualPart(ESM::PartReferenceType type)
     mPartPriorities[type] = 0;
     mPartslots[type] = -1;
 
+    mPreparedParts[type] = NULL;
+
+    // rather than leaving a gap, keep showing the old part until its replacement is attached
+    if (mPartLoader && mObjectParts[type] && type != ESM::PRT_Weapon && type != ESM::PRT_Shield)
+        mRetiredParts.push_back(mObjectParts[type]);
     mObjectParts[type].reset();
     if (!mSoundIds[type].empty() && !mSoundsDisabled)
     {
@@ -734,7 +759,21 @@ bool NpcAnimation::addOrReplaceIndividualPart(ESM::PartReferenceType type, int g
         const std::string& bonename = sPartList.at(type);
         // PRT_Hair seems to be the only type that breaks consistency and uses a filter that's different from the attachment bone
         const std::string bonefilter = (type == ESM::PRT_Hair) ? "hair" : bonename;
-        mObjectParts[type] = insertBoundedPart(mesh, bonename, bonefilter, enchantedGlow, glowColor);
+
+        // weapons and shields are needed right away, for attaching arrows and lights
+        if (mPartLoader && type != ESM::PRT_Weapon && type != ESM::PRT_Shield)
+        {
+            osg::ref_ptr<PreparedPart> part = new PreparedPart;
+            part->mMesh = mesh;
+            part->mTemplate = mResourceSystem->getSceneManager()->getTemplate(mesh);
+            part->mFilter = bonefilter;
+            part->mEnchantedGlow = enchantedGlow;
+            if (enchantedGlow)
+                part->mGlowColor = *glowColor;
+            mPreparedParts[type] = part;
+        }
+        else
+            mObjectParts[type] = insertBoundedPart(mesh, bonename, bonefilter, enchantedGlow, glowColor);
     }
     catch (std::exception& e)
     {
@@ -757,6 +796,14 @@ bool NpcAnimation::addOrReplaceIndividualPart(ESM::PartReferenceType type, int g
         }
     }
 
+    if (mObjectParts[type])
+        assignPartControllers(type);
+
+    return true;
+}
+
+void NpcAnimation::assignPartControllers(ESM::PartReferenceType type)
+{
     boost::shared_ptr<SceneUtil::ControllerSource> src;
     if (type == ESM::PRT_Head)
     {
@@ -794,8 +841,107 @@ bool NpcAnimation::addOrReplaceIndividualPart(ESM::PartReferenceType type, int g
 
     SceneUtil::AssignControllerSourcesVisitor assignVisitor(src);
     mObjectParts[type]->getNode()->accept(assignVisitor);
+}
 
-    return true;
+void NpcAnimation::prepareParts()
+{
+    if (!mPartLoader)
+        return;
+
+    std::vector<osg::ref_ptr<PreparedPart> > parts;
+    bool pending = false;
+    for (int i=0; i<ESM::PRT_Count; ++i)
+    {
+        if (!mPreparedParts[i])
+            continue;
+        pending = true;
+        if (!mPreparedParts[i]->mTicket)
+            parts.push_back(mPreparedParts[i]);
+    }
+
+    if (!pending)
+    {
+        mRetiredParts.clear();
+        showPreparedParts();
+    }
+
+    if (parts.empty())
+        return;
+
+    mPartLoader->prepare(parts);
+    mPartLoader->addWaiting(this);
+}
+
+bool NpcAnimation::attachPreparedParts()
+{
+    bool pending = false;
+    for (int i=0; i<ESM::PRT_Count; ++i)
+    {
+        osg::ref_ptr<PreparedPart> part = mPreparedParts[i];
+        if (!part || !part->mTicket)
+            continue;
+        if (!part->mTicket->isDone())
+        {
+            pending = true;
+            continue;
+        }
+
+        ESM::PartReferenceType type = static_cast<ESM::PartReferenceType>(i);
+        mPreparedParts[i] = NULL;
+
+        try
+        {
+            if (!part->mError.empty())
+            {
+                // fall back to instancing the part right here
+                std::cerr << "Failed to prepare NPC part '" << part->mMesh << "': " << part->mError << std::endl;
+                mObjectParts[type] = insertBoundedPart(part->mMesh, sPartList.at(type), part->mFilter,
+                                                       part->mEnchantedGlow, &part->mGlowColor);
+            }
+            else
+            {
+                osg::ref_ptr<osg::Node> attached;
+                if (part->mRig)
+                {
+                    mObjectRoot->asGroup()->addChild(part->mRig);
+                    attached = part->mRig;
+                }
+                else
+                    attached = SceneUtil::attach(part->mInstance, mObjectRoot, part->mFilter, sPartList.at(type));
+
+                mResourceSystem->getSceneManager()->notifyAttached(attached);
+                if (part->mEnchantedGlow)
+                    addGlow(attached, part->mGlowColor);
+
+                mObjectParts[type] = PartHolderPtr(new PartHolder(attached));
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Error adding NPC part: " << e.what() << std::endl;
+            continue;
+        }
+
+        assignPartControllers(type);
+    }
+
+    if (!pending)
+    {
+        mRetiredParts.clear();
+        showPreparedParts();
+    }
+
+    return pending;
+}
+
+void NpcAnimation::showPreparedParts()
+{
+    if (!mHiddenUntilPrepared)
+        return;
+
+    mHiddenUntilPrepared = false;
+    if (mObjectRoot)
+        mObjectRoot->setNodeMask(~0u);
 }
 
 void NpcAnimation::addPartGroup(int group, int priority, const std::vector<ESM::PartReference> &parts, bool enchantedGlow, osg::Vec4f* glowColor)
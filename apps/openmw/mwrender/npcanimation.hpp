@@ -17,6 +17,8 @@ namespace MWRender
 
 class NeckController;
 class HeadAnimationTime;
+class PartLoader;
+class PreparedPart;
 
 class NpcAnimation : public Animation, public WeaponAnimation, public MWWorld::InventoryStoreListener
 {
@@ -42,6 +44,11 @@ private:
     PartHolderPtr mObjectParts[ESM::PRT_Count];
     std::string mSoundIds[ESM::PRT_Count];
 
+    PartLoader* mPartLoader; // NULL if parts are instanced right away
+    osg::ref_ptr<PreparedPart> mPreparedParts[ESM::PRT_Count];
+    std::vector<PartHolderPtr> mRetiredParts; // replaced parts, shown until the prepared parts are attached
+    bool mHiddenUntilPrepared; // the object root is hidden until the first prepared parts are attached
+
     const ESM::NPC *mNpc;
     std::string    mHeadModel;
     std::string    mHairModel;
@@ -78,6 +85,12 @@ private:
 
     bool addOrReplaceIndividualPart(ESM::PartReferenceType type, int group, int priority, const std::string &mesh,
                                     bool enchantedGlow=false, osg::Vec4f* glowColor=NULL);
+    void assignPartControllers(ESM::PartReferenceType type);
+
+    /// Start instancing the parts added since the last call on the worker thread of the PartLoader.
+    void prepareParts();
+    /// Show the object root again once nothing is left to prepare, after updateNpcBase hid it.
+    void showPreparedParts();
     void removePartGroup(int group);
     void addPartGroup(int group, int priority, const std::vector<ESM::PartReference> &parts,
                                     bool enchantedGlow=false, osg::Vec4f* glowColor=NULL);
@@ -96,9 +109,11 @@ public:
      *                         Those need to be manually rendered anyway.
      * @param disableSounds    Same as \a disableListener but for playing items sounds
      * @param viewMode
+     * @param partLoader       Instance body parts on a worker thread, so they are attached a few frames later.
+     *                         Weapons and shields are always attached right away.
      */
     NpcAnimation(const MWWorld::Ptr& ptr, osg::ref_ptr<osg::Group> parentNode, Resource::ResourceSystem* resourceSystem, bool disableListener = false,
-                 bool disableSounds = false, ViewMode viewMode=VM_Normal);
+                 bool disableSounds = false, ViewMode viewMode=VM_Normal, PartLoader* partLoader=NULL);
     virtual ~NpcAnimation();
 
     virtual void enableHeadAnimation(bool enable);
@@ -128,6 +143,10 @@ public:
 
     void updateParts();
 
+    /// Attach the parts the PartLoader is done with.
+    /// @return Are parts still being prepared?
+    bool attachPreparedParts();
+
     /// Rebuilds the NPC, updating their root model, animation sources, and equipment.
     void rebuild();
 
@@ -0,0 +1,472 @@
+#include "objectpaging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <osg/Group>
+#include <osg/Timer>
+
+#include <components/esm/loadcell.hpp>
+#include <components/esm/loadstat.hpp>
+
+#include <components/misc/stringops.hpp>
+
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
+
+#include "../mwbase/environment.hpp"
+#include "../mwbase/world.hpp"
+
+#include "../mwworld/esmstore.hpp"
+
+#include "mergestatics.hpp"
+#include "vismask.hpp"
+#include "util.hpp"
+
+namespace
+{
+
+    // milliseconds per frame spent on fetching the models of distant cells
+    const double sTimeBudget = 2.0;
+
+    const int sCellSize = 8192;
+
+    bool isMarker(const std::string& id)
+    {
+        return id == "prisonmarker" || id == "divinemarker" || id == "templemarker" || id == "northmarker";
+    }
+
+    template <typename T>
+    void write(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void read(std::istream& stream, T& value)
+    {
+        stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (stream.fail())
+            throw std::runtime_error("unexpected end of file");
+    }
+
+}
+
+namespace MWRender
+{
+
+    ObjectPaging::ObjectPaging(osg::Group *parent, Resource::ResourceSystem *resourceSystem, int distance, float minRadius,
+                               const std::string& cachePath)
+        : mCacheLoaded(false)
+        , mCacheChanged(false)
+        , mParent(parent)
+        , mResourceSystem(resourceSystem)
+        , mDistance(distance)
+        , mMinRadius(minRadius)
+        , mCachePath(cachePath)
+        , mWorkQueue(1)
+    {
+        mRootNode = new osg::Group;
+        mRootNode->setName("Distant Statics");
+        mRootNode->setNodeMask(0);
+        mParent->addChild(mRootNode);
+    }
+
+    ObjectPaging::~ObjectPaging()
+    {
+        while (!mCells.empty())
+            removeCell(mCells.begin());
+
+        mParent->removeChild(mRootNode);
+
+        if (mCacheChanged)
+            writeCache();
+    }
+
+    void ObjectPaging::setCellActive(int x, int y, bool active)
+    {
+        CellIndex index(x, y);
+        if (!active)
+        {
+            mActiveCells.erase(index);
+            return;
+        }
+
+        mActiveCells.insert(index);
+
+        CellMap::iterator found = mCells.find(index);
+        if (found != mCells.end())
+            removeCell(found);
+    }
+
+    void ObjectPaging::update(const osg::Vec3f &cameraPos)
+    {
+        // no exterior cells loaded, i.e. the player is in an interior
+        if (mActiveCells.empty())
+        {
+            mRootNode->setNodeMask(0);
+            return;
+        }
+        mRootNode->setNodeMask(Mask_DistantStatics);
+
+        if (!mCacheLoaded)
+        {
+            // the content files can't be inspected anymore on destruction, so the key is kept
+            mCacheKey = getCacheKey();
+            readCache();
+            mCacheLoaded = true;
+        }
+
+        int cameraX = static_cast<int>(std::floor(cameraPos.x() / sCellSize));
+        int cameraY = static_cast<int>(std::floor(cameraPos.y() / sCellSize));
+
+        for (CellMap::iterator it = mCells.begin(); it != mCells.end();)
+        {
+            if (std::abs(it->first.first - cameraX) > mDistance || std::abs(it->first.second - cameraY) > mDistance)
+                removeCell(it++);
+            else
+                ++it;
+        }
+
+        osg::Timer timer;
+        bool readAllowed = true;
+
+        // nearest cells first
+        for (int ring=0; ring<=mDistance; ++ring)
+        {
+            for (int x=cameraX-ring; x<=cameraX+ring; ++x)
+            {
+                for (int y=cameraY-ring; y<=cameraY+ring; ++y)
+                {
+                    if (std::max(std::abs(x-cameraX), std::abs(y-cameraY)) != ring)
+                        continue;
+
+                    CellIndex index(x, y);
+                    if (mActiveCells.find(index) != mActiveCells.end())
+                        continue;
+
+                    DistantCell*& cell = mCells[index];
+                    if (!cell)
+                    {
+                        cell = new DistantCell;
+                        cell->mItem = NULL;
+                        cell->mNextObject = 0;
+                        cell->mAttached = false;
+                    }
+
+                    if (!cell->mAttached && prepareCell(index, *cell, timer, readAllowed))
+                    {
+                        mRootNode->addChild(cell->mResult->mNode);
+                        cell->mAttached = true;
+                    }
+                }
+            }
+        }
+    }
+
+    void ObjectPaging::removeCell(CellMap::iterator cell)
+    {
+        DistantCell* distantCell = cell->second;
+        if (distantCell->mAttached)
+            mRootNode->removeChild(distantCell->mResult->mNode);
+
+        // a merge that is still running keeps its result alive through the work item
+        delete distantCell->mItem;
+        delete distantCell;
+        mCells.erase(cell);
+    }
+
+    bool ObjectPaging::prepareCell(const CellIndex &index, DistantCell &cell, const osg::Timer& timer, bool& readAllowed)
+    {
+        if (cell.mTicket)
+            return cell.mTicket->isDone();
+
+        std::map<CellIndex, ObjectList>::iterator objects = mObjectLists.find(index);
+        if (objects == mObjectLists.end())
+        {
+            // reading the references is comparatively slow, so it is spread over multiple frames
+            if (!readAllowed)
+                return false;
+            readAllowed = false;
+
+            objects = mObjectLists.insert(std::make_pair(index, ObjectList())).first;
+            readCell(index, objects->second);
+            mCacheChanged = true;
+        }
+
+        if (!cell.mItem)
+        {
+            cell.mResult = new MergeResult;
+            // distant objects are lit by the sun only
+            cell.mItem = new MergeStaticsWorkItem(cell.mResult, false);
+            cell.mNextObject = 0;
+        }
+
+        Resource::SceneManager* sceneManager = mResourceSystem->getSceneManager();
+
+        const ObjectList& list = objects->second;
+        for (; cell.mNextObject < list.size(); ++cell.mNextObject)
+        {
+            if (timer.time_m() > sTimeBudget)
+                return false;
+
+            const DistantObject& object = list[cell.mNextObject];
+
+            osg::ref_ptr<osg::Node> node;
+            try
+            {
+                node = sceneManager->getSharedInstance(mModels[object.mModel]);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "Can't load distant object " << mModels[object.mModel] << ": " << e.what() << std::endl;
+            }
+
+            if (!node || node->getBound().radius() * object.mScale < mMinRadius)
+                continue;
+
+            osg::Quat rotation = osg::Quat(object.mRot[2], osg::Vec3f(0,0,-1))
+                    * osg::Quat(object.mRot[1], osg::Vec3f(0,-1,0))
+                    * osg::Quat(object.mRot[0], osg::Vec3f(-1,0,0));
+
+            osg::Matrix transform = osg::Matrix::scale(osg::Vec3f(object.mScale, object.mScale, object.mScale))
+                    * osg::Matrix::rotate(rotation)
+                    * osg::Matrix::translate(osg::Vec3f(object.mPos[0], object.mPos[1], object.mPos[2]));
+
+            cell.mItem->addInput(node, transform);
+        }
+
+        cell.mTicket = mWorkQueue.addWorkItem(cell.mItem);
+        cell.mItem = NULL;
+        return false;
+    }
+
+    void ObjectPaging::readCell(const CellIndex &index, ObjectList &objects)
+    {
+        const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
+
+        const ESM::Cell* cell = store.get<ESM::Cell>().search(index.first, index.second);
+        if (!cell)
+            return;
+
+        std::vector<ESM::ESMReader>& esm = MWBase::Environment::get().getWorld()->getEsmReader();
+
+        // references modified by a later content file replace the earlier ones
+        std::map<ESM::RefNum, ESM::CellRef> refs;
+        std::vector<ESM::CellRef> cellRefs;
+
+        try
+        {
+            for (size_t i = 0; i < cell->mContextList.size(); i++)
+            {
+                int reader = cell->mContextList[i].index;
+                cell->restore (esm[reader], i);
+
+                ESM::CellRef ref;
+                ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
+
+                bool deleted = false;
+                while (cell->getNextRef(esm[reader], ref, deleted))
+                {
+                    if (std::find(cell->mMovedRefs.begin(), cell->mMovedRefs.end(), ref.mRefNum) != cell->mMovedRefs.end())
+                        continue;
+
+                    if (!ref.mRefNum.hasContentFile())
+                    {
+                        if (!deleted)
+                            cellRefs.push_back(ref);
+                    }
+                    else if (deleted)
+                        refs.erase(ref.mRefNum);
+                    else
+                        refs[ref.mRefNum] = ref;
+                }
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Can't read distant objects of cell " << index.first << ", " << index.second << ": " << e.what() << std::endl;
+            return;
+        }
+
+        for (std::map<ESM::RefNum, ESM::CellRef>::const_iterator it = refs.begin(); it != refs.end(); ++it)
+            cellRefs.push_back(it->second);
+        cellRefs.insert(cellRefs.end(), cell->mLeasedRefs.begin(), cell->mLeasedRefs.end());
+
+        for (std::vector<ESM::CellRef>::const_iterator it = cellRefs.begin(); it != cellRefs.end(); ++it)
+        {
+            const ESM::Static* stat = store.get<ESM::Static>().search(it->mRefID);
+            if (!stat || stat->mModel.empty() || isMarker(stat->mId))
+                continue;
+
+            std::string model = Misc::StringUtils::lowerCase("meshes\\" + stat->mModel);
+
+            std::map<std::string, unsigned int>::iterator found = mModelIndex.find(model);
+            if (found == mModelIndex.end())
+            {
+                found = mModelIndex.insert(std::make_pair(model, static_cast<unsigned int>(mModels.size()))).first;
+                mModels.push_back(model);
+            }
+
+            DistantObject object;
+            object.mModel = found->second;
+            for (int i=0; i<3; ++i)
+            {
+                object.mPos[i] = it->mPos.pos[i];
+                object.mRot[i] = it->mPos.rot[i];
+            }
+            object.mScale = it->mScale;
+            objects.push_back(object);
+        }
+    }
+
+    std::string ObjectPaging::getCacheKey()
+    {
+        if (mCachePath.empty())
+            return std::string();
+
+        std::ostringstream key;
+        key << "version 1\n";
+
+        try
+        {
+            key << getContentFilesKey();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Can't use distant statics cache: " << e.what() << std::endl;
+            return std::string();
+        }
+
+        return key.str();
+    }
+
+    void ObjectPaging::readCache()
+    {
+        if (mCacheKey.empty())
+            return;
+
+        boost::filesystem::path path (mCachePath);
+
+        boost::filesystem::ifstream keyStream(path / "distantstatics.key", std::ios::binary);
+        if (!keyStream.is_open())
+            return;
+
+        std::ostringstream cachedKey;
+        cachedKey << keyStream.rdbuf();
+
+        if (cachedKey.str() != mCacheKey)
+            return;
+
+        boost::filesystem::ifstream stream(path / "distantstatics.bin", std::ios::binary);
+        if (!stream.is_open())
+            return;
+
+        std::vector<std::string> models;
+        std::map<CellIndex, ObjectList> objectLists;
+
+        try
+        {
+            unsigned int numModels;
+            read(stream, numModels);
+            for (unsigned int i=0; i<numModels; ++i)
+            {
+                unsigned int length;
+                read(stream, length);
+                std::string model(length, '\0');
+                if (length > 0)
+                    stream.read(&model[0], length);
+                if (stream.fail())
+                    throw std::runtime_error("unexpected end of file");
+                models.push_back(model);
+            }
+
+            unsigned int numCells;
+            read(stream, numCells);
+            for (unsigned int i=0; i<numCells; ++i)
+            {
+                CellIndex index;
+                read(stream, index.first);
+                read(stream, index.second);
+
+                unsigned int numObjects;
+                read(stream, numObjects);
+
+                ObjectList& objects = objectLists[index];
+                for (unsigned int j=0; j<numObjects; ++j)
+                {
+                    DistantObject object;
+                    read(stream, object);
+                    if (object.mModel >= models.size())
+                        throw std::runtime_error("invalid model index");
+                    objects.push_back(object);
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Can't read distant statics cache: " << e.what() << std::endl;
+            return;
+        }
+
+        mModels.swap(models);
+        mObjectLists.swap(objectLists);
+
+        mModelIndex.clear();
+        for (unsigned int i=0; i<mModels.size(); ++i)
+            mModelIndex[mModels[i]] = i;
+    }
+
+    void ObjectPaging::writeCache()
+    {
+        if (mCacheKey.empty())
+            return;
+
+        try
+        {
+            boost::filesystem::path path (mCachePath);
+            boost::filesystem::create_directories(path);
+
+            // remove the key first, so an incomplete cache is never used
+            boost::filesystem::remove(path / "distantstatics.key");
+
+            boost::filesystem::ofstream stream(path / "distantstatics.bin", std::ios::binary);
+
+            write(stream, static_cast<unsigned int>(mModels.size()));
+            for (std::vector<std::string>::const_iterator it = mModels.begin(); it != mModels.end(); ++it)
+            {
+                write(stream, static_cast<unsigned int>(it->size()));
+                stream.write(it->data(), it->size());
+            }
+
+            write(stream, static_cast<unsigned int>(mObjectLists.size()));
+            for (std::map<CellIndex, ObjectList>::const_iterator it = mObjectLists.begin(); it != mObjectLists.end(); ++it)
+            {
+                write(stream, it->first.first);
+                write(stream, it->first.second);
+                write(stream, static_cast<unsigned int>(it->second.size()));
+                for (ObjectList::const_iterator object = it->second.begin(); object != it->second.end(); ++object)
+                    write(stream, *object);
+            }
+
+            stream.close();
+            if (stream.fail())
+                throw std::runtime_error("failed to write object lists");
+
+            boost::filesystem::ofstream keyStream(path / "distantstatics.key", std::ios::binary);
+            keyStream << mCacheKey;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Can't write distant statics cache: " << e.what() << std::endl;
+        }
+    }
+
+}
@@ -0,0 +1,111 @@
+#ifndef GAME_RENDER_OBJECTPAGING_H
+#define GAME_RENDER_OBJECTPAGING_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osg/ref_ptr>
+#include <osg/Vec3f>
+
+#include <components/sceneutil/workqueue.hpp>
+
+namespace osg
+{
+    class Group;
+    class Timer;
+}
+
+namespace Resource
+{
+    class ResourceSystem;
+}
+
+namespace MWRender
+{
+
+    class MergeResult;
+    class MergeStaticsWorkItem;
+
+    /// @brief Draws merged, simplified versions of the statics in exterior cells outside of the active grid
+    ///
+    /// The statics of a distant cell are read from the content files on the main thread, at most one cell per
+    /// frame, and the lists are cached on disk. Only objects of a minimum size are kept. Their geometry is merged on
+    /// a worker thread (see MergeStaticsWorkItem), without light lists, so they are only lit by the sun.
+    class ObjectPaging
+    {
+    public:
+        /// @param distance Number of cells around the camera to draw.
+        /// @param minRadius Objects with a smaller bounding radius are left out.
+        /// @param cachePath Directory for the object lists, empty for no cache.
+        ObjectPaging(osg::Group* parent, Resource::ResourceSystem* resourceSystem, int distance, float minRadius,
+                     const std::string& cachePath);
+        ~ObjectPaging();
+
+        /// The objects of the given exterior cell are drawn by Objects now, or not anymore.
+        void setCellActive(int x, int y, bool active);
+
+        void update(const osg::Vec3f& cameraPos);
+
+    private:
+        struct DistantObject
+        {
+            unsigned int mModel; // index into mModels
+            float mPos[3];
+            float mRot[3];
+            float mScale;
+        };
+
+        typedef std::vector<DistantObject> ObjectList;
+
+        typedef std::pair<int, int> CellIndex;
+
+        struct DistantCell
+        {
+            MergeStaticsWorkItem* mItem; // while objects are added, owned by this
+            unsigned int mNextObject;
+            osg::ref_ptr<MergeResult> mResult;
+            osg::ref_ptr<SceneUtil::WorkTicket> mTicket;
+            bool mAttached;
+        };
+
+        typedef std::map<CellIndex, DistantCell*> CellMap;
+        CellMap mCells;
+
+        std::set<CellIndex> mActiveCells;
+
+        std::map<CellIndex, ObjectList> mObjectLists;
+        std::vector<std::string> mModels;
+        std::map<std::string, unsigned int> mModelIndex;
+        std::string mCacheKey;
+        bool mCacheLoaded;
+        bool mCacheChanged;
+
+        osg::ref_ptr<osg::Group> mParent;
+        osg::ref_ptr<osg::Group> mRootNode;
+        Resource::ResourceSystem* mResourceSystem;
+        int mDistance;
+        float mMinRadius;
+        std::string mCachePath;
+
+        SceneUtil::WorkQueue mWorkQueue;
+
+        void removeCell(CellMap::iterator cell);
+
+        /// @return Can the cell be attached?
+        bool prepareCell(const CellIndex& index, DistantCell& cell, const osg::Timer& timer, bool& readAllowed);
+
+        void readCell(const CellIndex& index, ObjectList& objects);
+
+        std::string getCacheKey();
+        void readCache();
+        void writeCache();
+
+        void operator = (const ObjectPaging&);
+        ObjectPaging(const ObjectPaging&);
+    };
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "objects.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 #include <osg/Group>
@@ -10,15 +11,19 @@
 #include <osgParticle/ParticleSystem>
 #include <osgParticle/ParticleProcessor>
 
+#include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
 
 #include <components/sceneutil/visitor.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "../mwworld/ptr.hpp"
 #include "../mwworld/class.hpp"
 
 #include "animation.hpp"
+#include "cellbatch.hpp"
 #include "npcanimation.hpp"
+#include "partloader.hpp"
 #include "creatureanimation.hpp"
 #include "vismask.hpp"
 
@@ -76,14 +81,25 @@ namespace
 namespace MWRender
 {
 
-Objects::Objects(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Group> rootNode)
+Objects::Objects(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Group> rootNode, bool mergeStatics,
+                 bool threadedNpcParts, int prewarmNpcParts, float animationLodDistance, int maxAnimationUpdateInterval)
     : mRootNode(rootNode)
     , mResourceSystem(resourceSystem)
+    , mAnimationLodDistance(animationLodDistance)
+    , mMaxAnimationUpdateInterval(std::max(1, maxAnimationUpdateInterval))
 {
+    if (mergeStatics)
+        mWorkQueue.reset(new SceneUtil::WorkQueue);
+    if (threadedNpcParts)
+        mPartLoader.reset(new PartLoader(mResourceSystem, prewarmNpcParts));
 }
 
 Objects::~Objects()
 {
+    for (CellBatchMap::iterator iter = mCellBatches.begin(); iter != mCellBatches.end(); ++iter)
+        delete iter->second;
+    mCellBatches.clear();
+
     for(PtrAnimationMap::iterator iter = mObjects.begin();iter != mObjects.end();++iter)
         delete iter->second;
     mObjects.clear();
@@ -132,6 +148,32 @@ void Objects::insertModel(const MWWorld::Ptr &ptr, const std::string &mesh, bool
         visitor.remove();
     }
 
+    anim->setUpdateLod(mAnimationLodDistance, mMaxAnimationUpdateInterval);
+
+    mObjects.insert(std::make_pair(ptr, anim.release()));
+}
+
+void Objects::insertStatic(const MWWorld::Ptr &ptr, const std::string &mesh)
+{
+    osg::ref_ptr<osg::Node> shared = mResourceSystem->getSceneManager()->getSharedInstance(mesh);
+    if (!shared)
+    {
+        insertModel(ptr, mesh);
+        return;
+    }
+
+    insertBegin(ptr);
+
+    std::auto_ptr<ObjectAnimation> anim (new ObjectAnimation(ptr, shared, mResourceSystem));
+
+    if (mWorkQueue.get())
+    {
+        CellBatch*& batch = mCellBatches[ptr.getCell()];
+        if (!batch)
+            batch = new CellBatch(mCellSceneNodes[ptr.getCell()]);
+        batch->addObject(ptr, anim->getObjectRoot(), shared);
+    }
+
     mObjects.insert(std::make_pair(ptr, anim.release()));
 }
 
@@ -148,6 +190,8 @@ void Objects::insertCreature(const MWWorld::Ptr &ptr, const std::string &mesh, b
     else
         anim.reset(new CreatureAnimation(ptr, mesh, mResourceSystem));
 
+    anim->setUpdateLod(mAnimationLodDistance, mMaxAnimationUpdateInterval);
+
     mObjects.insert(std::make_pair(ptr, anim.release()));
 }
 
@@ -156,7 +200,10 @@ void Objects::insertNPC(const MWWorld::Ptr &ptr)
     insertBegin(ptr);
     ptr.getRefData().getBaseNode()->setNodeMask(Mask_Actor);
 
-    std::auto_ptr<NpcAnimation> anim (new NpcAnimation(ptr, osg::ref_ptr<osg::Group>(ptr.getRefData().getBaseNode()), mResourceSystem));
+    std::auto_ptr<NpcAnimation> anim (new NpcAnimation(ptr, osg::ref_ptr<osg::Group>(ptr.getRefData().getBaseNode()), mResourceSystem,
+                                                       false, false, NpcAnimation::VM_Normal, mPartLoader.get()));
+
+    anim->setUpdateLod(mAnimationLodDistance, mMaxAnimationUpdateInterval);
 
     mObjects.insert(std::make_pair(ptr, anim.release()));
 }
@@ -166,6 +213,10 @@ bool Objects::removeObject (const MWWorld::Ptr& ptr)
     if(!ptr.getRefData().getBaseNode())
         return true;
 
+    CellBatchMap::iterator batch = mCellBatches.find(ptr.getCell());
+    if (batch != mCellBatches.end())
+        batch->second->removeObject(ptr);
+
     PtrAnimationMap::iterator iter = mObjects.find(ptr);
     if(iter != mObjects.end())
     {
@@ -193,6 +244,13 @@ void Objects::removeCell(const MWWorld::CellStore* store)
             ++iter;
     }
 
+    CellBatchMap::iterator batch = mCellBatches.find(store);
+    if (batch != mCellBatches.end())
+    {
+        delete batch->second;
+        mCellBatches.erase(batch);
+    }
+
     CellMap::iterator cell = mCellSceneNodes.find(store);
     if(cell != mCellSceneNodes.end())
     {
@@ -207,6 +265,10 @@ void Objects::updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &cur)
     if (!objectNode)
         return;
 
+    CellBatchMap::iterator batch = mCellBatches.find(old.getCell());
+    if (batch != mCellBatches.end())
+        batch->second->removeObject(old);
+
     MWWorld::CellStore *newCell = cur.getCell();
 
     osg::Group* cellnode;
@@ -240,6 +302,29 @@ void Objects::updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &cur)
     }
 }
 
+void Objects::mergeCell(const MWWorld::CellStore *store)
+{
+    CellBatchMap::iterator batch = mCellBatches.find(store);
+    if (batch != mCellBatches.end())
+        batch->second->merge(mWorkQueue.get());
+}
+
+void Objects::moveObject(const MWWorld::Ptr &ptr)
+{
+    CellBatchMap::iterator batch = mCellBatches.find(ptr.getCell());
+    if (batch != mCellBatches.end())
+        batch->second->moveObject(ptr);
+}
+
+void Objects::update()
+{
+    for (CellBatchMap::iterator iter = mCellBatches.begin(); iter != mCellBatches.end(); ++iter)
+        iter->second->update();
+
+    if (mPartLoader.get())
+        mPartLoader->update();
+}
+
 Animation* Objects::getAnimation(const MWWorld::Ptr &ptr)
 {
     PtrAnimationMap::const_iterator iter = mObjects.find(ptr);
@@ -30,9 +30,16 @@ namespace MWWorld
     class CellStore;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWRender{
 
 class Animation;
+class CellBatch;
+class PartLoader;
 
 class PtrHolder : public osg::Object
 {
@@ -63,20 +70,40 @@ class Objects{
     CellMap mCellSceneNodes;
     PtrAnimationMap mObjects;
 
+    typedef std::map<const MWWorld::CellStore*, CellBatch*> CellBatchMap;
+    CellBatchMap mCellBatches;
+
     osg::ref_ptr<osg::Group> mRootNode;
 
     void insertBegin(const MWWorld::Ptr& ptr);
 
     Resource::ResourceSystem* mResourceSystem;
 
+    std::auto_ptr<SceneUtil::WorkQueue> mWorkQueue; // NULL if statics are not merged
+
+    std::auto_ptr<PartLoader> mPartLoader; // NULL if NPC parts are instanced on the main thread
+
+    float mAnimationLodDistance;
+    unsigned int mMaxAnimationUpdateInterval;
+
 public:
-    Objects(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Group> rootNode);
+    /// @param mergeStatics Draw the static objects of a cell as merged geometry, see CellBatch.
+    /// @param threadedNpcParts Instance the body parts of NPCs on a worker thread, see PartLoader.
+    /// @param prewarmNpcParts Number of body part models to load in advance, if \a threadedNpcParts is set.
+    /// @param animationLodDistance @see Animation::setUpdateLod
+    /// @param maxAnimationUpdateInterval @see Animation::setUpdateLod
+    Objects(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Group> rootNode, bool mergeStatics,
+            bool threadedNpcParts, int prewarmNpcParts, float animationLodDistance, int maxAnimationUpdateInterval);
     ~Objects();
 
     /// @param animated Attempt to load separate keyframes from a .kf file matching the model file?
     /// @param allowLight If false, no lights will be created, and particles systems will be removed.
     void insertModel(const MWWorld::Ptr& ptr, const std::string &model, bool animated=false, bool allowLight=true);
 
+    /// Insert a model that is never animated. If possible, its scene graph is shared with all other objects
+    /// using the same model, rather than copied for each object.
+    void insertStatic(const MWWorld::Ptr& ptr, const std::string &model);
+
     void insertNPC(const MWWorld::Ptr& ptr);
     void insertCreature (const MWWorld::Ptr& ptr, const std::string& model, bool weaponsShields);
 
@@ -87,6 +114,16 @@ public:
 
     void removeCell(const MWWorld::CellStore* store);
 
+    /// Start merging the statics of a cell, once all its objects have been inserted.
+    void mergeCell(const MWWorld::CellStore* store);
+
+    /// The transformation of the given object is about to change, so it has to be drawn on its own rather than
+    /// as part of a merged cell.
+    void moveObject(const MWWorld::Ptr& ptr);
+
+    /// Attach the merged geometry of cells that are done merging, and NPC parts that are done instancing.
+    void update();
+
     /// Updates containing cell for object rendering data
     void updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &cur);
 
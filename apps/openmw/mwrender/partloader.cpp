@@ -0,0 +1,231 @@
+#include "partloader.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#include <osg/Group>
+#include <osg/Timer>
+
+#include <components/esm/loadarmo.hpp>
+#include <components/esm/loadbody.hpp>
+#include <components/esm/loadclot.hpp>
+#include <components/esm/loadnpc.hpp>
+
+#include <components/misc/stringops.hpp>
+
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
+
+#include <components/sceneutil/attach.hpp>
+#include <components/sceneutil/clone.hpp>
+#include <components/sceneutil/skeleton.hpp>
+
+#include "../mwbase/environment.hpp"
+#include "../mwbase/world.hpp"
+
+#include "../mwworld/esmstore.hpp"
+
+#include "npcanimation.hpp"
+
+namespace
+{
+
+    // milliseconds per frame spent on loading templates in advance
+    const double sTimeBudget = 1.0;
+
+    class PreparePartsWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        PreparePartsWorkItem(const std::vector<osg::ref_ptr<MWRender::PreparedPart> >& parts)
+            : mParts(parts)
+        {
+        }
+
+        virtual void doWork()
+        {
+            for (std::vector<osg::ref_ptr<MWRender::PreparedPart> >::iterator it = mParts.begin(); it != mParts.end(); ++it)
+            {
+                MWRender::PreparedPart* part = *it;
+
+                // an exception must not keep the ticket from being signalled, or end the worker thread
+                try
+                {
+                    // the template is only read, so it can be cloned while the main thread uses it as well
+                    part->mInstance = osg::clone(part->mTemplate.get(), SceneUtil::CopyOp());
+
+                    if (dynamic_cast<SceneUtil::Skeleton*>(part->mInstance.get()))
+                        part->mRig = SceneUtil::extractRig(part->mInstance, part->mFilter);
+                }
+                catch (std::exception& e)
+                {
+                    part->mError = e.what();
+                }
+                catch (...)
+                {
+                    part->mError = "unknown error";
+                }
+
+                if (!part->mError.empty())
+                {
+                    part->mInstance = NULL;
+                    part->mRig = NULL;
+                }
+            }
+
+            mTicket->signalDone();
+        }
+
+    private:
+        std::vector<osg::ref_ptr<MWRender::PreparedPart> > mParts;
+    };
+
+    typedef std::map<std::string, int> ModelUsage;
+
+    void countBodyPart(ModelUsage& usage, const std::string& id, int count)
+    {
+        if (id.empty())
+            return;
+
+        const ESM::BodyPart* bodyPart = MWBase::Environment::get().getWorld()->getStore().get<ESM::BodyPart>().search(id);
+        if (bodyPart && !bodyPart->mModel.empty())
+            usage[Misc::StringUtils::lowerCase("meshes\\" + bodyPart->mModel)] += count;
+    }
+
+    void countParts(ModelUsage& usage, const std::vector<ESM::PartReference>& parts, bool female)
+    {
+        for (std::vector<ESM::PartReference>::const_iterator it = parts.begin(); it != parts.end(); ++it)
+            countBodyPart(usage, (female && !it->mFemale.empty()) ? it->mFemale : it->mMale, 1);
+    }
+
+    bool compareUsage(const std::pair<int, std::string>& left, const std::pair<int, std::string>& right)
+    {
+        return left.first > right.first;
+    }
+
+}
+
+namespace MWRender
+{
+
+    PartLoader::PartLoader(Resource::ResourceSystem *resourceSystem, int prewarmCount)
+        : mResourceSystem(resourceSystem)
+        , mPrewarmCount(prewarmCount)
+        , mPrewarmListed(false)
+        , mNextPrewarm(0)
+    {
+    }
+
+    PartLoader::~PartLoader()
+    {
+    }
+
+    void PartLoader::prepare(const std::vector<osg::ref_ptr<PreparedPart> > &parts)
+    {
+        osg::ref_ptr<SceneUtil::WorkTicket> ticket = mWorkQueue.addWorkItem(new PreparePartsWorkItem(parts));
+
+        for (std::vector<osg::ref_ptr<PreparedPart> >::const_iterator it = parts.begin(); it != parts.end(); ++it)
+            (*it)->mTicket = ticket;
+    }
+
+    void PartLoader::addWaiting(NpcAnimation *animation)
+    {
+        mWaiting.insert(animation);
+    }
+
+    void PartLoader::removeWaiting(NpcAnimation *animation)
+    {
+        mWaiting.erase(animation);
+    }
+
+    void PartLoader::update()
+    {
+        for (std::set<NpcAnimation*>::iterator it = mWaiting.begin(); it != mWaiting.end();)
+        {
+            if (!(*it)->attachPreparedParts())
+                mWaiting.erase(it++);
+            else
+                ++it;
+        }
+
+        if (!mPrewarmListed)
+        {
+            listPrewarmModels();
+            mPrewarmListed = true;
+        }
+
+        osg::Timer timer;
+        while (mNextPrewarm < mPrewarmModels.size() && timer.time_m() < sTimeBudget)
+        {
+            try
+            {
+                mResourceSystem->getSceneManager()->getTemplate(mPrewarmModels[mNextPrewarm]);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "Error loading body part: " << e.what() << std::endl;
+            }
+            ++mNextPrewarm;
+        }
+    }
+
+    void PartLoader::listPrewarmModels()
+    {
+        if (mPrewarmCount <= 0)
+            return;
+
+        const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
+
+        ModelUsage usage;
+
+        // race and gender, to count the skins
+        std::map<std::pair<std::string, bool>, int> races;
+
+        const MWWorld::Store<ESM::NPC>& npcs = store.get<ESM::NPC>();
+        for (MWWorld::Store<ESM::NPC>::iterator npc = npcs.begin(); npc != npcs.end(); ++npc)
+        {
+            bool female = !npc->isMale();
+            ++races[std::make_pair(Misc::StringUtils::lowerCase(npc->mRace), female)];
+
+            countBodyPart(usage, npc->mHead, 1);
+            countBodyPart(usage, npc->mHair, 1);
+
+            const std::vector<ESM::ContItem>& items = npc->mInventory.mList;
+            for (std::vector<ESM::ContItem>::const_iterator item = items.begin(); item != items.end(); ++item)
+            {
+                std::string id = item->mItem.toString();
+                if (const ESM::Armor* armor = store.get<ESM::Armor>().search(id))
+                    countParts(usage, armor->mParts.mParts, female);
+                else if (const ESM::Clothing* clothing = store.get<ESM::Clothing>().search(id))
+                    countParts(usage, clothing->mParts.mParts, female);
+            }
+        }
+
+        const MWWorld::Store<ESM::BodyPart>& bodyParts = store.get<ESM::BodyPart>();
+        for (MWWorld::Store<ESM::BodyPart>::iterator it = bodyParts.begin(); it != bodyParts.end(); ++it)
+        {
+            if (it->mData.mType != ESM::BodyPart::MT_Skin || (it->mData.mFlags & ESM::BodyPart::BPF_NotPlayable)
+                    || it->mData.mPart == ESM::BodyPart::MP_Head || it->mData.mPart == ESM::BodyPart::MP_Hair)
+                continue;
+
+            // first person parts are only used by the player
+            if (it->mId.size() >= 3 && it->mId.compare(it->mId.size()-3, 3, "1st") == 0)
+                continue;
+
+            bool female = (it->mData.mFlags & ESM::BodyPart::BPF_Female) != 0;
+            std::map<std::pair<std::string, bool>, int>::const_iterator race =
+                    races.find(std::make_pair(Misc::StringUtils::lowerCase(it->mRace), female));
+            if (race != races.end())
+                countBodyPart(usage, it->mId, race->second);
+        }
+
+        std::vector<std::pair<int, std::string> > sorted;
+        for (ModelUsage::const_iterator it = usage.begin(); it != usage.end(); ++it)
+            sorted.push_back(std::make_pair(it->second, it->first));
+        std::stable_sort(sorted.begin(), sorted.end(), compareUsage);
+
+        for (unsigned int i=0; i<sorted.size() && i<static_cast<unsigned int>(mPrewarmCount); ++i)
+            mPrewarmModels.push_back(sorted[i].second);
+    }
+
+}
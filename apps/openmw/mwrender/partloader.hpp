@@ -0,0 +1,90 @@
+#ifndef GAME_RENDER_PARTLOADER_H
+#define GAME_RENDER_PARTLOADER_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osg/ref_ptr>
+#include <osg/Referenced>
+#include <osg/Vec4f>
+
+#include <components/sceneutil/workqueue.hpp>
+
+namespace osg
+{
+    class Group;
+    class Node;
+}
+
+namespace Resource
+{
+    class ResourceSystem;
+}
+
+namespace MWRender
+{
+
+    class NpcAnimation;
+
+    /// A body part of an NPC that is instanced on a worker thread, see PartLoader
+    class PreparedPart : public osg::Referenced
+    {
+    public:
+        std::string mMesh;
+        osg::ref_ptr<const osg::Node> mTemplate;
+        std::string mFilter;
+
+        bool mEnchantedGlow;
+        osg::Vec4f mGlowColor;
+
+        // written by the worker thread
+        osg::ref_ptr<osg::Node> mInstance;
+        osg::ref_ptr<osg::Group> mRig; // the filtered skinned objects, NULL if the part is not skinned
+        std::string mError; // not empty if instancing failed, the part is then attached on the main thread instead
+
+        osg::ref_ptr<SceneUtil::WorkTicket> mTicket;
+    };
+
+    /// @brief Instances the body parts of NPCs on a worker thread
+    ///
+    /// Cloning the templates and extracting the skinned objects is done in the background, so the NpcAnimation only
+    /// has to attach the finished parts to its skeleton. The templates of the body parts used the most by the NPCs in
+    /// the content files are loaded in advance, a few per frame.
+    class PartLoader
+    {
+    public:
+        /// @param prewarmCount Number of body part models to load in advance.
+        PartLoader(Resource::ResourceSystem* resourceSystem, int prewarmCount);
+        ~PartLoader();
+
+        /// Instance the given parts on the worker thread. Sets their PreparedPart::mTicket.
+        void prepare(const std::vector<osg::ref_ptr<PreparedPart> >& parts);
+
+        /// Let \a animation attach its prepared parts once they are done, see NpcAnimation::attachPreparedParts.
+        void addWaiting(NpcAnimation* animation);
+        void removeWaiting(NpcAnimation* animation);
+
+        void update();
+
+    private:
+        Resource::ResourceSystem* mResourceSystem;
+
+        std::set<NpcAnimation*> mWaiting;
+
+        int mPrewarmCount;
+        bool mPrewarmListed;
+        std::vector<std::string> mPrewarmModels; // most used first
+        unsigned int mNextPrewarm;
+
+        SceneUtil::WorkQueue mWorkQueue;
+
+        void listPrewarmModels();
+
+        void operator = (const PartLoader&);
+        PartLoader(const PartLoader&);
+    };
+
+}
+
+#endif
@@ -39,6 +39,7 @@
 #include "camera.hpp"
 #include "water.hpp"
 #include "terrainstorage.hpp"
+#include "objectpaging.hpp"
 
 namespace MWRender
 {
@@ -122,7 +123,8 @@ namespace MWRender
         bool mWireframe;
     };
 
-    RenderingManager::RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode, Resource::ResourceSystem* resourceSystem, const MWWorld::Fallback* fallback)
+    RenderingManager::RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode, Resource::ResourceSystem* resourceSystem, const MWWorld::Fallback* fallback,
+                                       const std::string& cachePath)
         : mViewer(viewer)
         , mRootNode(rootNode)
         , mResourceSystem(resourceSystem)
@@ -137,7 +139,16 @@ namespace MWRender
 
         mPathgrid.reset(new Pathgrid(mRootNode));
 
-        mObjects.reset(new Objects(mResourceSystem, lightRoot));
+        mObjects.reset(new Objects(mResourceSystem, lightRoot, Settings::Manager::getBool("merge statics", "Objects"),
+                                   Settings::Manager::getBool("threaded npc parts", "Objects"),
+                                   Settings::Manager::getInt("prewarm npc parts", "Objects"),
+                                   Settings::Manager::getFloat("animation lod distance", "Objects"),
+                                   Settings::Manager::getInt("max animation update interval", "Objects")));
+
+        int distantStatics = Settings::Manager::getInt("distant statics distance", "Cells");
+        if (distantStatics > 0)
+            mObjectPaging.reset(new ObjectPaging(lightRoot, mResourceSystem, distantStatics,
+                                                 Settings::Manager::getFloat("distant statics min radius", "Cells"), cachePath));
 
         mViewer->setIncrementalCompileOperation(new osgUtil::IncrementalCompileOperation);
 
@@ -190,7 +201,7 @@ namespace MWRender
         mViewer->getCamera()->setComputeNearFarMode(osg::Camera::DO_NOT_COMPUTE_NEAR_FAR);
         mViewer->getCamera()->setCullingMode(cullingMode);
 
-        mViewer->getCamera()->setCullMask(~(Mask_UpdateVisitor));
+        mViewer->getCamera()->setCullMask(~(Mask_UpdateVisitor|Mask_MergedObject));
 
         mNearClip = Settings::Manager::getFloat("near clip", "Camera");
         mViewDistance = Settings::Manager::getFloat("viewing distance", "Camera");
@@ -283,8 +294,15 @@ namespace MWRender
 
         mWater->changeCell(store);
 
+        mObjects->mergeCell(store);
+
         if (store->getCell()->isExterior())
+        {
             mTerrain->loadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
+
+            if (mObjectPaging.get())
+                mObjectPaging->setCellActive(store->getCell()->getGridX(), store->getCell()->getGridY(), true);
+        }
     }
 
     void RenderingManager::removeCell(const MWWorld::CellStore *store)
@@ -293,8 +311,13 @@ namespace MWRender
         mObjects->removeCell(store);
 
         if (store->getCell()->isExterior())
+        {
             mTerrain->unloadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
 
+            if (mObjectPaging.get())
+                mObjectPaging->setCellActive(store->getCell()->getGridX(), store->getCell()->getGridY(), false);
+        }
+
         mWater->removeCell(store);
     }
 
@@ -369,8 +392,14 @@ namespace MWRender
         mWater->update(dt);
         mCamera->update(dt, paused);
 
+        mObjects->update();
+
         osg::Vec3f focal, cameraPos;
         mCamera->getPosition(focal, cameraPos);
+
+        if (mObjectPaging.get())
+            mObjectPaging->update(cameraPos);
+
         if (mWater->isUnderwater(cameraPos))
         {
             setFogColor(osg::Vec4f(0.090195f, 0.115685f, 0.12745f, 1.f));
@@ -415,16 +444,19 @@ namespace MWRender
             mCamera->rotateCamera(-ptr.getRefData().getPosition().rot[0], -ptr.getRefData().getPosition().rot[2], false);
         }
 
+        mObjects->moveObject(ptr);
         ptr.getRefData().getBaseNode()->setAttitude(rot);
     }
 
     void RenderingManager::moveObject(const MWWorld::Ptr &ptr, const osg::Vec3f &pos)
     {
+        mObjects->moveObject(ptr);
         ptr.getRefData().getBaseNode()->setPosition(pos);
     }
 
     void RenderingManager::scaleObject(const MWWorld::Ptr &ptr, const osg::Vec3f &scale)
     {
+        mObjects->moveObject(ptr);
         ptr.getRefData().getBaseNode()->setScale(scale);
     }
 
@@ -592,7 +624,7 @@ namespace MWRender
 
         osgUtil::IntersectionVisitor intersectionVisitor(intersector);
         int mask = intersectionVisitor.getTraversalMask();
-        mask &= ~(Mask_RenderToTexture|Mask_Sky|Mask_Debug|Mask_Effect|Mask_Water);
+        mask &= ~(Mask_RenderToTexture|Mask_Sky|Mask_Debug|Mask_Effect|Mask_Water|Mask_MergedStatics|Mask_DistantStatics);
         if (ignorePlayer)
             mask &= ~(Mask_Player);
         if (ignoreActors)
@@ -621,7 +653,7 @@ namespace MWRender
 
         osgUtil::IntersectionVisitor intersectionVisitor(intersector);
         int mask = intersectionVisitor.getTraversalMask();
-        mask &= ~(Mask_RenderToTexture|Mask_Sky|Mask_Debug|Mask_Effect|Mask_Water);
+        mask &= ~(Mask_RenderToTexture|Mask_Sky|Mask_Debug|Mask_Effect|Mask_Water|Mask_MergedStatics|Mask_DistantStatics);
         if (ignorePlayer)
             mask &= ~(Mask_Player);
         if (ignoreActors)
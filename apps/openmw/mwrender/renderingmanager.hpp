@@ -53,11 +53,13 @@ namespace MWRender
     class Pathgrid;
     class Camera;
     class Water;
+    class ObjectPaging;
 
     class RenderingManager : public MWRender::RenderingInterface
     {
     public:
-        RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode, Resource::ResourceSystem* resourceSystem, const MWWorld::Fallback* fallback);
+        RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode, Resource::ResourceSystem* resourceSystem, const MWWorld::Fallback* fallback,
+                         const std::string& cachePath);
         ~RenderingManager();
 
         MWRender::Objects& getObjects();
@@ -180,6 +182,7 @@ namespace MWRender
 
         std::auto_ptr<Pathgrid> mPathgrid;
         std::auto_ptr<Objects> mObjects;
+        std::auto_ptr<ObjectPaging> mObjectPaging;
         std::auto_ptr<Water> mWater;
         std::auto_ptr<Terrain::World> mTerrain;
         std::auto_ptr<SkyManager> mSky;
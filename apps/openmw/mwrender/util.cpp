@@ -1,11 +1,20 @@
 #include "util.hpp"
 
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
 #include <osg/Node>
 
+#include <components/esm/esmreader.hpp>
+
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/texturemanager.hpp>
 #include <components/misc/resourcehelpers.hpp>
 
+#include "../mwbase/environment.hpp"
+#include "../mwbase/world.hpp"
+
 namespace MWRender
 {
 
@@ -28,4 +37,23 @@ void overrideTexture(const std::string &texture, Resource::ResourceSystem *resou
     node->setStateSet(stateset);
 }
 
+std::string getContentFilesKey()
+{
+    std::ostringstream key;
+
+    std::vector<ESM::ESMReader>& readers = MWBase::Environment::get().getWorld()->getEsmReader();
+    for (std::vector<ESM::ESMReader>::iterator it = readers.begin(); it != readers.end(); ++it)
+    {
+        boost::filesystem::path path (it->getName());
+
+        if (path.empty())
+            continue;
+
+        key << path.string() << " " << boost::filesystem::file_size(path)
+            << " " << boost::filesystem::last_write_time(path) << "\n";
+    }
+
+    return key.str();
+}
+
 }
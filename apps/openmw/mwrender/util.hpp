@@ -19,6 +19,11 @@ namespace MWRender
 
     void overrideTexture(const std::string& texture, Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Node> node);
 
+    /// Describe the content files in use (paths, sizes and modification times), to tell if data cached on disk is
+    /// still valid.
+    /// @throw std::exception if a content file can't be inspected
+    std::string getContentFilesKey();
+
 }
 
 #endif
@@ -26,7 +26,14 @@ namespace MWRender
         Mask_ParticleSystem = (1<<10),
 
         // Set on cameras within the main scene graph
-        Mask_RenderToTexture = (1<<11)
+        Mask_RenderToTexture = (1<<11),
+
+        // Set on objects that are drawn as part of a CellBatch, so they are only used for intersections
+        Mask_MergedObject = (1<<12),
+        // Set on the merged geometry of a CellBatch, which is only drawn
+        Mask_MergedStatics = (1<<13),
+        // Set on the simplified statics of exterior cells outside of the active grid, which are only drawn
+        Mask_DistantStatics = (1<<14)
 
         // reserved: (1<<16) for SceneUtil::Mask_Lit
     };
@@ -0,0 +1,50 @@
+#include "savegamewriter.hpp"
+
+#include <stdexcept>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+MWState::SaveGameWriter::Result::Result()
+: mSuccess (false)
+{}
+
+MWState::SaveGameWriter::SaveGameWriter (const boost::filesystem::path& path, std::auto_ptr<std::stringstream> data,
+    Result *result)
+: mPath (path), mData (data), mResult (result)
+{}
+
+void MWState::SaveGameWriter::doWork()
+{
+    boost::filesystem::path tempPath = mPath;
+    tempPath += ".tmp";
+
+    try
+    {
+        {
+            boost::filesystem::ofstream stream (tempPath, std::ios::binary);
+
+            stream << mData->rdbuf();
+            stream.close();
+
+            if (stream.fail())
+                throw std::runtime_error ("Write operation failed");
+        }
+
+        boost::filesystem::rename (tempPath, mPath);
+
+        mResult->mSuccess = true;
+    }
+    catch (const std::exception& e)
+    {
+        mResult->mError = e.what();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove (tempPath, ec);
+    }
+
+    // the work item may be kept around for a while, do not hold on to the encoded save until then
+    mData.reset();
+
+    mTicket->signalDone();
+}
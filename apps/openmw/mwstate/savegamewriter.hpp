@@ -0,0 +1,45 @@
+#ifndef GAME_STATE_SAVEGAMEWRITER_H
+#define GAME_STATE_SAVEGAMEWRITER_H
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+#include <components/sceneutil/workqueue.hpp>
+
+namespace MWState
+{
+    /// \brief Writes an already encoded saved game to disk
+    ///
+    /// Meant to be run on a background thread, so that the file I/O does not stall the game. The data
+    /// is written to a temporary file first, which then replaces \a path, so that an existing save is
+    /// not lost if writing fails.
+    class SaveGameWriter : public SceneUtil::WorkItem
+    {
+        public:
+
+            /// Outcome of the write operation. Only valid once the work ticket is done.
+            struct Result : public osg::Referenced
+            {
+                bool mSuccess;
+                std::string mError;
+
+                Result();
+            };
+
+            SaveGameWriter (const boost::filesystem::path& path, std::auto_ptr<std::stringstream> data,
+                Result *result);
+
+            virtual void doWork();
+
+        private:
+
+            boost::filesystem::path mPath;
+            std::auto_ptr<std::stringstream> mData;
+            osg::ref_ptr<Result> mResult;
+    };
+}
+
+#endif
@@ -15,7 +15,6 @@
 
 #include <osgDB/Registry>
 
-#include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
 
 #include "../mwbase/environment.hpp"
@@ -86,12 +85,59 @@ std::map<int, int> MWState::StateManager::buildContentFileIndexMap (const ESM::E
     return map;
 }
 
+void MWState::StateManager::finishSave (bool wait)
+{
+    if (!mSaveTicket)
+        return;
+
+    if (!wait && !mSaveTicket->isDone())
+        return;
+
+    mSaveTicket->waitTillDone();
+
+    if (!mSaveResult->mSuccess)
+        handleSaveError ("Failed to save game: " + mSaveResult->mError, mSaveCharacter, mSavePath);
+
+    mSaveTicket = NULL;
+    mSaveResult = NULL;
+    mSaveCharacter = NULL;
+}
+
+void MWState::StateManager::handleSaveError (const std::string& message, Character *character,
+    const boost::filesystem::path& path)
+{
+    std::cerr << message << std::endl;
+
+    std::vector<std::string> buttons;
+    buttons.push_back("#{sOk}");
+    MWBase::Environment::get().getWindowManager()->interactiveMessageBox(message, buttons);
+
+    // If no file was written, clean up the slot
+    if (character && !path.empty() && !boost::filesystem::exists(path))
+    {
+        for (Character::SlotIterator it = character->begin(); it != character->end(); ++it)
+            if (it->mPath == path)
+            {
+                character->deleteSlot(&*it);
+                break;
+            }
+    }
+}
+
 MWState::StateManager::StateManager (const boost::filesystem::path& saves, const std::string& game)
 : mQuitRequest (false), mAskLoadRecent(false), mState (State_NoGame), mCharacterManager (saves, game), mTimePlayed (0)
+, mSaveQueue (1), mSaveCharacter (NULL)
 {
 
 }
 
+MWState::StateManager::~StateManager()
+{
+    // Make sure a pending saved game makes it to disk before the work queue is destroyed
+    if (mSaveTicket)
+        mSaveTicket->waitTillDone();
+}
+
 void MWState::StateManager::requestQuit()
 {
     mQuitRequest = true;
@@ -172,6 +218,9 @@ void MWState::StateManager::endGame()
 
 void MWState::StateManager::saveGame (const std::string& description, const Slot *slot)
 {
+    // The previous save has to be on disk before its slot can be reused
+    finishSave (true);
+
     try
     {
         ESM::SavedGame profile;
@@ -207,7 +256,10 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         else
             slot = getCurrentCharacter()->updateSlot (slot, profile);
 
-        boost::filesystem::ofstream stream (slot->mPath, std::ios::binary);
+        // Only the file I/O is done in the background. The ESM encoding below still runs on the main thread,
+        // because the writers read the live game state and there is no snapshot of it a worker could encode.
+        // The encoded data is handed over to the writer, so it is not copied again.
+        std::auto_ptr<std::stringstream> stream (new std::stringstream (std::ios::in | std::ios::out | std::ios::binary));
 
         ESM::ESMWriter writer;
 
@@ -235,7 +287,7 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
                 +MWBase::Environment::get().getMechanicsManager()->countSavedGameRecords();
         writer.setRecordCount (recordCount);
 
-        writer.save (stream);
+        writer.save (*stream);
 
         Loading::Listener& listener = *MWBase::Environment::get().getWindowManager()->getLoadingScreen();
         // Using only Cells for progress information, since they typically have the largest records by far
@@ -261,9 +313,14 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
 
         writer.close();
 
-        if (stream.fail())
+        if (stream->fail())
             throw std::runtime_error("Write operation failed");
 
+        mSaveResult = new SaveGameWriter::Result;
+        mSaveCharacter = getCurrentCharacter();
+        mSavePath = slot->mPath;
+        mSaveTicket = mSaveQueue.addWorkItem (new SaveGameWriter (slot->mPath, stream, mSaveResult.get()));
+
         Settings::Manager::setString ("character", "Saves",
             slot->mPath.parent_path().filename().string());
     }
@@ -272,15 +329,7 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         std::stringstream error;
         error << "Failed to save game: " << e.what();
 
-        std::cerr << error.str() << std::endl;
-
-        std::vector<std::string> buttons;
-        buttons.push_back("#{sOk}");
-        MWBase::Environment::get().getWindowManager()->interactiveMessageBox(error.str(), buttons);
-
-        // If no file was written, clean up the slot
-        if (slot && !boost::filesystem::exists(slot->mPath))
-            getCurrentCharacter()->deleteSlot(slot);
+        handleSaveError (error.str(), getCurrentCharacter(), slot ? slot->mPath : boost::filesystem::path());
     }
 }
 
@@ -310,6 +359,8 @@ void MWState::StateManager::quickSave (std::string name)
 
 void MWState::StateManager::loadGame(const std::string& filepath)
 {
+    // No need to wait for a save in progress here: it always belongs to a known slot, which is loaded through
+    // the overload below.
     for (CharacterIterator it = mCharacterManager.begin(); it != mCharacterManager.end(); ++it)
     {
         const MWState::Character& character = *it;
@@ -341,6 +392,9 @@ void MWState::StateManager::loadGame(const std::string& filepath)
 
 void MWState::StateManager::loadGame (const Character *character, const std::string& filepath)
 {
+    // The file might still be being written
+    finishSave (true);
+
     try
     {
         cleanup();
@@ -515,6 +569,8 @@ void MWState::StateManager::quickLoad()
 
 void MWState::StateManager::deleteGame(const MWState::Character *character, const MWState::Slot *slot)
 {
+    finishSave (true);
+
     mCharacterManager.deleteSlot(character, slot);
 }
 
@@ -540,6 +596,8 @@ void MWState::StateManager::update (float duration)
 {
     mTimePlayed += duration;
 
+    finishSave (false);
+
     // Note: It would be nicer to trigger this from InputManager, i.e. the very beginning of the frame update.
     if (mAskLoadRecent)
     {
@@ -7,7 +7,10 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include "charactermanager.hpp"
+#include "savegamewriter.hpp"
 
 namespace MWState
 {
@@ -19,10 +22,24 @@ namespace MWState
             CharacterManager mCharacterManager;
             double mTimePlayed;
 
+            // Saved games are written to disk in the background
+            SceneUtil::WorkQueue mSaveQueue;
+            osg::ref_ptr<SceneUtil::WorkTicket> mSaveTicket;
+            osg::ref_ptr<SaveGameWriter::Result> mSaveResult;
+            Character *mSaveCharacter;
+            boost::filesystem::path mSavePath;
+
         private:
 
             void cleanup (bool force = false);
 
+            void finishSave (bool wait);
+            ///< Check the outcome of a saved game still being written in the background.
+            /// \param wait Block until the write is complete?
+
+            void handleSaveError (const std::string& message, Character *character,
+                const boost::filesystem::path& path);
+
             bool verifyProfile (const ESM::SavedGame& profile) const;
 
             void writeScreenshot (std::vector<char>& imageData) const;
@@ -33,6 +50,8 @@ namespace MWState
 
             StateManager (const boost::filesystem::path& saves, const std::string& game);
 
+            virtual ~StateManager();
+
             virtual void requestQuit();
 
             virtual bool hasQuitRequest() const;
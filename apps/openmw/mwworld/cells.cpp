@@ -3,8 +3,9 @@
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
 #include <components/esm/defs.hpp>
-#include <components/esm/cellstate.hpp>
+#include <components/esm/cellid.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
+#include <components/settings/settings.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -67,20 +68,20 @@ MWWorld::Ptr MWWorld::Cells::getPtrAndCache (const std::string& name, CellStore&
     return ptr;
 }
 
-void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
+void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell, bool compress) const
 {
-    if (cell.getState()!=CellStore::State_Loaded)
-        cell.load (mStore, mReader);
+    writer.startRecord (ESM::REC_CSTA);
+    cell.getCell()->getCellId().save (writer);
 
-    ESM::CellState cellState;
+    // cells that have not been accessed or modified since the game was loaded are passed through without decoding
+    if (!cell.writePendingState (writer, compress))
+    {
+        if (cell.getState()!=CellStore::State_Loaded)
+            cell.load (mStore, mReader);
 
-    cell.saveState (cellState);
+        cell.writeState (writer, compress);
+    }
 
-    writer.startRecord (ESM::REC_CSTA);
-    cellState.mId.save (writer);
-    cellState.save (writer);
-    cell.writeFog(writer);
-    cell.writeReferences (writer);
     writer.endRecord (ESM::REC_CSTA);
 }
 
@@ -287,11 +288,13 @@ int MWWorld::Cells::countSavedGameRecords() const
 
 void MWWorld::Cells::write (ESM::ESMWriter& writer, Loading::Listener& progress) const
 {
+    bool compress = Settings::Manager::getBool ("compress cell state", "Saves");
+
     for (std::map<std::pair<int, int>, CellStore>::iterator iter (mExteriors.begin());
         iter!=mExteriors.end(); ++iter)
         if (iter->second.hasState())
         {
-            writeCell (writer, iter->second);
+            writeCell (writer, iter->second, compress);
             progress.increaseProgress();
         }
 
@@ -299,7 +302,7 @@ void MWWorld::Cells::write (ESM::ESMWriter& writer, Loading::Listener& progress)
         iter!=mInteriors.end(); ++iter)
         if (iter->second.hasState())
         {
-            writeCell (writer, iter->second);
+            writeCell (writer, iter->second, compress);
             progress.increaseProgress();
         }
 }
@@ -309,16 +312,21 @@ bool MWWorld::Cells::readRecord (ESM::ESMReader& reader, uint32_t type,
 {
     if (type==ESM::REC_CSTA)
     {
-        ESM::CellState state;
-        state.mId.load (reader);
+        ESM::CellId id;
+        id.load (reader);
 
         CellStore *cellStore = 0;
 
-        try
-        {
-            cellStore = getCell (state.mId);
-        }
-        catch (...)
+        // Look the cell up without loading it. Its state is decoded on first access.
+        const ESM::Cell *cell = id.mPaged ?
+            mStore.get<ESM::Cell>().search (id.mIndex.mX, id.mIndex.mY) :
+            mStore.get<ESM::Cell>().search (id.mWorldspace);
+
+        if (cell)
+            cellStore = getCellStore (cell);
+        else if (id.mPaged)
+            cellStore = getExterior (id.mIndex.mX, id.mIndex.mY);
+        else
         {
             // silently drop cells that don't exist anymore
             reader.skipRecord();
@@ -326,17 +334,11 @@ bool MWWorld::Cells::readRecord (ESM::ESMReader& reader, uint32_t type,
             /// \todo log
         }
 
-        state.load (reader);
-        cellStore->loadState (state);
-
-        if (state.mHasFogOfWar)
-            cellStore->readFog(reader);
+        cellStore->readPendingState (reader, contentFileMap);
 
-        if (cellStore->getState()!=CellStore::State_Loaded)
+        if (cellStore->getState()==CellStore::State_Preloaded)
             cellStore->load (mStore, mReader);
 
-        cellStore->readReferences (reader, contentFileMap);
-
         return true;
     }
 
@@ -41,7 +41,7 @@ namespace MWWorld
 
             Ptr getPtrAndCache (const std::string& name, CellStore& cellStore);
 
-            void writeCell (ESM::ESMWriter& writer, CellStore& cell) const;
+            void writeCell (ESM::ESMWriter& writer, CellStore& cell, bool compress) const;
 
         public:
 
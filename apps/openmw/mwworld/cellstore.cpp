@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <sstream>
 
 #include <components/esm/cellstate.hpp>
 #include <components/esm/cellid.hpp>
@@ -14,6 +15,10 @@
 #include <components/esm/fogstate.hpp>
 #include <components/esm/creaturelevliststate.hpp>
 #include <components/esm/doorstate.hpp>
+#include <components/esm/savedgame.hpp>
+#include <components/esm/defs.hpp>
+
+#include <components/misc/compression.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -141,6 +146,23 @@ namespace
         ref.load (state);
         collection.mList.push_back (ref);
     }
+
+    void writeChunk (ESM::ESMWriter& writer, const char *data, std::size_t size, bool compress)
+    {
+        if (!compress)
+        {
+            writer.write (data, size);
+            return;
+        }
+
+        std::vector<char> compressed;
+        Misc::Compression::compress (data, size, compressed);
+
+        writer.writeHNT ("ZSIZ", static_cast<uint32_t> (size));
+        writer.startSubRecord ("ZDAT");
+        writer.write (&compressed[0], compressed.size());
+        writer.endRecord ("ZDAT");
+    }
 }
 
 namespace MWWorld
@@ -302,7 +324,10 @@ namespace MWWorld
     void CellStore::setWaterLevel (float level)
     {
         mWaterLevel = level;
-        mHasState = true;
+        markModified();
+
+        if (mPendingState.get())
+            mPendingState->mWaterLevelChanged = true;
     }
 
     int CellStore::count() const
@@ -341,6 +366,9 @@ namespace MWWorld
 
             mState = State_Loaded;
 
+            if (mPendingState.get())
+                applyPendingState();
+
             // TODO: the pathgrid graph only needs to be loaded for active cells, so move this somewhere else.
             // In a simple test, loading the graph for all cells in MW + expansions took 200 ms
             mPathgridGraph.load(this);
@@ -351,6 +379,13 @@ namespace MWWorld
     {
         if (mState==State_Unloaded)
         {
+            // saved references may differ from the ones listed in the content files
+            if (mPendingState.get())
+            {
+                load (store, esm);
+                return;
+            }
+
             listRefs (store, esm);
 
             mState = State_Preloaded;
@@ -725,6 +760,155 @@ namespace MWWorld
         return mFogState.get();
     }
 
+    void CellStore::writeState (ESM::ESMWriter& writer, bool compress) const
+    {
+        ESM::CellState cellState;
+
+        saveState (cellState);
+
+        if (!compress)
+        {
+            cellState.save (writer);
+            writeFog (writer);
+            writeReferences (writer);
+            return;
+        }
+
+        std::ostringstream stream;
+        ESM::ESMWriter chunkWriter;
+        chunkWriter.open (stream);
+
+        cellState.save (chunkWriter);
+        writeFog (chunkWriter);
+        writeReferences (chunkWriter);
+        chunkWriter.close();
+
+        std::string data = stream.str();
+        writeChunk (writer, data.c_str(), data.size(), true);
+    }
+
+    void CellStore::readPendingState (ESM::ESMReader& reader, const std::map<int, int>& contentFileMap)
+    {
+        boost::shared_ptr<PendingState> state (new PendingState);
+
+        state->mFormat = reader.getFormat();
+        state->mContentFileMap = contentFileMap;
+        state->mCompressed = reader.isNextSub ("ZSIZ");
+        state->mUncompressedSize = 0;
+        state->mDirty = false;
+        state->mWaterLevelChanged = false;
+
+        if (state->mCompressed)
+        {
+            uint32_t size = 0;
+            reader.getHT (size);
+            state->mUncompressedSize = size;
+
+            reader.getSubNameIs ("ZDAT");
+            reader.getSubHeader();
+            state->mData.resize (reader.getSubSize());
+
+            if (!state->mData.empty())
+                reader.getExact (&state->mData[0], state->mData.size());
+        }
+        else
+        {
+            reader.getRecordData (state->mData);
+            state->mUncompressedSize = state->mData.size();
+        }
+
+        mPendingState = state;
+        mHasState = true;
+
+        if (mState==State_Loaded)
+            applyPendingState();
+    }
+
+    bool CellStore::writePendingState (ESM::ESMWriter& writer, bool compress) const
+    {
+        if (!mPendingState.get() || mPendingState->mDirty || mPendingState->mFormat!=ESM::SavedGame::sCurrentFormat)
+            return false;
+
+        // references are identified by content file indices, which must not have changed
+        for (std::map<int, int>::const_iterator iter (mPendingState->mContentFileMap.begin());
+            iter!=mPendingState->mContentFileMap.end(); ++iter)
+            if (iter->first!=iter->second)
+                return false;
+
+        const std::vector<char>& data = mPendingState->mData;
+
+        if (mPendingState->mCompressed && compress)
+        {
+            writer.writeHNT ("ZSIZ", static_cast<uint32_t> (mPendingState->mUncompressedSize));
+            writer.startSubRecord ("ZDAT");
+            if (!data.empty())
+                writer.write (&data[0], data.size());
+            writer.endRecord ("ZDAT");
+        }
+        else if (mPendingState->mCompressed)
+        {
+            std::vector<char> uncompressed;
+            Misc::Compression::decompress (data.empty() ? 0 : &data[0], data.size(),
+                mPendingState->mUncompressedSize, uncompressed);
+
+            if (!uncompressed.empty())
+                writer.write (&uncompressed[0], uncompressed.size());
+        }
+        else if (!data.empty())
+            writeChunk (writer, &data[0], data.size(), compress);
+
+        return true;
+    }
+
+    void CellStore::applyPendingState()
+    {
+        boost::shared_ptr<PendingState> pending = mPendingState;
+        mPendingState.reset();
+
+        try
+        {
+            std::vector<char> data;
+
+            if (pending->mCompressed)
+                Misc::Compression::decompress (pending->mData.empty() ? 0 : &pending->mData[0],
+                    pending->mData.size(), pending->mUncompressedSize, data);
+            else
+                data.swap (pending->mData);
+
+            // Wrap the sub-records into a record again, so they can be read through the regular interface
+            uint32_t header[4] = { ESM::REC_CSTA, static_cast<uint32_t> (data.size()), 0, 0 };
+
+            std::string buffer (reinterpret_cast<const char *> (header), sizeof (header));
+            buffer.append (data.begin(), data.end());
+
+            ESM::ESMReader reader;
+            reader.openRaw (Files::IStreamPtr (new std::istringstream (buffer)), "saved game");
+            reader.setFormat (pending->mFormat);
+            reader.getRecName();
+            reader.getRecHeader();
+
+            ESM::CellState state;
+            state.load (reader);
+
+            float waterLevel = mWaterLevel;
+            loadState (state);
+
+            if (pending->mWaterLevelChanged)
+                mWaterLevel = waterLevel;
+
+            if (state.mHasFogOfWar)
+                readFog (reader);
+
+            readReferences (reader, pending->mContentFileMap);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr
+                << "Error: failed to load saved state of cell " << mCell->getDescription()
+                << ": " << e.what() << std::endl;
+        }
+    }
+
     void CellStore::respawn()
     {
         if (mState == State_Loaded)
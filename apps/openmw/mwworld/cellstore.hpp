@@ -65,6 +65,24 @@ namespace MWWorld
             // Note this is NULL until the cell is explored to save some memory
             boost::shared_ptr<ESM::FogState> mFogState;
 
+            /// Saved game state that has been read, but not decoded yet
+            struct PendingState
+            {
+                std::vector<char> mData; // sub-records following the cell ID
+                bool mCompressed;
+                std::size_t mUncompressedSize;
+                int mFormat;
+                std::map<int, int> mContentFileMap;
+
+                // changes made to the cell before the state has been decoded
+                bool mDirty;
+                bool mWaterLevelChanged;
+            };
+
+            // Decoding is deferred until the cell is accessed for the first time. Note this is NULL
+            // for cells that have not been part of the loaded game or have been accessed already.
+            boost::shared_ptr<PendingState> mPendingState;
+
             const ESM::Cell *mCell;
             State mState;
             bool mHasState;
@@ -143,7 +161,7 @@ namespace MWWorld
             template<class Functor>
             bool forEach (Functor& functor)
             {
-                mHasState = true;
+                markModified();
 
                 return
                     forEachImp (functor, mActivators) &&
@@ -171,7 +189,7 @@ namespace MWWorld
             template<class Functor>
             bool forEachContainer (Functor& functor)
             {
-                mHasState = true;
+                markModified();
 
                 return
                     forEachImp (functor, mContainers) &&
@@ -195,6 +213,21 @@ namespace MWWorld
 
             void readReferences (ESM::ESMReader& reader, const std::map<int, int>& contentFileMap);
 
+            void writeState (ESM::ESMWriter& writer, bool compress) const;
+            ///< Write cell state, fog and references, optionally as a single compressed sub-record.
+            /// \note The cell must be loaded.
+
+            void readPendingState (ESM::ESMReader& reader, const std::map<int, int>& contentFileMap);
+            ///< Read the remainder of a cell state record as written by writeState, but defer decoding
+            /// it until the cell is preloaded or loaded.
+
+            bool writePendingState (ESM::ESMWriter& writer, bool compress) const;
+            ///< Write the state read by readPendingState back without decoding it.
+            ///
+            /// \return Has the state been written? This is not possible if there is no pending state, if it
+            /// has been read from a different format or with a different content file list, or if the cell
+            /// has been modified since (e.g. objects moved into it while it was not loaded).
+
             void respawn ();
             ///< Check mLastRespawn and respawn references if necessary. This is a no-op if the cell is not loaded.
 
@@ -238,146 +271,163 @@ namespace MWWorld
             ///
             /// Invalid \a ref objects are silently dropped.
 
+            void applyPendingState();
+            ///< Decode the state read by readPendingState. The cell must be loaded.
+            ///
+            /// \note Changes made to the cell before do not get overwritten.
+
+            void markModified();
+            ///< The cell has state now. If its saved state has not been decoded yet, it can not be
+            /// written back verbatim anymore.
+
             MWMechanics::PathgridGraph mPathgridGraph;
     };
 
+    inline void CellStore::markModified()
+    {
+        mHasState = true;
+
+        if (mPendingState.get())
+            mPendingState->mDirty = true;
+    }
+
     template<>
     inline CellRefList<ESM::Activator>& CellStore::get<ESM::Activator>()
     {
-        mHasState = true;
+        markModified();
         return mActivators;
     }
 
     template<>
     inline CellRefList<ESM::Potion>& CellStore::get<ESM::Potion>()
     {
-        mHasState = true;
+        markModified();
         return mPotions;
     }
 
     template<>
     inline CellRefList<ESM::Apparatus>& CellStore::get<ESM::Apparatus>()
     {
-        mHasState = true;
+        markModified();
         return mAppas;
     }
 
     template<>
     inline CellRefList<ESM::Armor>& CellStore::get<ESM::Armor>()
     {
-        mHasState = true;
+        markModified();
         return mArmors;
     }
 
     template<>
     inline CellRefList<ESM::Book>& CellStore::get<ESM::Book>()
     {
-        mHasState = true;
+        markModified();
         return mBooks;
     }
 
     template<>
     inline CellRefList<ESM::Clothing>& CellStore::get<ESM::Clothing>()
     {
-        mHasState = true;
+        markModified();
         return mClothes;
     }
 
     template<>
     inline CellRefList<ESM::Container>& CellStore::get<ESM::Container>()
     {
-        mHasState = true;
+        markModified();
         return mContainers;
     }
 
     template<>
     inline CellRefList<ESM::Creature>& CellStore::get<ESM::Creature>()
     {
-        mHasState = true;
+        markModified();
         return mCreatures;
     }
 
     template<>
     inline CellRefList<ESM::Door>& CellStore::get<ESM::Door>()
     {
-        mHasState = true;
+        markModified();
         return mDoors;
     }
 
     template<>
     inline CellRefList<ESM::Ingredient>& CellStore::get<ESM::Ingredient>()
     {
-        mHasState = true;
+        markModified();
         return mIngreds;
     }
 
     template<>
     inline CellRefList<ESM::CreatureLevList>& CellStore::get<ESM::CreatureLevList>()
     {
-        mHasState = true;
+        markModified();
         return mCreatureLists;
     }
 
     template<>
     inline CellRefList<ESM::ItemLevList>& CellStore::get<ESM::ItemLevList>()
     {
-        mHasState = true;
+        markModified();
         return mItemLists;
     }
 
     template<>
     inline CellRefList<ESM::Light>& CellStore::get<ESM::Light>()
     {
-        mHasState = true;
+        markModified();
         return mLights;
     }
 
     template<>
     inline CellRefList<ESM::Lockpick>& CellStore::get<ESM::Lockpick>()
     {
-        mHasState = true;
+        markModified();
         return mLockpicks;
     }
 
     template<>
     inline CellRefList<ESM::Miscellaneous>& CellStore::get<ESM::Miscellaneous>()
     {
-        mHasState = true;
+        markModified();
         return mMiscItems;
     }
 
     template<>
     inline CellRefList<ESM::NPC>& CellStore::get<ESM::NPC>()
     {
-        mHasState = true;
+        markModified();
         return mNpcs;
     }
 
     template<>
     inline CellRefList<ESM::Probe>& CellStore::get<ESM::Probe>()
     {
-        mHasState = true;
+        markModified();
         return mProbes;
     }
 
     template<>
     inline CellRefList<ESM::Repair>& CellStore::get<ESM::Repair>()
     {
-        mHasState = true;
+        markModified();
         return mRepairs;
     }
 
     template<>
     inline CellRefList<ESM::Static>& CellStore::get<ESM::Static>()
     {
-        mHasState = true;
+        markModified();
         return mStatics;
     }
 
     template<>
     inline CellRefList<ESM::Weapon>& CellStore::get<ESM::Weapon>()
     {
-        mHasState = true;
+        markModified();
         return mWeapons;
     }
 
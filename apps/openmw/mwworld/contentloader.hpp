@@ -21,6 +21,12 @@ struct ContentLoader
     {
     }
 
+    /// Called for all content files before the first one is loaded. Loaders may use this to start
+    /// reading files in the background, as long as load() is still applied in order.
+    virtual void prepare(const boost::filesystem::path& filepath, int index)
+    {
+    }
+
     virtual void load(const boost::filesystem::path& filepath, int& index)
     {
       std::cout << "Loading content file " << filepath.string() << std::endl;
@@ -1,7 +1,88 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
+#include <OpenThreads/Thread>
+
+#include <boost/filesystem/fstream.hpp>
+
 #include <components/esm/esmreader.hpp>
+#include <components/files/memorystream.hpp>
+
+namespace
+{
+    int getNumThreads()
+    {
+        return std::max(1, OpenThreads::GetNumberOfProcessors());
+    }
+
+    Files::IStreamPtr openMemoryStream(const std::vector<char>& data)
+    {
+        return Files::IStreamPtr(new Files::IMemStream(&data[0], data.size()));
+    }
+
+    /// Reads a content file into memory and parses its records into a buffer of staged records
+    class PrepareContentFile : public SceneUtil::WorkItem
+    {
+    public:
+        PrepareContentFile(const MWWorld::ESMStore& store, const boost::filesystem::path& filepath, int index,
+            ToUTF8::Utf8Encoder* encoder, const boost::shared_ptr<std::vector<char> >& data,
+            const boost::shared_ptr<MWWorld::ESMStore::StagedRecords>& records)
+          : mStore(store)
+          , mPath(filepath)
+          , mIndex(index)
+          , mEncoder(encoder)
+          , mData(data)
+          , mRecords(records)
+        {
+        }
+
+        virtual void doWork()
+        {
+            try
+            {
+                boost::filesystem::ifstream stream(mPath, std::ios::binary);
+                stream.seekg(0, std::ios::end);
+                std::streamoff size = stream.tellg();
+                stream.seekg(0, std::ios::beg);
+
+                if (!stream || size <= 0)
+                    throw std::runtime_error("can't read " + mPath.string());
+
+                mData->resize(static_cast<std::size_t>(size));
+                stream.read(&(*mData)[0], size);
+
+                if (stream.gcount() != size)
+                    throw std::runtime_error("can't read " + mPath.string());
+
+                ESM::ESMReader esm;
+                esm.setEncoder(mEncoder);
+                esm.setIndex(mIndex);
+                esm.open(openMemoryStream(*mData), mPath.string());
+
+                mStore.prepare(esm, *mRecords);
+            }
+            catch (const std::exception&)
+            {
+                // Let the regular loading code report the error
+                mData->clear();
+                mRecords->clear();
+            }
+
+            mTicket->signalDone();
+        }
+
+    private:
+        const MWWorld::ESMStore& mStore;
+        boost::filesystem::path mPath;
+        int mIndex;
+        ToUTF8::Utf8Encoder* mEncoder;
+        boost::shared_ptr<std::vector<char> > mData;
+        boost::shared_ptr<MWWorld::ESMStore::StagedRecords> mRecords;
+    };
+}
 
 namespace MWWorld
 {
@@ -12,20 +93,68 @@ EsmLoader::EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& read
   , mEsm(readers)
   , mStore(store)
   , mEncoder(encoder)
+  , mMaxPrepared(2*getNumThreads())
+  , mWorkQueue(getNumThreads())
+{
+}
+
+void EsmLoader::prepare(const boost::filesystem::path& filepath, int index)
+{
+  mQueued.push_back(std::make_pair(filepath, index));
+  startPreparing();
+}
+
+void EsmLoader::startPreparing()
 {
+  while (!mQueued.empty() && mPrepared.size() < mMaxPrepared)
+  {
+    PreparedFile& file = mPrepared[mQueued.front().second];
+    file.mData.reset(new std::vector<char>);
+    file.mRecords.reset(new ESMStore::StagedRecords);
+    file.mTicket = mWorkQueue.addWorkItem(new PrepareContentFile(mStore, mQueued.front().first,
+      mQueued.front().second, mEncoder, file.mData, file.mRecords));
+
+    mQueued.pop_front();
+  }
 }
 
 void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
 {
   ContentLoader::load(filepath.filename(), index);
 
+  boost::shared_ptr<std::vector<char> > data;
+  boost::shared_ptr<ESMStore::StagedRecords> staged;
+
+  std::map<int, PreparedFile>::iterator prepared = mPrepared.find(index);
+  if (prepared != mPrepared.end())
+  {
+    prepared->second.mTicket->waitTillDone();
+    data = prepared->second.mData;
+    staged = prepared->second.mRecords;
+    mPrepared.erase(prepared);
+
+    // keep the worker threads busy while this file is merged
+    startPreparing();
+  }
+
   ESM::ESMReader lEsm;
   lEsm.setEncoder(mEncoder);
   lEsm.setIndex(index);
   lEsm.setGlobalReaderList(&mEsm);
-  lEsm.open(filepath.string());
+
+  // the file has been read into memory already by the worker thread
+  if (data && !data->empty())
+    lEsm.open(openMemoryStream(*data), filepath.string());
+  else
+    lEsm.open(filepath.string());
+
   mEsm[index] = lEsm;
-  mStore.load(mEsm[index], &mListener);
+  mStore.load(mEsm[index], &mListener, staged.get());
+
+  // Cells are loaded from this reader later on, switch it over to the file so that the data can be freed.
+  // The header and the contexts saved so far remain valid.
+  if (data && !data->empty())
+    mEsm[index].openRaw(filepath.string());
 }
 
 } /* namespace MWWorld */
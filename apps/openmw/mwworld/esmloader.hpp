@@ -2,8 +2,13 @@
 #define ESMLOADER_HPP
 
 #include <vector>
+#include <deque>
+#include <map>
+
+#include <components/sceneutil/workqueue.hpp>
 
 #include "contentloader.hpp"
+#include "esmstore.hpp"
 
 namespace ToUTF8
 {
@@ -18,19 +23,39 @@ namespace ESM
 namespace MWWorld
 {
 
-class ESMStore;
-
+/// Content files are loaded in two stages: on prepare(), worker threads start reading upcoming
+/// files into memory and parsing their records into per-file buffers. load() then merges these
+/// records into the ESMStore in load order, and parses those that depend on earlier files (cells,
+/// landscape, dialogue, overridden records) on the spot, reading from the same memory.
 struct EsmLoader : public ContentLoader
 {
     EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
       ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener);
 
+    void prepare(const boost::filesystem::path& filepath, int index);
+
     void load(const boost::filesystem::path& filepath, int& index);
 
     private:
+      struct PreparedFile
+      {
+          osg::ref_ptr<SceneUtil::WorkTicket> mTicket;
+          boost::shared_ptr<std::vector<char> > mData; // contents of the file, empty if it could not be read
+          boost::shared_ptr<ESMStore::StagedRecords> mRecords;
+      };
+
+      void startPreparing();
+      ///< Hand files to the worker threads, keeping at most mMaxPrepared files in memory.
+
       std::vector<ESM::ESMReader>& mEsm;
       MWWorld::ESMStore& mStore;
       ToUTF8::Utf8Encoder* mEncoder;
+
+      std::deque<std::pair<boost::filesystem::path, int> > mQueued;
+      std::map<int, PreparedFile> mPrepared;
+      std::size_t mMaxPrepared;
+
+      SceneUtil::WorkQueue mWorkQueue;
 };
 
 } /* namespace MWWorld */
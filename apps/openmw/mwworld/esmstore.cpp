@@ -26,7 +26,43 @@ static bool isCacheableRecord(int id)
     return false;
 }
 
-void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+void ESMStore::prepare(ESM::ESMReader &esm, StagedRecords &records) const
+{
+    while(esm.hasMoreRecs())
+    {
+        ESM::NAME n = esm.getRecName();
+        esm.getRecHeader();
+
+        records.push_back(boost::shared_ptr<StagedRecord>());
+
+        std::map<int, StoreBase *>::const_iterator it = mStores.find(n.val);
+
+        if (it == mStores.end()) {
+            esm.skipRecord();
+            continue;
+        }
+
+        std::string id = esm.getHNOString("NAME");
+
+        // deleted records are left to load()
+        if (esm.isNextSub("DELE")) {
+            esm.skipRecord();
+            continue;
+        }
+
+        boost::shared_ptr<StagedRecord> record(it->second->parse(esm, id));
+
+        if (!record.get() || esm.isNextSub("DELE") || esm.hasMoreSubs()) {
+            esm.skipRecord();
+            continue;
+        }
+
+        record->mId = id;
+        records.back() = record;
+    }
+}
+
+void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener, StagedRecords *staged)
 {
     listener->setProgressRange(1000);
 
@@ -61,14 +97,34 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
     }
 
     // Loop through all records
+    size_t recordIndex = 0;
     while(esm.hasMoreRecs())
     {
         ESM::NAME n = esm.getRecName();
         esm.getRecHeader();
 
+        StagedRecord *record = 0;
+        if (staged && recordIndex < staged->size())
+            record = (*staged)[recordIndex].get();
+        ++recordIndex;
+
         // Look up the record type.
         std::map<int, StoreBase *>::iterator it = mStores.find(n.val);
 
+        // Records that have been parsed ahead of time only need to be inserted
+        if (record && it != mStores.end() && it->second->loadStaged(*record)) {
+            esm.skipRecord();
+
+            dialogue = 0;
+
+            if (!record->mId.empty() && isCacheableRecord(n.val)) {
+                mIds[Misc::StringUtils::lowerCase (record->mId)] = n.val;
+            }
+
+            listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+            continue;
+        }
+
         if (it == mStores.end()) {
             if (n.val == ESM::REC_INFO) {
                 if (dialogue)
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <stdexcept>
 
+#include <boost/shared_ptr.hpp>
+
 #include <components/esm/records.hpp>
 #include "store.hpp"
 
@@ -158,7 +160,19 @@ namespace MWWorld
             mNpcs.insert(mPlayerTemplate);
         }
 
-        void load(ESM::ESMReader &esm, Loading::Listener* listener);
+        /// Records of a content file that have been parsed ahead of time, indexed by their position
+        /// in the file. Records that could not be parsed ahead of time are NULL.
+        typedef std::vector<boost::shared_ptr<StagedRecord> > StagedRecords;
+
+        void prepare(ESM::ESMReader &esm, StagedRecords &records) const;
+        ///< Parse all records of \a esm that do not depend on previously loaded content files.
+        ///
+        /// \note Does not modify the store and can be called from a worker thread while another
+        /// content file is being loaded.
+
+        void load(ESM::ESMReader &esm, Loading::Listener* listener, StagedRecords *staged = 0);
+        ///< \param staged Records of \a esm parsed by prepare(). Records that are not staged or can't
+        /// be inserted as parsed are read from \a esm instead.
 
         template <class T>
         const Store<T> &get() const {
@@ -6,6 +6,7 @@
 #include <components/loadinglistener/loadinglistener.hpp>
 #include <components/misc/rng.hpp>
 
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 
@@ -190,6 +191,31 @@ namespace MWWorld
         inserted.first->second.load(esm);
     }
     template<typename T>
+    StagedRecord *Store<T>::parse(ESM::ESMReader &esm, const std::string &id) const
+    {
+        std::auto_ptr<StagedRecordData<T> > record(new StagedRecordData<T>);
+
+        record->mRecord.mId = Misc::StringUtils::lowerCase(id);
+        record->mRecord.load(esm);
+
+        return record.release();
+    }
+    template<typename T>
+    bool Store<T>::loadStaged(StagedRecord &record)
+    {
+        T &parsed = static_cast<StagedRecordData<T> &>(record).mRecord;
+
+        // load() reads a record on top of an earlier record with the same ID, so only new IDs can
+        // use a record that has been parsed from scratch
+        if (mStatic.find(parsed.mId) != mStatic.end())
+            return false;
+
+        std::pair<typename Static::iterator, bool> inserted = mStatic.insert(std::make_pair(parsed.mId, parsed));
+        mShared.push_back(&inserted.first->second);
+
+        return true;
+    }
+    template<typename T>
     void Store<T>::setUp()
     {
     }
@@ -1025,6 +1051,12 @@ namespace MWWorld
         it->second.load(esm);
     }
 
+    template <>
+    inline StagedRecord *Store<ESM::Dialogue>::parse(ESM::ESMReader &esm, const std::string &id) const {
+        // INFO records need to be attached to the dialogue loaded before them
+        return 0;
+    }
+
 
     // Script
     //=========================================================================
@@ -1042,6 +1074,29 @@ namespace MWWorld
             inserted.first->second = scpt;
     }
 
+    template <>
+    inline StagedRecord *Store<ESM::Script>::parse(ESM::ESMReader &esm, const std::string &id) const {
+        std::auto_ptr<StagedRecordData<ESM::Script> > record(new StagedRecordData<ESM::Script>);
+
+        record->mRecord.load(esm);
+        Misc::StringUtils::toLower(record->mRecord.mId);
+
+        return record.release();
+    }
+
+    template <>
+    inline bool Store<ESM::Script>::loadStaged(StagedRecord &record) {
+        const ESM::Script &scpt = static_cast<StagedRecordData<ESM::Script> &>(record).mRecord;
+
+        std::pair<Static::iterator, bool> inserted = mStatic.insert(std::make_pair(scpt.mId, scpt));
+        if (inserted.second)
+            mShared.push_back(&inserted.first->second);
+        else
+            inserted.first->second = scpt;
+
+        return true;
+    }
+
 
     // StartScript
     //=========================================================================
@@ -1058,6 +1113,31 @@ namespace MWWorld
         else
             inserted.first->second = s;
     }
+
+    template <>
+    inline StagedRecord *Store<ESM::StartScript>::parse(ESM::ESMReader &esm, const std::string &id) const
+    {
+        std::auto_ptr<StagedRecordData<ESM::StartScript> > record(new StagedRecordData<ESM::StartScript>);
+
+        record->mRecord.load(esm);
+        record->mRecord.mId = Misc::StringUtils::toLower(record->mRecord.mId);
+
+        return record.release();
+    }
+
+    template <>
+    inline bool Store<ESM::StartScript>::loadStaged(StagedRecord &record)
+    {
+        const ESM::StartScript &s = static_cast<StagedRecordData<ESM::StartScript> &>(record).mRecord;
+
+        std::pair<Static::iterator, bool> inserted = mStatic.insert(std::make_pair(s.mId, s));
+        if (inserted.second)
+            mShared.push_back(&inserted.first->second);
+        else
+            inserted.first->second = s;
+
+        return true;
+    }
 }
 
 template class MWWorld::Store<ESM::Activator>;
@@ -19,6 +19,22 @@ namespace Loading
 
 namespace MWWorld
 {
+    /// \brief Record that has been parsed ahead of time, but not been inserted into its store yet
+    struct StagedRecord
+    {
+        std::string mId; ///< ID as read from the NAME sub-record
+
+        virtual ~StagedRecord() {}
+    };
+
+    template <class T>
+    struct StagedRecordData : public StagedRecord
+    {
+        T mRecord;
+
+        StagedRecordData() : mRecord() {}
+    };
+
     struct StoreBase
     {
         virtual ~StoreBase() {}
@@ -30,6 +46,17 @@ namespace MWWorld
         virtual int getDynamicSize() const { return 0; }
         virtual void load(ESM::ESMReader &esm, const std::string &id) = 0;
 
+        virtual StagedRecord *parse(ESM::ESMReader &esm, const std::string &id) const { return 0; }
+        ///< Parse a record without accessing the store, so it can be done on a worker thread.
+        ///
+        /// \return A record for loadStaged() or 0, if records of this type can only be loaded in
+        /// order via load(). In that case nothing is read from \a esm.
+
+        virtual bool loadStaged(StagedRecord &record) { return false; }
+        ///< Insert a record returned by parse().
+        ///
+        /// \return Could the record be inserted? If not, it must be loaded via load() instead.
+
         virtual bool eraseStatic(const std::string &id) {return false;}
         virtual void clearDynamic() {}
 
@@ -181,6 +208,8 @@ namespace MWWorld
         bool erase(const T &item);
 
         void load(ESM::ESMReader &esm, const std::string &id);
+        StagedRecord *parse(ESM::ESMReader &esm, const std::string &id) const;
+        bool loadStaged(StagedRecord &record);
         void write(ESM::ESMWriter& writer, Loading::Listener& progress) const;
         void read(ESM::ESMReader& reader, const std::string& id);
     };
@@ -92,6 +92,13 @@ namespace MWWorld
             return mLoaders.insert(std::make_pair(extension, loader)).second;
         }
 
+        void prepare(const boost::filesystem::path& filepath, int index)
+        {
+            LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
+            if (it != mLoaders.end())
+                it->second->prepare(filepath, index);
+        }
+
         void load(const boost::filesystem::path& filepath, int& index)
         {
             LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
@@ -153,7 +160,8 @@ namespace MWWorld
         const Files::Collections& fileCollections,
         const std::vector<std::string>& contentFiles,
         ToUTF8::Utf8Encoder* encoder, const std::map<std::string,std::string>& fallbackMap,
-        int activationDistanceOverride, const std::string& startCell, const std::string& startupScript)
+        int activationDistanceOverride, const std::string& startCell, const std::string& startupScript,
+        const std::string& cachePath)
     : mResourceSystem(resourceSystem), mFallback(fallbackMap), mPlayer (0), mLocalScripts (mStore),
       mSky (true), mCells (mStore, mEsm),
       mGodMode(false), mScriptsEnabled(true), mContentFiles (contentFiles),
@@ -163,7 +171,7 @@ namespace MWWorld
     {
         mPhysics = new MWPhysics::PhysicsSystem(resourceSystem, rootNode);
         mProjectileManager.reset(new ProjectileManager(rootNode, resourceSystem, mPhysics));
-        mRendering = new MWRender::RenderingManager(viewer, rootNode, resourceSystem, &mFallback);
+        mRendering = new MWRender::RenderingManager(viewer, rootNode, resourceSystem, &mFallback, cachePath);
 
         mEsm.resize(contentFiles.size());
         Loading::Listener* listener = MWBase::Environment::get().getWindowManager()->getLoadingScreen();
@@ -2540,6 +2548,8 @@ namespace MWWorld
     void World::loadContentFiles(const Files::Collections& fileCollections,
         const std::vector<std::string>& content, ContentLoader& contentLoader)
     {
+        std::vector<boost::filesystem::path> paths;
+
         std::vector<std::string>::const_iterator it(content.begin());
         std::vector<std::string>::const_iterator end(content.end());
         for (int idx = 0; it != end; ++it, ++idx)
@@ -2548,7 +2558,8 @@ namespace MWWorld
             const Files::MultiDirCollection& col = fileCollections.getCollection(filename.extension().string());
             if (col.doesExist(*it))
             {
-                contentLoader.load(col.getPath(*it), idx);
+                paths.push_back(col.getPath(*it));
+                contentLoader.prepare(paths.back(), idx);
             }
             else
             {
@@ -2557,6 +2568,9 @@ namespace MWWorld
                 throw std::runtime_error(msg.str());
             }
         }
+
+        for (int idx = 0; idx < static_cast<int>(paths.size()); ++idx)
+            contentLoader.load(paths[idx], idx);
     }
 
     bool World::startSpellCast(const Ptr &actor)
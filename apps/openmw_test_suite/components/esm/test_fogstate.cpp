@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "components/esm/fogstate.hpp"
+
+#include <vector>
+
+struct FogStateTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    static std::vector<unsigned char> roundTrip (const std::vector<unsigned char>& data)
+    {
+        ESM::FogTexture texture;
+        texture.setMask (data.empty() ? 0 : &data[0], data.size());
+
+        std::vector<unsigned char> decoded (data.size(), 0x42);
+        EXPECT_TRUE(texture.getMask (decoded.empty() ? 0 : &decoded[0], decoded.size()));
+        return decoded;
+    }
+
+    static std::size_t encodedSize (const std::vector<unsigned char>& data)
+    {
+        ESM::FogTexture texture;
+        texture.setMask (data.empty() ? 0 : &data[0], data.size());
+        return texture.mMask.size();
+    }
+};
+
+TEST_F(FogStateTest, empty_mask)
+{
+    std::vector<unsigned char> data;
+    ASSERT_EQ(data, roundTrip (data));
+    ASSERT_EQ(0u, encodedSize (data));
+}
+
+TEST_F(FogStateTest, unexplored_mask)
+{
+    std::vector<unsigned char> data (32*32, 255);
+    ASSERT_EQ(data, roundTrip (data));
+    // runs of up to 256 bytes
+    ASSERT_EQ(8u, encodedSize (data));
+}
+
+TEST_F(FogStateTest, explored_mask)
+{
+    std::vector<unsigned char> data (32*32, 0);
+    ASSERT_EQ(data, roundTrip (data));
+}
+
+TEST_F(FogStateTest, alternating_mask)
+{
+    std::vector<unsigned char> data (32*32);
+    for (std::size_t i=0; i<data.size(); ++i)
+        data[i] = i%2 ? 255 : 0;
+
+    ASSERT_EQ(data, roundTrip (data));
+}
+
+TEST_F(FogStateTest, gradient_mask_is_quantized)
+{
+    std::vector<unsigned char> data (256);
+    for (std::size_t i=0; i<data.size(); ++i)
+        data[i] = static_cast<unsigned char>(i);
+
+    std::vector<unsigned char> decoded = roundTrip (data);
+
+    for (std::size_t i=0; i<data.size(); ++i)
+    {
+        EXPECT_EQ(ESM::FogTexture::quantize (data[i]), decoded[i]);
+        // never reveals more than 7 levels, and keeps thresholds that are multiples of 8
+        EXPECT_LE(data[i] - decoded[i], 7);
+        EXPECT_EQ(data[i] < 200, decoded[i] < 200);
+    }
+
+    // 31 levels of 8 values each, and 255
+    ASSERT_EQ(32u * 2, encodedSize (data));
+}
+
+TEST_F(FogStateTest, unexplored_values_stay_unexplored)
+{
+    for (int value=248; value<256; ++value)
+        ASSERT_EQ(255, ESM::FogTexture::quantize (static_cast<unsigned char>(value)));
+    ASSERT_EQ(0, ESM::FogTexture::quantize (0));
+}
+
+TEST_F(FogStateTest, truncated_mask_is_rejected)
+{
+    std::vector<unsigned char> data (32*32, 255);
+
+    ESM::FogTexture texture;
+    texture.setMask (&data[0], data.size());
+    texture.mMask.pop_back();
+
+    ASSERT_FALSE(texture.getMask (&data[0], data.size()));
+}
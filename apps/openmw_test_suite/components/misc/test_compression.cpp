@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "components/misc/compression.hpp"
+
+#include <stdexcept>
+#include <string>
+
+struct CompressionTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    static std::string roundTrip (const std::string& data)
+    {
+        std::vector<char> compressed;
+        Misc::Compression::compress (data.data(), data.size(), compressed);
+
+        std::vector<char> decompressed;
+        Misc::Compression::decompress (compressed.empty() ? 0 : &compressed[0], compressed.size(), data.size(),
+            decompressed);
+
+        return std::string (decompressed.begin(), decompressed.end());
+    }
+};
+
+TEST_F(CompressionTest, empty_data)
+{
+    ASSERT_EQ("", roundTrip (""));
+}
+
+TEST_F(CompressionTest, text_data)
+{
+    std::string data = "The quick brown fox jumps over the lazy dog";
+    ASSERT_EQ(data, roundTrip (data));
+}
+
+TEST_F(CompressionTest, binary_data)
+{
+    std::string data;
+    for (int i=0; i<1000; ++i)
+        data += static_cast<char> ((i * 7919) % 256);
+
+    ASSERT_EQ(data, roundTrip (data));
+}
+
+TEST_F(CompressionTest, repetitive_data_shrinks)
+{
+    std::string data (100000, 'x');
+
+    std::vector<char> compressed;
+    Misc::Compression::compress (data.data(), data.size(), compressed);
+
+    ASSERT_LT(compressed.size(), data.size() / 10);
+    ASSERT_EQ(data, roundTrip (data));
+}
+
+TEST_F(CompressionTest, corrupted_data_throws)
+{
+    std::string data (1000, 'x');
+
+    std::vector<char> compressed;
+    Misc::Compression::compress (data.data(), data.size(), compressed);
+
+    for (std::size_t i=0; i<compressed.size(); ++i)
+        compressed[i] = static_cast<char> (~compressed[i]);
+
+    std::vector<char> decompressed;
+    ASSERT_THROW(Misc::Compression::decompress (&compressed[0], compressed.size(), data.size(), decompressed),
+        std::runtime_error);
+}
+
+TEST_F(CompressionTest, wrong_size_throws)
+{
+    std::string data (1000, 'x');
+
+    std::vector<char> compressed;
+    Misc::Compression::compress (data.data(), data.size(), compressed);
+
+    std::vector<char> decompressed;
+    ASSERT_THROW(Misc::Compression::decompress (&compressed[0], compressed.size(), data.size() - 1, decompressed),
+        std::runtime_error);
+    ASSERT_THROW(Misc::Compression::decompress (&compressed[0], compressed.size(), data.size() + 1, decompressed),
+        std::runtime_error);
+}
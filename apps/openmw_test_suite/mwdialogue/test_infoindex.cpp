@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <components/esm/loaddial.hpp>
+
+#include "apps/openmw/mwdialogue/infoindex.hpp"
+
+struct InfoIndexTest : public ::testing::Test
+{
+  protected:
+    ESM::Dialogue mDialogue;
+    MWDialogue::InfoIndex mIndex;
+
+    virtual void SetUp()
+    {
+        mDialogue.mId = "Greeting 0";
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    void addInfo (const std::string& id, const std::string& actor, const std::string& race,
+        const std::string& class_, const std::string& faction)
+    {
+        ESM::DialInfo info;
+        info.mId = id;
+        info.mActor = actor;
+        info.mRace = race;
+        info.mClass = class_;
+        info.mFaction = faction;
+        mDialogue.mInfo.push_back (info);
+    }
+
+    std::vector<std::string> getCandidateIds (const MWDialogue::InfoIndex::ActorKey& actor) const
+    {
+        std::vector<std::string> ids;
+
+        const std::vector<const MWDialogue::InfoIndex::Info *> *candidates =
+            mIndex.getCandidates (mDialogue, actor);
+
+        if (candidates)
+            for (std::vector<const MWDialogue::InfoIndex::Info *>::const_iterator iter (candidates->begin());
+                iter!=candidates->end(); ++iter)
+                ids.push_back ((*iter)->mInfo->mId);
+
+        return ids;
+    }
+};
+
+TEST_F(InfoIndexTest, candidates_keep_info_order)
+{
+    addInfo ("faction", "", "", "", "Mages Guild");
+    addInfo ("actor", "fargoth", "", "", "");
+    addInfo ("generic", "", "", "", "");
+    addInfo ("race", "", "Wood Elf", "", "");
+    addInfo ("class", "", "", "Commoner", "");
+    mIndex.addTopic (mDialogue);
+
+    MWDialogue::InfoIndex::ActorKey actor =
+        mIndex.getActorKey ("Fargoth", false, "wood elf", "commoner", "mages guild");
+
+    std::vector<std::string> ids = getCandidateIds (actor);
+
+    ASSERT_EQ (5u, ids.size());
+    EXPECT_EQ ("faction", ids[0]);
+    EXPECT_EQ ("actor", ids[1]);
+    EXPECT_EQ ("generic", ids[2]);
+    EXPECT_EQ ("race", ids[3]);
+    EXPECT_EQ ("class", ids[4]);
+}
+
+TEST_F(InfoIndexTest, candidates_must_match_all_discriminators)
+{
+    addInfo ("other actor", "hlaalu_guard", "", "", "");
+    addInfo ("race and class", "", "wood elf", "guard", "");
+    addInfo ("race and faction", "", "wood elf", "", "mages guild");
+    addInfo ("race", "", "wood elf", "", "");
+    addInfo ("other race", "", "dark elf", "", "");
+    mIndex.addTopic (mDialogue);
+
+    MWDialogue::InfoIndex::ActorKey actor =
+        mIndex.getActorKey ("fargoth", false, "wood elf", "commoner", "mages guild");
+
+    std::vector<std::string> ids = getCandidateIds (actor);
+
+    ASSERT_EQ (2u, ids.size());
+    EXPECT_EQ ("race and faction", ids[0]);
+    EXPECT_EQ ("race", ids[1]);
+}
+
+TEST_F(InfoIndexTest, creatures_only_get_infos_for_their_id)
+{
+    addInfo ("generic", "", "", "", "");
+    addInfo ("creature", "mudcrab", "", "", "");
+    addInfo ("other creature", "scamp", "", "", "");
+    mIndex.addTopic (mDialogue);
+
+    // race, class and faction are ignored for creatures
+    MWDialogue::InfoIndex::ActorKey actor = mIndex.getActorKey ("mudcrab", true, "", "", "");
+
+    std::vector<std::string> ids = getCandidateIds (actor);
+
+    ASSERT_EQ (1u, ids.size());
+    EXPECT_EQ ("creature", ids[0]);
+}
+
+TEST_F(InfoIndexTest, unindexed_dialogue_has_no_candidates)
+{
+    addInfo ("generic", "", "", "", "");
+
+    MWDialogue::InfoIndex::ActorKey actor = mIndex.getActorKey ("fargoth", false, "", "", "");
+
+    EXPECT_TRUE (mIndex.getCandidates (mDialogue, actor)==0);
+
+    mIndex.addTopic (mDialogue);
+    EXPECT_TRUE (mIndex.getCandidates (mDialogue, actor)!=0);
+
+    // a dialogue that changed after it was indexed must not be looked up in the stale index
+    addInfo ("added", "", "", "", "");
+    EXPECT_TRUE (mIndex.getCandidates (mDialogue, actor)==0);
+
+    mIndex.clear();
+    mDialogue.mInfo.pop_back();
+    EXPECT_TRUE (mIndex.getCandidates (mDialogue, actor)==0);
+}
+
+TEST_F(InfoIndexTest, candidate_buffer_is_reused)
+{
+    addInfo ("generic", "", "", "", "");
+    addInfo ("actor", "fargoth", "", "", "");
+    mIndex.addTopic (mDialogue);
+
+    const std::vector<const MWDialogue::InfoIndex::Info *> *first =
+        mIndex.getCandidates (mDialogue, mIndex.getActorKey ("fargoth", false, "", "", ""));
+
+    ASSERT_TRUE (first!=0);
+    EXPECT_EQ (2u, first->size());
+
+    const std::vector<const MWDialogue::InfoIndex::Info *> *second =
+        mIndex.getCandidates (mDialogue, mIndex.getActorKey ("mudcrab", true, "", "", ""));
+
+    EXPECT_EQ (first, second);
+    EXPECT_EQ (0u, second->size());
+}
+
+TEST_F(InfoIndexTest, ids_are_interned_case_insensitive)
+{
+    addInfo ("actor", "Fargoth", "Wood Elf", "", "");
+    mIndex.addTopic (mDialogue);
+
+    EXPECT_NE (-1, mIndex.lookup ("fargoth"));
+    EXPECT_EQ (mIndex.lookup ("fargoth"), mIndex.lookup ("FARGOTH"));
+    EXPECT_NE (mIndex.lookup ("fargoth"), mIndex.lookup ("wood elf"));
+    EXPECT_EQ (-1, mIndex.lookup ("mudcrab"));
+    EXPECT_EQ (-1, mIndex.lookup (""));
+}
+
+TEST_F(InfoIndexTest, not_id_select_names_are_interned)
+{
+    addInfo ("not fargoth", "", "", "", "");
+
+    ESM::DialInfo::SelectStruct select;
+    select.mSelectRule = "07XX0Fargoth";
+    mDialogue.mInfo.back().mSelects.push_back (select);
+
+    mIndex.addTopic (mDialogue);
+
+    const std::vector<const MWDialogue::InfoIndex::Info *> *candidates =
+        mIndex.getCandidates (mDialogue, mIndex.getActorKey ("fargoth", false, "", "", ""));
+
+    ASSERT_TRUE (candidates!=0);
+    ASSERT_EQ (1u, candidates->size());
+    ASSERT_EQ (1u, (*candidates)[0]->mSelects.size());
+    EXPECT_EQ (mIndex.lookup ("fargoth"), (*candidates)[0]->mSelects[0].getNameId());
+    EXPECT_NE (-1, (*candidates)[0]->mSelects[0].getNameId());
+}
@@ -65,3 +65,63 @@ TEST_F(KeywordSearchTest, keyword_test_conflict_resolution3)
     ASSERT_TRUE (matches.size() == 1);
     ASSERT_TRUE (std::string(matches.front().mBeg, matches.front().mEnd) == "bar lock");
 }
+
+TEST_F(KeywordSearchTest, keyword_test_prefix)
+{
+    // keywords that are prefixes of other keywords must still be found
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("dwemer ruins", 1);
+    search.seed("dwemer", 0);
+
+    std::string text = "dwemer artifacts from the dwemer ruins";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+
+    ASSERT_TRUE (matches.size() == 2);
+    ASSERT_TRUE (std::string(matches.front().mBeg, matches.front().mEnd) == "dwemer");
+    ASSERT_TRUE (matches.front().mValue == 0);
+    ASSERT_TRUE (std::string(matches.rbegin()->mBeg, matches.rbegin()->mEnd) == "dwemer ruins");
+    ASSERT_TRUE (matches.rbegin()->mValue == 1);
+}
+
+TEST_F(KeywordSearchTest, keyword_test_word_start)
+{
+    // keywords only match at the beginning of a word, and are matched case-insensitively
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("ash", 0);
+
+    std::string text = "Ashlands, trash, ash";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+
+    ASSERT_TRUE (matches.size() == 2);
+    ASSERT_TRUE (matches.front().mBeg == text.begin());
+    ASSERT_TRUE (std::string(matches.rbegin()->mBeg, matches.rbegin()->mEnd) == "ash");
+    ASSERT_TRUE (matches.rbegin()->mEnd == text.end());
+}
+
+TEST_F(KeywordSearchTest, keyword_test_seed_after_search)
+{
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("vivec", 0);
+
+    std::string text = "vivec and almalexia";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+    ASSERT_TRUE (matches.size() == 1);
+
+    search.seed("almalexia", 1);
+
+    matches.clear();
+    search.highlightKeywords(text.begin(), text.end(), matches);
+    ASSERT_TRUE (matches.size() == 2);
+    ASSERT_TRUE (std::string(matches.rbegin()->mBeg, matches.rbegin()->mEnd) == "almalexia");
+
+    int value = -1;
+    ASSERT_TRUE (search.containsKeyword("Almalexia", value));
+    ASSERT_TRUE (value == 1);
+    ASSERT_FALSE (search.containsKeyword("almalexi", value));
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "apps/openmw/mwdialogue/keywordsearch.hpp"
+
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    std::string makeWord (int index)
+    {
+        // deterministic pseudo-words, so that keywords share prefixes like real topic names do
+        static const char* syllables[] = { "ald", "vel", "ra", "mor", "dun", "ash", "ka", "thi", "ur", "sar" };
+
+        std::string word;
+        do
+        {
+            word += syllables[index % 10];
+            index /= 10;
+        }
+        while (index > 0);
+
+        return word;
+    }
+}
+
+struct KeywordSearchBenchmark : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        // a few thousand known topics, some of them spanning several words
+        for (int i=0; i<4000; ++i)
+        {
+            std::string keyword = makeWord (i);
+            if (i % 3 == 0)
+                keyword += " " + makeWord (i * 7 + 1);
+            mSearch.seed (keyword, i);
+        }
+
+        // roughly the size of a long journal
+        std::ostringstream stream;
+        for (int i=0; i<100000; ++i)
+            stream << makeWord ((i * 7919) % 20000) << ((i % 13 == 0) ? ". " : " ");
+        mText = stream.str();
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    MWDialogue::KeywordSearch<std::string, int> mSearch;
+    std::string mText;
+};
+
+// disabled so it does not slow down the regular test run, use --gtest_also_run_disabled_tests to run it
+TEST_F(KeywordSearchBenchmark, DISABLED_highlight_long_text)
+{
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+
+    std::clock_t start = std::clock();
+
+    const int runs = 5;
+    for (int i=0; i<runs; ++i)
+    {
+        matches.clear();
+        mSearch.highlightKeywords (mText.begin(), mText.end(), matches);
+    }
+
+    double seconds = double (std::clock() - start) / CLOCKS_PER_SEC;
+
+    std::cout << "[ BENCHMARK] " << mText.size() << " bytes, " << matches.size() << " matches: "
+              << (seconds / runs * 1000.0) << " ms per run" << std::endl;
+
+    ASSERT_FALSE (matches.empty());
+
+    // matches must be sorted and must not overlap
+    for (size_t i=1; i<matches.size(); ++i)
+        ASSERT_TRUE (matches[i-1].mEnd <= matches[i].mBeg);
+}
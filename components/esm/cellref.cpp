@@ -102,52 +102,52 @@ void ESM::CellRef::save (ESMWriter &esm, bool wideRefNum, bool inInventory) cons
 {
     mRefNum.save (esm, wideRefNum);
 
-    esm.writeHNCString("NAME", mRefID);
+    esm.writeHNCString(FourCC<'N','A','M','E'>::value, mRefID);
 
     if (mScale != 1.0) {
-        esm.writeHNT("XSCL", mScale);
+        esm.writeHNT(FourCC<'X','S','C','L'>::value, mScale);
     }
 
-    esm.writeHNOCString("ANAM", mOwner);
-    esm.writeHNOCString("BNAM", mGlobalVariable);
-    esm.writeHNOCString("XSOL", mSoul);
+    esm.writeHNOCString(FourCC<'A','N','A','M'>::value, mOwner);
+    esm.writeHNOCString(FourCC<'B','N','A','M'>::value, mGlobalVariable);
+    esm.writeHNOCString(FourCC<'X','S','O','L'>::value, mSoul);
 
-    esm.writeHNOCString("CNAM", mFaction);
+    esm.writeHNOCString(FourCC<'C','N','A','M'>::value, mFaction);
     if (mFactionRank != -2) {
-        esm.writeHNT("INDX", mFactionRank);
+        esm.writeHNT(FourCC<'I','N','D','X'>::value, mFactionRank);
     }
 
     if (mEnchantmentCharge != -1)
-        esm.writeHNT("XCHG", mEnchantmentCharge);
+        esm.writeHNT(FourCC<'X','C','H','G'>::value, mEnchantmentCharge);
 
     if (mChargeInt != -1)
-        esm.writeHNT("INTV", mChargeInt);
+        esm.writeHNT(FourCC<'I','N','T','V'>::value, mChargeInt);
 
     if (mGoldValue != 1) {
-        esm.writeHNT("NAM9", mGoldValue);
+        esm.writeHNT(FourCC<'N','A','M','9'>::value, mGoldValue);
     }
 
     if (!inInventory && mTeleport)
     {
-        esm.writeHNT("DODT", mDoorDest);
-        esm.writeHNOCString("DNAM", mDestCell);
+        esm.writeHNT(FourCC<'D','O','D','T'>::value, mDoorDest);
+        esm.writeHNOCString(FourCC<'D','N','A','M'>::value, mDestCell);
     }
 
     if (!inInventory && mLockLevel != 0) {
-            esm.writeHNT("FLTV", mLockLevel);
+            esm.writeHNT(FourCC<'F','L','T','V'>::value, mLockLevel);
     }
 
     if (!inInventory)
-        esm.writeHNOCString ("KNAM", mKey);
+        esm.writeHNOCString (FourCC<'K','N','A','M'>::value, mKey);
 
     if (!inInventory)
-        esm.writeHNOCString ("TNAM", mTrap);
+        esm.writeHNOCString (FourCC<'T','N','A','M'>::value, mTrap);
 
     if (mReferenceBlocked != -1)
-        esm.writeHNT("UNAM", mReferenceBlocked);
+        esm.writeHNT(FourCC<'U','N','A','M'>::value, mReferenceBlocked);
 
     if (!inInventory)
-        esm.writeHNT("DATA", mPos, 24);
+        esm.writeHNT(FourCC<'D','A','T','A'>::value, mPos, 24);
 }
 
 void ESM::CellRef::blank()
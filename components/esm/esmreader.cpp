@@ -15,7 +15,7 @@ using namespace Misc;
 ESM_Context ESMReader::getContext()
 {
     // Update the file position before returning
-    mCtx.filePos = mEsm->tellg();
+    mCtx.filePos = getFileOffset();
     return mCtx;
 }
 
@@ -26,6 +26,11 @@ ESMReader::ESMReader()
     , mGlobalReaderList(NULL)
     , mEncoder(NULL)
     , mFileSize(0)
+    , mRecordPos(0)
+    , mRecordOffset(0)
+    , mRecordBuffered(false)
+    , mRecordPending(false)
+    , mRecordPendingSize(0)
 {
 }
 
@@ -34,6 +39,11 @@ int ESMReader::getFormat() const
     return mHeader.mFormat;
 }
 
+void ESMReader::setFormat(int format)
+{
+    mHeader.mFormat = format;
+}
+
 void ESMReader::restoreContext(const ESM_Context &rc)
 {
     // Reopen the file if necessary
@@ -44,12 +54,19 @@ void ESMReader::restoreContext(const ESM_Context &rc)
     mCtx = rc;
 
     // Make sure we seek to the right place
+    mRecordBuffered = false;
+    mRecordPending = false;
     mEsm->seekg(mCtx.filePos);
+
+    // Contexts usually point into a record (e.g. the references of a cell), so buffer the rest of it
+    bufferRecord(mCtx.leftRec);
 }
 
 void ESMReader::close()
 {
     mEsm.reset();
+    mRecordBuffered = false;
+    mRecordPending = false;
     mCtx.filename.clear();
     mCtx.leftFile = 0;
     mCtx.leftRec = 0;
@@ -272,6 +289,25 @@ NAME ESMReader::getRecName()
     return mCtx.recName;
 }
 
+void ESMReader::getRecordData(std::vector<char> &data)
+{
+    data.clear();
+
+    if (mCtx.subCached)
+    {
+        data.insert(data.end(), mCtx.subName.name, mCtx.subName.name+4);
+        mCtx.subCached = false;
+    }
+
+    std::size_t offset = data.size();
+    data.resize(offset + mCtx.leftRec);
+
+    if (mCtx.leftRec)
+        getExact(&data[offset], mCtx.leftRec);
+
+    mCtx.leftRec = 0;
+}
+
 void ESMReader::skipRecord()
 {
     skip(mCtx.leftRec);
@@ -297,6 +333,81 @@ void ESMReader::getRecHeader(uint32_t &flags)
 
     // Adjust number of bytes mCtx.left in file
     mCtx.leftFile -= mCtx.leftRec;
+
+    // The record is buffered on the first read, so that skipped records are not read at all
+    mRecordPending = true;
+    mRecordPendingSize = mCtx.leftRec;
+}
+
+void ESMReader::bufferRecord(size_t size)
+{
+    mRecordBuffered = false;
+    mRecordPending = false;
+    mRecordOffset = mEsm->tellg();
+    mRecordPos = 0;
+    mRecordBuffer.resize(size);
+
+    if (!mRecordBuffer.empty())
+        getExact(&mRecordBuffer[0], mRecordBuffer.size());
+
+    mRecordBuffered = true;
+}
+
+void ESMReader::unbufferRecord()
+{
+    if (!mRecordBuffered)
+        return;
+
+    mRecordBuffered = false;
+
+    // The stream is at the end of the record, unless it has not been read completely
+    if (mRecordPos != mRecordBuffer.size())
+        mEsm->seekg(mRecordOffset + mRecordPos);
+}
+
+void ESMReader::getSubRecordView(SubRecordView &view)
+{
+    getSubName();
+    getSubHeader();
+
+    view.mName = mCtx.subName;
+    view.mSize = mCtx.leftSub;
+
+    if (mRecordBuffered && mRecordPos + view.mSize <= mRecordBuffer.size())
+    {
+        view.mData = view.mSize ? &mRecordBuffer[mRecordPos] : 0;
+        mRecordPos += view.mSize;
+    }
+    else
+    {
+        if (mBuffer.size() < view.mSize)
+            mBuffer.resize(view.mSize);
+
+        if (view.mSize)
+            getExact(&mBuffer[0], view.mSize);
+
+        view.mData = &mBuffer[0];
+    }
+}
+
+std::string ESMReader::getString(const SubRecordView &view)
+{
+    if (!view.mSize)
+    {
+        // Skip the zero byte following empty strings (see getHString)
+        mCtx.leftRec--;
+        char c;
+        getExact(&c, 1);
+        return "";
+    }
+
+    size_t size = strnlen(view.mData, view.mSize);
+
+    // Convert to UTF8 and return
+    if (mEncoder)
+        return mEncoder->getUtf8(view.mData, size);
+
+    return std::string(view.mData, size);
 }
 
 /*************************************************************************
@@ -307,6 +418,22 @@ void ESMReader::getRecHeader(uint32_t &flags)
 
 void ESMReader::getExact(void*x, int size)
 {
+    if (mRecordPending)
+        bufferRecord(mRecordPendingSize);
+
+    if (mRecordBuffered)
+    {
+        if (mRecordPos + size <= mRecordBuffer.size())
+        {
+            memcpy(x, &mRecordBuffer[mRecordPos], size);
+            mRecordPos += size;
+            return;
+        }
+
+        // Reading beyond the buffered record, e.g. the next record header
+        unbufferRecord();
+    }
+
     try
     {
         mEsm->read((char*)x, size);
@@ -319,6 +446,23 @@ void ESMReader::getExact(void*x, int size)
 
 std::string ESMReader::getString(int size)
 {
+    if (mRecordPending)
+        bufferRecord(mRecordPendingSize);
+
+    // Convert straight from the record buffer, if possible
+    if (mRecordBuffered && mRecordPos + size <= mRecordBuffer.size())
+    {
+        const char *ptr = size ? &mRecordBuffer[mRecordPos] : "";
+        mRecordPos += size;
+
+        size = strnlen(ptr, size);
+
+        if (mEncoder)
+            return mEncoder->getUtf8(ptr, size);
+
+        return std::string (ptr, size);
+    }
+
     size_t s = size;
     if (mBuffer.size() <= s)
         // Add some extra padding to reduce the chance of having to resize
@@ -352,7 +496,7 @@ void ESMReader::fail(const std::string &msg)
     ss << "\n  Record: " << mCtx.recName.toString();
     ss << "\n  Subrecord: " << mCtx.subName.toString();
     if (mEsm.get())
-        ss << "\n  Offset: 0x" << hex << mEsm->tellg();
+        ss << "\n  Offset: 0x" << hex << getFileOffset();
     throw std::runtime_error(ss.str());
 }
 
@@ -363,11 +507,33 @@ void ESMReader::setEncoder(ToUTF8::Utf8Encoder* encoder)
 
 size_t ESMReader::getFileOffset()
 {
+    if (mRecordBuffered)
+        return mRecordOffset + mRecordPos;
+
     return mEsm->tellg();
 }
 
 void ESMReader::skip(int bytes)
 {
+    if (mRecordPending)
+    {
+        // skip in the stream and buffer only what is left of the record, if anything is read from it at all
+        if (static_cast<size_t>(bytes) < mRecordPendingSize)
+            mRecordPendingSize -= bytes;
+        else
+            mRecordPending = false;
+    }
+    else if (mRecordBuffered)
+    {
+        if (mRecordPos + bytes <= mRecordBuffer.size())
+        {
+            mRecordPos += bytes;
+            return;
+        }
+
+        unbufferRecord();
+    }
+
     mEsm->seekg(getFileOffset()+bytes);
 }
 
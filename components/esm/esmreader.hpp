@@ -18,6 +18,31 @@
 
 namespace ESM {
 
+/// \brief Name, size and data of a sub-record, as returned by ESMReader::getSubRecordView()
+struct SubRecordView
+{
+    NAME mName;
+    uint32_t mSize;
+    const char *mData; ///< Only valid until the next sub-record is read.
+
+    template <typename X>
+    bool get(X &x) const
+    {
+        if (mSize != sizeof(X))
+            return false;
+
+        memcpy(&x, mData, sizeof(X));
+        return true;
+    }
+    ///< \return false, if the size of the sub-record does not match.
+};
+
+/// \brief Reads ESM and saved game files
+///
+/// Each record is read from the stream in one go, when its data is accessed for the first time
+/// after getRecHeader(); records that are skipped right away are never read. All sub-record
+/// reads are served from that buffer, which avoids the stream overhead for every sub-record
+/// header and value. getSubRecordView() gives access to sub-record data without copying it.
 class ESMReader
 {
 public:
@@ -167,6 +192,26 @@ public:
   // Read the given number of bytes from a named subrecord
   void getHNExact(void*p, int size, const char* name);
 
+  /// Read the next sub-record, including name and header, and point \a view to its data
+  /// instead of copying it.
+  void getSubRecordView(SubRecordView &view);
+
+  /// Convert a string sub-record to UTF-8.
+  /// \note Must be called right after getSubRecordView(), see getHString().
+  std::string getString(const SubRecordView &view);
+
+  /// Decode a sub-record of a fixed size, failing like getHT() if the size does not match.
+  template <typename X>
+  void getT(const SubRecordView &view, X &x)
+  {
+      if (!view.get(x))
+      {
+          std::stringstream error;
+          error << "getT(): subrecord size mismatch (requested " << sizeof(X) << ", got " << view.mSize << ")";
+          fail(error.str());
+      }
+  }
+
   /*************************************************************************
    *
    *  Low level sub-record methods
@@ -234,6 +279,10 @@ public:
   bool hasMoreRecs() const { return mCtx.leftFile > 0; }
   bool hasMoreSubs() const { return mCtx.leftRec > 0; }
 
+  /// Read the remaining sub-records of the current record without interpreting them. A sub-record
+  /// name that has already been cached by isNextSub() is included.
+  void getRecordData(std::vector<char> &data);
+
 
   /*************************************************************************
    *
@@ -263,9 +312,19 @@ public:
   /// Get record flags of last record
   unsigned int getRecordFlags() { return mRecordFlags; }
 
+  /// Override the format from the file header, e.g. for reading a record that has been copied
+  /// out of its file with getRecordData().
+  void setFormat(int format);
+
   size_t getFileSize() const { return mFileSize; }
 
 private:
+  /// Read the next \a size bytes of the current record from the stream.
+  void bufferRecord(size_t size);
+
+  /// Continue reading from the stream instead of the record buffer.
+  void unbufferRecord();
+
   Files::IStreamPtr mEsm;
 
   ESM_Context mCtx;
@@ -284,6 +343,14 @@ private:
 
   size_t mFileSize;
 
+  // Current record, see bufferRecord()
+  std::vector<char> mRecordBuffer;
+  size_t mRecordPos;
+  size_t mRecordOffset; // file offset of mRecordBuffer
+  bool mRecordBuffered;
+  bool mRecordPending; // the record header has been read, but the record has not been buffered yet
+  size_t mRecordPendingSize;
+
 };
 }
 #endif
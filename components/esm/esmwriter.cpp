@@ -1,6 +1,7 @@
 #include "esmwriter.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
 
@@ -12,7 +13,6 @@ namespace ESM
         : mStream(NULL)
         , mEncoder (0)
         , mRecordCount (0)
-        , mCounting (true)
     {}
 
     unsigned int ESMWriter::getVersion() const
@@ -65,10 +65,7 @@ namespace ESM
 
     void ESMWriter::save(std::ostream& file)
     {
-        mRecordCount = 0;
-        mRecords.clear();
-        mCounting = true;
-        mStream = &file;
+        open(file);
 
         startRecord("TES3", 0);
 
@@ -77,40 +74,69 @@ namespace ESM
         endRecord("TES3");
     }
 
+    void ESMWriter::open(std::ostream& file)
+    {
+        mRecordCount = 0;
+        mRecords.clear();
+        mBuffer.clear();
+        mStream = &file;
+    }
+
     void ESMWriter::close()
     {
         if (!mRecords.empty())
             throw std::runtime_error ("Unclosed record remaining");
+
+        flush();
+    }
+
+    void ESMWriter::flush()
+    {
+        if (!mRecords.empty() || mBuffer.empty())
+            return;
+
+        mStream->write (&mBuffer[0], mBuffer.size());
+
+        // keep the capacity, the next records are likely to need it again
+        mBuffer.clear();
+    }
+
+    uint32_t ESMWriter::toName (const std::string& name)
+    {
+        assert (name.size() == 4 && name[3] != '\0');
+
+        uint32_t value = 0;
+        /// \todo make endianess agnostic
+        std::memcpy (&value, name.c_str(), sizeof (value));
+        return value;
     }
 
     void ESMWriter::startRecord(const std::string& name, uint32_t flags)
+    {
+        startRecord (toName (name), flags);
+    }
+
+    void ESMWriter::startRecord (uint32_t name, uint32_t flags)
     {
         mRecordCount++;
 
         writeName(name);
         RecordData rec;
         rec.name = name;
-        rec.position = mStream->tellp();
-        rec.size = 0;
+        rec.position = mBuffer.size();
         writeT<uint32_t>(0); // Size goes here
         writeT<uint32_t>(0); // Unused header?
         writeT(flags);
+        rec.start = mBuffer.size();
         mRecords.push_back(rec);
-
-        assert(mRecords.back().size == 0);
     }
 
-    void ESMWriter::startRecord (uint32_t name, uint32_t flags)
+    void ESMWriter::startSubRecord(const std::string& name)
     {
-        std::string type;
-        for (int i=0; i<4; ++i)
-            /// \todo make endianess agnostic
-            type += reinterpret_cast<const char *> (&name)[i];
-
-        startRecord (type, flags);
+        startSubRecord (toName (name));
     }
 
-    void ESMWriter::startSubRecord(const std::string& name)
+    void ESMWriter::startSubRecord (uint32_t name)
     {
         // Sub-record hierarchies are not properly supported in ESMReader. This should be fixed later.
         assert (mRecords.size() <= 1);
@@ -118,41 +144,36 @@ namespace ESM
         writeName(name);
         RecordData rec;
         rec.name = name;
-        rec.position = mStream->tellp();
-        rec.size = 0;
+        rec.position = mBuffer.size();
         writeT<uint32_t>(0); // Size goes here
+        rec.start = mBuffer.size();
         mRecords.push_back(rec);
-
-        assert(mRecords.back().size == 0);
     }
 
     void ESMWriter::endRecord(const std::string& name)
+    {
+        endRecord (toName (name));
+    }
+
+    void ESMWriter::endRecord (uint32_t name)
     {
         RecordData rec = mRecords.back();
         assert(rec.name == name);
         mRecords.pop_back();
 
-        mStream->seekp(rec.position);
-
-        mCounting = false;
-        write (reinterpret_cast<const char*> (&rec.size), sizeof(uint32_t));
-        mCounting = true;
-
-        mStream->seekp(0, std::ios::end);
+        uint32_t size = static_cast<uint32_t> (mBuffer.size() - rec.start);
+        std::memcpy (&mBuffer[rec.position], &size, sizeof (size));
 
+        if (mBuffer.size() >= sFlushSize)
+            flush();
     }
 
-    void ESMWriter::endRecord (uint32_t name)
+    void ESMWriter::writeHNString(const std::string& name, const std::string& data)
     {
-        std::string type;
-        for (int i=0; i<4; ++i)
-            /// \todo make endianess agnostic
-            type += reinterpret_cast<const char *> (&name)[i];
-
-        endRecord (type);
+        writeHNString (toName (name), data);
     }
 
-    void ESMWriter::writeHNString(const std::string& name, const std::string& data)
+    void ESMWriter::writeHNString (uint32_t name, const std::string& data)
     {
         startSubRecord(name);
         writeHString(data);
@@ -160,40 +181,44 @@ namespace ESM
     }
 
     void ESMWriter::writeHNString(const std::string& name, const std::string& data, size_t size)
+    {
+        writeHNString (toName (name), data, size);
+    }
+
+    void ESMWriter::writeHNString (uint32_t name, const std::string& data, size_t size)
     {
         assert(data.size() <= size);
         startSubRecord(name);
         writeHString(data);
 
         if (data.size() < size)
-        {
-            for (size_t i = data.size(); i < size; ++i)
-                write("\0",1);
-        }
+            mBuffer.insert (mBuffer.end(), size - data.size(), '\0');
 
         endRecord(name);
     }
 
     void ESMWriter::writeFixedSizeString(const std::string &data, int size)
     {
-        std::string string;
-        if (!data.empty())
-            string = mEncoder ? mEncoder->getLegacyEnc(data) : data;
-        string.resize(size);
-        write(string.c_str(), string.size());
+        std::size_t offset = mBuffer.size();
+
+        if (mEncoder)
+            mEncoder->appendLegacyEnc(data.c_str(), data.size(), mBuffer);
+        else
+            write(data.c_str(), data.size());
+
+        // pad or truncate
+        mBuffer.resize(offset + size, '\0');
     }
 
     void ESMWriter::writeHString(const std::string& data)
     {
         if (data.size() == 0)
             write("\0", 1);
+        else if (mEncoder)
+            // Convert from UTF8 straight into the record buffer
+            mEncoder->appendLegacyEnc(data.c_str(), data.size(), mBuffer);
         else
-        {
-            // Convert to UTF8 and return
-            std::string string = mEncoder ? mEncoder->getLegacyEnc(data) : data;
-
-            write(string.c_str(), string.size());
-        }
+            write(data.c_str(), data.size());
     }
 
     void ESMWriter::writeHCString(const std::string& data)
@@ -209,15 +234,14 @@ namespace ESM
         write(name.c_str(), name.size());
     }
 
-    void ESMWriter::write(const char* data, size_t size)
+    void ESMWriter::writeName (uint32_t name)
     {
-        if (mCounting && !mRecords.empty())
-        {
-            for (std::list<RecordData>::iterator it = mRecords.begin(); it != mRecords.end(); ++it)
-                it->size += size;
-        }
+        writeT (name);
+    }
 
-        mStream->write(data, size);
+    void ESMWriter::write(const char* data, size_t size)
+    {
+        mBuffer.insert (mBuffer.end(), data, data+size);
     }
 
     void ESMWriter::setEncoder(ToUTF8::Utf8Encoder* encoder)
@@ -2,7 +2,7 @@
 #define OPENMW_ESM_WRITER_H
 
 #include <iosfwd>
-#include <list>
+#include <vector>
 
 #include "esmcommon.hpp"
 #include "loadtes3.hpp"
@@ -14,15 +14,23 @@ namespace ToUTF8
 
 namespace ESM {
 
+/// \brief Writes records and sub-records to a stream
+///
+/// Records are assembled in an in-memory buffer, and their sizes are patched in the buffer once
+/// they are complete. The buffer is handed to the stream in large blocks whenever no record is
+/// open, so the stream never has to seek. Call close() or flush() before using the stream.
 class ESMWriter
 {
         struct RecordData
         {
-            std::string name;
-            std::streampos position;
-            uint32_t size;
+            uint32_t name;
+            std::size_t position; // of the size field in the buffer
+            std::size_t start; // of the record data in the buffer
         };
 
+        /// Buffer size above which completed records are passed on to the stream
+        static const std::size_t sFlushSize = 1024*1024;
+
     public:
 
         ESMWriter();
@@ -52,12 +60,30 @@ class ESMWriter
         void save(std::ostream& file);
         ///< Start saving a file by writing the TES3 header.
 
+        void open(std::ostream& file);
+        ///< Start writing records or sub-records to \a file without a TES3 header, e.g. for
+        /// assembling data that is embedded into another record.
+
         void close();
-        ///< \note Does not close the stream.
+        ///< Pass all remaining data on to the stream.
+        ///
+        /// \note Does not close the stream.
+
+        void flush();
+        ///< Pass all completed records on to the stream. Does nothing while a record is open.
+
+        // Sub-record names can be given either as strings or as FourCC integer constants. The
+        // latter avoid constructing a string for every sub-record and should be preferred.
 
         void writeHNString(const std::string& name, const std::string& data);
+        void writeHNString(uint32_t name, const std::string& data);
         void writeHNString(const std::string& name, const std::string& data, size_t size);
+        void writeHNString(uint32_t name, const std::string& data, size_t size);
         void writeHNCString(const std::string& name, const std::string& data)
+        {
+            writeHNCString(toName(name), data);
+        }
+        void writeHNCString(uint32_t name, const std::string& data)
         {
             startSubRecord(name);
             writeHCString(data);
@@ -68,14 +94,30 @@ class ESMWriter
             if (!data.empty())
                 writeHNString(name, data);
         }
+        void writeHNOString(uint32_t name, const std::string& data)
+        {
+            if (!data.empty())
+                writeHNString(name, data);
+        }
         void writeHNOCString(const std::string& name, const std::string& data)
         {
             if (!data.empty())
                 writeHNCString(name, data);
         }
+        void writeHNOCString(uint32_t name, const std::string& data)
+        {
+            if (!data.empty())
+                writeHNCString(name, data);
+        }
 
         template<typename T>
         void writeHNT(const std::string& name, const T& data)
+        {
+            writeHNT(toName(name), data);
+        }
+
+        template<typename T>
+        void writeHNT(uint32_t name, const T& data)
         {
             startSubRecord(name);
             writeT(data);
@@ -89,6 +131,9 @@ private:
         void writeHNT(const std::string &name, std::string data)
         {
         }
+        void writeHNT(uint32_t name, std::string data)
+        {
+        }
         void writeT(const std::string& data)
         {
         }
@@ -96,6 +141,12 @@ public:
 
         template<typename T>
         void writeHNT(const std::string& name, const T& data, int size)
+        {
+            writeHNT(toName(name), data, size);
+        }
+
+        template<typename T>
+        void writeHNT(uint32_t name, const T& data, int size)
         {
             startSubRecord(name);
             writeT(data, size);
@@ -118,21 +169,25 @@ public:
         void startRecord(uint32_t name, uint32_t flags = 0);
         /// @note Sub-record hierarchies are not properly supported in ESMReader. This should be fixed later.
         void startSubRecord(const std::string& name);
+        void startSubRecord(uint32_t name);
         void endRecord(const std::string& name);
         void endRecord(uint32_t name);
         void writeFixedSizeString(const std::string& data, int size);
         void writeHString(const std::string& data);
         void writeHCString(const std::string& data);
         void writeName(const std::string& data);
+        void writeName(uint32_t data);
         void write(const char* data, size_t size);
 
     private:
-        std::list<RecordData> mRecords;
+
+        static uint32_t toName(const std::string& name);
+
+        std::vector<RecordData> mRecords;
+        std::vector<char> mBuffer;
         std::ostream* mStream;
-        std::streampos mHeaderPos;
         ToUTF8::Utf8Encoder* mEncoder;
         int mRecordCount;
-        bool mCounting;
 
         Header mHeader;
     };
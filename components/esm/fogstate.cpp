@@ -1,5 +1,7 @@
 #include "fogstate.hpp"
 
+#include <algorithm>
+
 #include "esmreader.hpp"
 #include "esmwriter.hpp"
 
@@ -7,8 +9,17 @@ void ESM::FogState::load (ESMReader &esm)
 {
     esm.getHNOT(mBounds, "BOUN");
     esm.getHNOT(mNorthMarkerAngle, "ANGL");
-    while (esm.isNextSub("FTEX"))
+    while (true)
     {
+        std::vector<char> FogTexture::*data;
+
+        if (esm.isNextSub("FTEX"))
+            data = &FogTexture::mImageData;
+        else if (esm.isNextSub("FMSK"))
+            data = &FogTexture::mMask;
+        else
+            break;
+
         esm.getSubHeader();
         FogTexture tex;
 
@@ -16,8 +27,9 @@ void ESM::FogState::load (ESMReader &esm)
         esm.getT(tex.mY);
 
         size_t imageSize = esm.getSubSize()-sizeof(int)*2;
-        tex.mImageData.resize(imageSize);
-        esm.getExact(&tex.mImageData[0], imageSize);
+        (tex.*data).resize(imageSize);
+        if (imageSize)
+            esm.getExact(&(tex.*data)[0], imageSize);
         mFogTextures.push_back(tex);
     }
 }
@@ -31,10 +43,60 @@ void ESM::FogState::save (ESMWriter &esm, bool interiorCell) const
     }
     for (std::vector<FogTexture>::const_iterator it = mFogTextures.begin(); it != mFogTextures.end(); ++it)
     {
-        esm.startSubRecord("FTEX");
+        // textures from older saved games that haven't been seen since are kept as they are
+        bool legacy = it->mMask.empty() && !it->mImageData.empty();
+        const std::vector<char>& data = legacy ? it->mImageData : it->mMask;
+        const char *name = legacy ? "FTEX" : "FMSK";
+
+        esm.startSubRecord(name);
         esm.writeT(it->mX);
         esm.writeT(it->mY);
-        esm.write(&it->mImageData[0], it->mImageData.size());
-        esm.endRecord("FTEX");
+        if (!data.empty())
+            esm.write(&data[0], data.size());
+        esm.endRecord(name);
+    }
+}
+
+unsigned char ESM::FogTexture::quantize (unsigned char value)
+{
+    if (value >= 248)
+        return 255;
+    return value & ~7;
+}
+
+void ESM::FogTexture::setMask (const unsigned char *data, std::size_t size)
+{
+    mMask.clear();
+
+    // pairs of run length - 1 and value
+    for (std::size_t i=0; i<size;)
+    {
+        unsigned char value = quantize(data[i]);
+
+        std::size_t run = 1;
+        while (run<256 && i+run<size && quantize(data[i+run])==value)
+            ++run;
+
+        mMask.push_back(static_cast<char>(run-1));
+        mMask.push_back(static_cast<char>(value));
+        i += run;
+    }
+}
+
+bool ESM::FogTexture::getMask (unsigned char *data, std::size_t size) const
+{
+    std::size_t i = 0;
+
+    for (std::vector<char>::const_iterator it = mMask.begin(); it != mMask.end() && it+1 != mMask.end(); it += 2)
+    {
+        std::size_t run = static_cast<unsigned char>(*it) + 1;
+
+        if (i+run > size)
+            return false;
+
+        std::fill(data+i, data+i+run, static_cast<unsigned char>(*(it+1)));
+        i += run;
     }
+
+    return i==size && mMask.size()%2==0;
 }
@@ -1,6 +1,7 @@
 #ifndef OPENMW_ESM_FOGSTATE_H
 #define OPENMW_ESM_FOGSTATE_H
 
+#include <cstddef>
 #include <vector>
 
 namespace ESM
@@ -11,10 +12,29 @@ namespace ESM
     struct FogTexture
     {
         int mX, mY; // Only used for interior cells
+
+        // TGA image, only used by saved games of format 2 and older
         std::vector<char> mImageData;
+
+        // Run-length encoded explored mask, one byte per texel (0: explored, 255: unexplored)
+        std::vector<char> mMask;
+
+        /// Reduce \a value to one of 32 levels, so that the edges of explored areas form runs. Rounds down to a
+        /// multiple of 8, which keeps a value on the same side of any threshold that is a multiple of 8. Fully
+        /// unexplored texels stay 255.
+        static unsigned char quantize (unsigned char value);
+
+        /// Run-length encode \a size bytes from \a data into mMask, quantized.
+        void setMask (const unsigned char *data, std::size_t size);
+
+        /// Decode mMask into \a size bytes at \a data.
+        ///
+        /// \return Does mMask decode to exactly \a size bytes?
+        bool getMask (unsigned char *data, std::size_t size) const;
     };
 
     // format 0, saved games only
+    // format 3: run-length encoded masks (FMSK) instead of TGA images (FTEX)
     // Fog of war state
     struct FogState
     {
@@ -10,20 +10,21 @@ namespace ESM
 
     void Activator::load(ESMReader &esm)
     {
+        SubRecordView sub;
+
         while (esm.hasMoreSubs())
         {
-            esm.getSubName();
-            uint32_t name = esm.retSubName().val;
-            switch (name)
+            esm.getSubRecordView(sub);
+            switch (sub.mName.val)
             {
                 case ESM::FourCC<'M','O','D','L'>::value:
-                    mModel = esm.getHString();
+                    mModel = esm.getString(sub);
                     break;
                 case ESM::FourCC<'F','N','A','M'>::value:
-                    mName = esm.getHString();
+                    mName = esm.getString(sub);
                     break;
                 case ESM::FourCC<'S','C','R','I'>::value:
-                    mScript = esm.getHString();
+                    mScript = esm.getString(sub);
                     break;
                 default:
                     esm.fail("Unknown subrecord");
@@ -12,20 +12,21 @@ namespace ESM
 void BodyPart::load(ESMReader &esm)
 {
     bool hasData = false;
+    SubRecordView sub;
+
     while (esm.hasMoreSubs())
     {
-        esm.getSubName();
-        uint32_t name = esm.retSubName().val;
-        switch (name)
+        esm.getSubRecordView(sub);
+        switch (sub.mName.val)
         {
             case ESM::FourCC<'M','O','D','L'>::value:
-                mModel = esm.getHString();
+                mModel = esm.getString(sub);
                 break;
             case ESM::FourCC<'F','N','A','M'>::value:
-                mRace = esm.getHString();
+                mRace = esm.getString(sub);
                 break;
             case ESM::FourCC<'B','Y','D','T'>::value:
-                esm.getHT(mData, 4);
+                esm.getT(sub, mData);
                 hasData = true;
                 break;
             default:
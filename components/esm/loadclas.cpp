@@ -42,23 +42,24 @@ namespace ESM
     void Class::load(ESMReader &esm)
     {
         bool hasData = false;
+        SubRecordView sub;
+
         while (esm.hasMoreSubs())
         {
-            esm.getSubName();
-            uint32_t name = esm.retSubName().val;
-            switch (name)
+            esm.getSubRecordView(sub);
+            switch (sub.mName.val)
             {
                 case ESM::FourCC<'F','N','A','M'>::value:
-                    mName = esm.getHString();
+                    mName = esm.getString(sub);
                     break;
                 case ESM::FourCC<'C','L','D','T'>::value:
-                    esm.getHT(mData, 60);
+                    esm.getT(sub, mData);
                     if (mData.mIsPlayable > 1)
                         esm.fail("Unknown bool value");
                     hasData = true;
                     break;
                 case ESM::FourCC<'D','E','S','C'>::value:
-                    mDescription = esm.getHString();
+                    mDescription = esm.getString(sub);
                     break;
                 default:
                     esm.fail("Unknown subrecord");
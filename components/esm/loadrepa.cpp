@@ -11,27 +11,28 @@ namespace ESM
 void Repair::load(ESMReader &esm)
 {
     bool hasData = true;
+    SubRecordView sub;
+
     while (esm.hasMoreSubs())
     {
-        esm.getSubName();
-        uint32_t name = esm.retSubName().val;
-        switch (name)
+        esm.getSubRecordView(sub);
+        switch (sub.mName.val)
         {
             case ESM::FourCC<'M','O','D','L'>::value:
-                mModel = esm.getHString();
+                mModel = esm.getString(sub);
                 break;
             case ESM::FourCC<'F','N','A','M'>::value:
-                mName = esm.getHString();
+                mName = esm.getString(sub);
                 break;
             case ESM::FourCC<'R','I','D','T'>::value:
-                esm.getHT(mData, 16);
+                esm.getT(sub, mData);
                 hasData = true;
                 break;
             case ESM::FourCC<'S','C','R','I'>::value:
-                mScript = esm.getHString();
+                mScript = esm.getString(sub);
                 break;
             case ESM::FourCC<'I','T','E','X'>::value:
-                mIcon = esm.getHString();
+                mIcon = esm.getString(sub);
                 break;
             default:
                 esm.fail("Unknown subrecord");
@@ -133,22 +133,23 @@ namespace ESM
     {
         bool hasIndex = false;
         bool hasData = false;
+        SubRecordView sub;
+
         while (esm.hasMoreSubs())
         {
-            esm.getSubName();
-            uint32_t name = esm.retSubName().val;
-            switch (name)
+            esm.getSubRecordView(sub);
+            switch (sub.mName.val)
             {
                 case ESM::FourCC<'I','N','D','X'>::value:
-                    esm.getHT(mIndex);
+                    esm.getT(sub, mIndex);
                     hasIndex = true;
                     break;
                 case ESM::FourCC<'S','K','D','T'>::value:
-                    esm.getHT(mData, 24);
+                    esm.getT(sub, mData);
                     hasData = true;
                     break;
                 case ESM::FourCC<'D','E','S','C'>::value:
-                    mDescription = esm.getHString();
+                    mDescription = esm.getString(sub);
                     break;
                 default:
                     esm.fail("Unknown subrecord");
@@ -11,21 +11,22 @@ namespace ESM
     void SoundGenerator::load(ESMReader &esm)
     {
         bool hasData = false;
+        SubRecordView sub;
+
         while (esm.hasMoreSubs())
         {
-            esm.getSubName();
-            uint32_t name = esm.retSubName().val;
-            switch (name)
+            esm.getSubRecordView(sub);
+            switch (sub.mName.val)
             {
                 case ESM::FourCC<'D','A','T','A'>::value:
-                    esm.getHT(mType, 4);
+                    esm.getT(sub, mType);
                     hasData = true;
                     break;
                 case ESM::FourCC<'C','N','A','M'>::value:
-                    mCreature = esm.getHString();
+                    mCreature = esm.getString(sub);
                     break;
                 case ESM::FourCC<'S','N','A','M'>::value:
-                    mSound = esm.getHString();
+                    mSound = esm.getString(sub);
                     break;
                 default:
                     esm.fail("Unknown subrecord");
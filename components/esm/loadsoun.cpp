@@ -11,17 +11,18 @@ namespace ESM
     void Sound::load(ESMReader &esm)
     {
         bool hasData = false;
+        SubRecordView sub;
+
         while (esm.hasMoreSubs())
         {
-            esm.getSubName();
-            uint32_t name = esm.retSubName().val;
-            switch (name)
+            esm.getSubRecordView(sub);
+            switch (sub.mName.val)
             {
                 case ESM::FourCC<'F','N','A','M'>::value:
-                    mSound = esm.getHString();
+                    mSound = esm.getString(sub);
                     break;
                 case ESM::FourCC<'D','A','T','A'>::value:
-                    esm.getHT(mData, 3);
+                    esm.getT(sub, mData);
                     hasData = true;
                     break;
                 default:
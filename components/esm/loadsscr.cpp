@@ -12,18 +12,19 @@ namespace ESM
     {
         bool hasData = false;
         bool hasName = false;
+        SubRecordView sub;
+
         while (esm.hasMoreSubs())
         {
-            esm.getSubName();
-            uint32_t name = esm.retSubName().val;
-            switch (name)
+            esm.getSubRecordView(sub);
+            switch (sub.mName.val)
             {
                 case ESM::FourCC<'D','A','T','A'>::value:
-                    mData = esm.getHString();
+                    mData = esm.getString(sub);
                     hasData = true;
                     break;
                 case ESM::FourCC<'N','A','M','E'>::value:
-                    mId = esm.getHString();
+                    mId = esm.getString(sub);
                     hasName = true;
                     break;
                 default:
@@ -40,24 +40,24 @@ void ESM::ObjectState::save (ESMWriter &esm, bool inInventory) const
 
     if (mHasLocals)
     {
-        esm.writeHNT ("HLOC", mHasLocals);
+        esm.writeHNT (FourCC<'H','L','O','C'>::value, mHasLocals);
         mLocals.save (esm);
     }
 
     if (!mEnabled && !inInventory)
-        esm.writeHNT ("ENAB", mEnabled);
+        esm.writeHNT (FourCC<'E','N','A','B'>::value, mEnabled);
 
     if (mCount!=1)
-        esm.writeHNT ("COUN", mCount);
+        esm.writeHNT (FourCC<'C','O','U','N'>::value, mCount);
 
     if (!inInventory)
     {
-        esm.writeHNT ("POS_", mPosition, 24);
-        esm.writeHNT ("LROT", mLocalRotation, 12);
+        esm.writeHNT (FourCC<'P','O','S','_'>::value, mPosition, 24);
+        esm.writeHNT (FourCC<'L','R','O','T'>::value, mLocalRotation, 12);
     }
 
     if (!mHasCustomState)
-        esm.writeHNT ("HCUS", false);
+        esm.writeHNT (FourCC<'H','C','U','S'>::value, false);
 }
 
 void ESM::ObjectState::blank()
@@ -0,0 +1,42 @@
+#include "compression.hpp"
+
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace Misc
+{
+
+    void Compression::compress (const char *data, std::size_t size, std::vector<char>& out)
+    {
+        uLongf outSize = compressBound (static_cast<uLong> (size));
+        out.resize (outSize);
+
+        // saved game chunks are written on the main thread, so favour speed over ratio
+        int result = compress2 (reinterpret_cast<Bytef *> (&out[0]), &outSize,
+            reinterpret_cast<const Bytef *> (data), static_cast<uLong> (size), Z_BEST_SPEED);
+
+        if (result!=Z_OK)
+            throw std::runtime_error ("compression failed");
+
+        out.resize (outSize);
+    }
+
+    void Compression::decompress (const char *data, std::size_t size, std::size_t uncompressedSize,
+        std::vector<char>& out)
+    {
+        out.resize (uncompressedSize);
+
+        if (!uncompressedSize)
+            return;
+
+        uLongf outSize = static_cast<uLongf> (uncompressedSize);
+
+        int result = uncompress (reinterpret_cast<Bytef *> (&out[0]), &outSize,
+            reinterpret_cast<const Bytef *> (data), static_cast<uLong> (size));
+
+        if (result!=Z_OK || outSize!=uncompressedSize)
+            throw std::runtime_error ("decompression failed: data is corrupted");
+    }
+
+}
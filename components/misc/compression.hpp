@@ -0,0 +1,30 @@
+#ifndef OPENMW_COMPONENTS_MISC_COMPRESSION_H
+#define OPENMW_COMPONENTS_MISC_COMPRESSION_H
+
+#include <cstddef>
+#include <vector>
+
+namespace Misc
+{
+
+/*
+  Deflate compression of memory buffers (zlib)
+*/
+class Compression
+{
+public:
+
+    /// Replace the content of \a out with the compressed \a data.
+    static void compress (const char *data, std::size_t size, std::vector<char>& out);
+
+    /// Replace the content of \a out with the decompressed \a data.
+    ///
+    /// \param uncompressedSize Size of the original data
+    /// \note Throws a std::runtime_error, if \a data is corrupted.
+    static void decompress (const char *data, std::size_t size, std::size_t uncompressedSize,
+        std::vector<char>& out);
+};
+
+}
+
+#endif
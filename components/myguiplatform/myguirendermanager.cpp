@@ -1,5 +1,6 @@
 #include "myguirendermanager.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <MyGUI_Gui.h>
@@ -17,6 +18,7 @@
 #include <components/resource/texturemanager.hpp>
 
 #include "myguitexture.hpp"
+#include "myguitextureatlas.hpp"
 
 #define MYGUI_PLATFORM_LOG_SECTION "Platform"
 #define MYGUI_PLATFORM_LOG(level, text) MYGUI_LOGGING(MYGUI_PLATFORM_LOG_SECTION, level, text)
@@ -109,32 +111,25 @@ class Drawable : public osg::Drawable {
 
         mReadFrom = (mReadFrom+1)%sNumBuffers;
         const std::vector<Batch>& vec = mBatchVector[mReadFrom];
+        const std::vector<MyGUI::Vertex>& vertices = mVertexVector[mReadFrom];
+        if (!vertices.empty())
+        {
+            // VBOs disabled due to crash in OSG: http://forum.openscenegraph.org/viewtopic.php?t=14909
+            // The vertices of all batches are in one array, so the pointers are only set once per frame.
+            const char* data = reinterpret_cast<const char*>(&vertices[0]);
+            glVertexPointer(3, GL_FLOAT, sizeof(MyGUI::Vertex), data);
+            glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(MyGUI::Vertex), data + 12);
+            glTexCoordPointer(2, GL_FLOAT, sizeof(MyGUI::Vertex), data + 16);
+        }
+
         for (std::vector<Batch>::const_iterator it = vec.begin(); it != vec.end(); ++it)
         {
             const Batch& batch = *it;
-            osg::VertexBufferObject *vbo = batch.mVertexBuffer;
             osg::Texture2D* texture = batch.mTexture;
             if(texture)
                 state->applyTextureAttribute(0, texture);
 
-            // VBOs disabled due to crash in OSG: http://forum.openscenegraph.org/viewtopic.php?t=14909
-            osg::GLBufferObject* bufferobject = 0;//state->isVertexBufferObjectSupported() ? vbo->getOrCreateGLBufferObject(state->getContextID()) : 0;
-            if (0)//bufferobject)
-            {
-                state->bindVertexBufferObject(bufferobject);
-
-                glVertexPointer(3, GL_FLOAT, sizeof(MyGUI::Vertex), (char*)NULL);
-                glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(MyGUI::Vertex), (char*)NULL + 12);
-                glTexCoordPointer(2, GL_FLOAT, sizeof(MyGUI::Vertex), (char*)NULL + 16);
-            }
-            else
-            {
-                glVertexPointer(3, GL_FLOAT, sizeof(MyGUI::Vertex), (char*)vbo->getArray(0)->getDataPointer());
-                glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(MyGUI::Vertex), (char*)vbo->getArray(0)->getDataPointer() + 12);
-                glTexCoordPointer(2, GL_FLOAT, sizeof(MyGUI::Vertex), (char*)vbo->getArray(0)->getDataPointer() + 16);
-            }
-
-            glDrawArrays(GL_TRIANGLES, 0, batch.mVertexCount);
+            glDrawArrays(GL_TRIANGLES, batch.mFirstVertex, batch.mVertexCount);
         }
 
         glDisableClientState(GL_VERTEX_ARRAY);
@@ -176,22 +171,42 @@ public:
         // May be empty
         osg::ref_ptr<osg::Texture2D> mTexture;
 
-        osg::ref_ptr<osg::VertexBufferObject> mVertexBuffer;
-        // need to hold on to this too as the mVertexBuffer does not hold a ref to its own array
-        osg::ref_ptr<osg::UByteArray> mArray;
-
+        // range in the vertex array of the frame
+        size_t mFirstVertex;
         size_t mVertexCount;
     };
 
-    void addBatch(const Batch& batch)
+    /// Append \a count vertices to the vertex array of the frame, drawn with \a texture. Merged with the previous
+    /// batch if it uses the same texture.
+    /// @return The appended vertices, to be filled in by the caller.
+    MyGUI::Vertex* addBatch(osg::Texture2D* texture, size_t count)
     {
-        mBatchVector[mWriteTo].push_back(batch);
+        std::vector<MyGUI::Vertex>& vertices = mVertexVector[mWriteTo];
+        std::vector<Batch>& batches = mBatchVector[mWriteTo];
+
+        size_t first = vertices.size();
+        vertices.resize(first + count);
+
+        if (!batches.empty() && batches.back().mTexture == texture)
+            batches.back().mVertexCount += count;
+        else
+        {
+            Batch batch;
+            batch.mTexture = texture;
+            batch.mFirstVertex = first;
+            batch.mVertexCount = count;
+            batches.push_back(batch);
+        }
+
+        return &vertices[first];
     }
 
     void clear()
     {
         mWriteTo = (mWriteTo+1)%sNumBuffers;
         mBatchVector[mWriteTo].clear();
+        // keeps its capacity, so the array is only reallocated when the GUI grows
+        mVertexVector[mWriteTo].clear();
     }
 
     META_Object(osgMyGUI, Drawable)
@@ -202,29 +217,24 @@ private:
 
     // double buffering approach, to avoid the need for synchronization with the draw thread
     std::vector<Batch> mBatchVector[sNumBuffers];
+    std::vector<MyGUI::Vertex> mVertexVector[sNumBuffers];
 
     int mWriteTo;
     mutable int mReadFrom;
 };
 
+// The vertices are copied into the vertex array of the frame when they are rendered, so the draw thread never reads
+// from this buffer, and it can be modified at any time.
 class OSGVertexBuffer : public MyGUI::IVertexBuffer
 {
-    osg::ref_ptr<osg::VertexBufferObject> mBuffer;
-    osg::ref_ptr<osg::UByteArray> mVertexArray;
+    std::vector<MyGUI::Vertex> mVertices;
 
     size_t mNeedVertexCount;
 
-    bool mQueuedForDrawing;
-
-    void destroy();
-    void create();
-
 public:
     OSGVertexBuffer();
     virtual ~OSGVertexBuffer();
 
-    void markAsQueuedForDrawing();
-
     virtual void setVertexCount(size_t count);
     virtual size_t getVertexCount();
 
@@ -233,24 +243,16 @@ public:
 
 /*internal:*/
 
-    osg::VertexBufferObject *getBuffer() const { return mBuffer.get(); }
-    osg::UByteArray *getArray() const { return mVertexArray.get(); }
+    const MyGUI::Vertex *getVertices() const { return mVertices.empty() ? NULL : &mVertices[0]; }
 };
 
 OSGVertexBuffer::OSGVertexBuffer()
   : mNeedVertexCount(0)
-  , mQueuedForDrawing(false)
 {
 }
 
 OSGVertexBuffer::~OSGVertexBuffer()
 {
-    destroy();
-}
-
-void OSGVertexBuffer::markAsQueuedForDrawing()
-{
-    mQueuedForDrawing = true;
 }
 
 void OSGVertexBuffer::setVertexCount(size_t count)
@@ -268,48 +270,12 @@ size_t OSGVertexBuffer::getVertexCount()
 
 MyGUI::Vertex *OSGVertexBuffer::lock()
 {
-    if (mQueuedForDrawing || !mVertexArray)
-    {
-        // Force recreating the buffer, to make sure we are not modifying a buffer currently
-        // queued for rendering in the last frame's draw thread.
-        // a more efficient solution might be double buffering
-        destroy();
-        create();
-        mQueuedForDrawing = false;
-    }
-    else
-    {
-        mVertexArray->resize(mNeedVertexCount * sizeof(MyGUI::Vertex));
-    }
-
-    MYGUI_PLATFORM_ASSERT(mBuffer.valid(), "Vertex buffer is not created");
-
-    return (MyGUI::Vertex*)&(*mVertexArray)[0];
+    mVertices.resize(mNeedVertexCount);
+    return mVertices.empty() ? NULL : &mVertices[0];
 }
 
 void OSGVertexBuffer::unlock()
 {
-    mVertexArray->dirty();
-    mBuffer->dirty();
-}
-
-void OSGVertexBuffer::destroy()
-{
-    mBuffer = nullptr;
-    mVertexArray = nullptr;
-}
-
-void OSGVertexBuffer::create()
-{
-    MYGUI_PLATFORM_ASSERT(!mBuffer.valid(), "Vertex buffer already exist");
-
-    mVertexArray = new osg::UByteArray(mNeedVertexCount*sizeof(MyGUI::Vertex));
-
-    mBuffer = new osg::VertexBufferObject;
-    mBuffer->setDataVariance(osg::Object::DYNAMIC);
-    mBuffer->setUsage(GL_DYNAMIC_DRAW);
-    // NB mBuffer does not own the array
-    mBuffer->setArray(0, mVertexArray.get());
 }
 
 // ---------------------------------------------------------------------------
@@ -321,6 +287,7 @@ RenderManager::RenderManager(osgViewer::Viewer *viewer, osg::Group *sceneroot, R
   , mUpdate(false)
   , mIsInitialise(false)
   , mInvScalingFactor(1.f)
+  , mAtlas(new TextureAtlas)
 {
     if (scalingFactor != 0.f)
         mInvScalingFactor = 1.f / scalingFactor;
@@ -407,23 +374,46 @@ void RenderManager::begin()
 
 void RenderManager::doRender(MyGUI::IVertexBuffer *buffer, MyGUI::ITexture *texture, size_t count)
 {
-    Drawable::Batch batch;
-    batch.mVertexCount = count;
-    batch.mVertexBuffer = static_cast<OSGVertexBuffer*>(buffer)->getBuffer();
-    static_cast<OSGVertexBuffer*>(buffer)->markAsQueuedForDrawing();
-    batch.mArray = static_cast<OSGVertexBuffer*>(buffer)->getArray();
+    const MyGUI::Vertex* source = static_cast<OSGVertexBuffer*>(buffer)->getVertices();
+    if (!source || count == 0)
+        return;
+
+    osg::Texture2D* osgTexture = NULL;
+    const AtlasRegion* region = NULL;
     if (texture)
     {
-        batch.mTexture = static_cast<OSGTexture*>(texture)->getTexture();
-        if (batch.mTexture->getDataVariance() == osg::Object::DYNAMIC)
-            mDrawable->setDataVariance(osg::Object::DYNAMIC); // only for this frame, reset in begin()
+        OSGTexture* myguiTexture = static_cast<OSGTexture*>(texture);
+        const AtlasRegion& atlasRegion = myguiTexture->getAtlasRegion(*mAtlas);
+        if (atlasRegion.mPage != -1)
+        {
+            region = &atlasRegion;
+            osgTexture = mAtlas->getTexture(atlasRegion.mPage);
+        }
+        else
+        {
+            osgTexture = myguiTexture->getTexture();
+            if (osgTexture->getDataVariance() == osg::Object::DYNAMIC)
+                mDrawable->setDataVariance(osg::Object::DYNAMIC); // only for this frame, reset in begin()
+        }
     }
 
-    mDrawable->addBatch(batch);
+    MyGUI::Vertex* dest = mDrawable->addBatch(osgTexture, count);
+    std::copy(source, source + count, dest);
+
+    if (region)
+    {
+        // map the texture coordinates of the icon to its part of the atlas page
+        for (size_t i=0; i<count; ++i)
+        {
+            dest[i].u = region->mLeft + dest[i].u * region->mWidth;
+            dest[i].v = region->mTop + dest[i].v * region->mHeight;
+        }
+    }
 }
 
 void RenderManager::end()
 {
+    mAtlas->frameEnded();
 }
 
 void RenderManager::update()
@@ -1,6 +1,8 @@
 #ifndef OPENMW_COMPONENTS_MYGUIPLATFORM_MYGUIRENDERMANAGER_H
 #define OPENMW_COMPONENTS_MYGUIPLATFORM_MYGUIRENDERMANAGER_H
 
+#include <memory>
+
 #include <MyGUI_RenderManager.h>
 
 #include <osg/ref_ptr>
@@ -26,6 +28,7 @@ namespace osgMyGUI
 {
 
 class Drawable;
+class TextureAtlas;
 
 class RenderManager : public MyGUI::RenderManager, public MyGUI::IRenderTarget
 {
@@ -48,6 +51,9 @@ class RenderManager : public MyGUI::RenderManager, public MyGUI::IRenderTarget
 
     float mInvScalingFactor;
 
+    // item and spell icons, so widgets showing different icons can be drawn in one batch
+    std::auto_ptr<TextureAtlas> mAtlas;
+
     void destroyAllResources();
 
 public:
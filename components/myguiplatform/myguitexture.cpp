@@ -5,8 +5,21 @@
 
 #include <osg/Texture2D>
 
+#include <components/misc/stringops.hpp>
+
 #include <components/resource/texturemanager.hpp>
 
+namespace
+{
+
+    bool isIcon(const std::string& name)
+    {
+        std::string prefix = Misc::StringUtils::lowerCase(name.substr(0, 6));
+        return prefix == "icons\\" || prefix == "icons/";
+    }
+
+}
+
 namespace osgMyGUI
 {
 
@@ -71,10 +84,17 @@ namespace osgMyGUI
         mFormat = format;
         mUsage = usage;
         mNumElemBytes = numelems;
+
+        mAtlasKey.clear();
+        mAtlasImage = nullptr;
+        mAtlasRegion = AtlasRegion();
     }
 
     void OSGTexture::destroy()
     {
+        mAtlasKey.clear();
+        mAtlasImage = nullptr;
+        mAtlasRegion = AtlasRegion();
         mTexture = nullptr;
         mFormat = MyGUI::PixelFormat::Unknow;
         mUsage = MyGUI::TextureUsage::Default;
@@ -90,6 +110,19 @@ namespace osgMyGUI
         // disable mip-maps
         mTexture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::LINEAR);
 
+        // item and spell icons are drawn from a TextureAtlas, so a list of them does not need a batch per icon.
+        // The image is only available if the texture has not been uploaded yet.
+        // An earlier texture of the same icon may have been packed already, so the image is not needed then.
+        mAtlasRegion = AtlasRegion();
+        mAtlasKey.clear();
+        mAtlasImage = nullptr;
+        if (isIcon(fname))
+        {
+            mAtlasKey = Misc::StringUtils::lowerCase(fname);
+            if (TextureAtlas::isPackable(mTexture->getImage()))
+                mAtlasImage = mTexture->getImage();
+        }
+
         // FIXME
         mFormat = MyGUI::PixelFormat::R8G8B8;
         mUsage = MyGUI::TextureUsage::Static | MyGUI::TextureUsage::Write;
@@ -160,6 +193,21 @@ namespace osgMyGUI
         mTexture = newTexture;
 
         mLockedImage = nullptr;
+
+        mAtlasKey.clear();
+        mAtlasImage = nullptr;
+        mAtlasRegion = AtlasRegion();
+    }
+
+    const AtlasRegion& OSGTexture::getAtlasRegion(TextureAtlas &atlas)
+    {
+        if (!mAtlasKey.empty())
+        {
+            mAtlasRegion = atlas.add(mAtlasImage.get(), mAtlasKey);
+            mAtlasKey.clear();
+            mAtlasImage = nullptr;
+        }
+        return mAtlasRegion;
     }
 
     bool OSGTexture::isLocked()
@@ -5,6 +5,8 @@
 
 #include <osg/ref_ptr>
 
+#include "myguitextureatlas.hpp"
+
 namespace osg
 {
     class Image;
@@ -29,6 +31,12 @@ namespace osgMyGUI
         MyGUI::TextureUsage mUsage;
         size_t mNumElemBytes;
 
+        // the file name and image of an icon, kept until it is packed into the TextureAtlas, since the texture drops the
+        // image after the upload
+        std::string mAtlasKey;
+        osg::ref_ptr<osg::Image> mAtlasImage;
+        AtlasRegion mAtlasRegion;
+
     public:
         OSGTexture(const std::string &name, Resource::TextureManager* textureManager);
         OSGTexture(osg::Texture2D* texture);
@@ -57,6 +65,11 @@ namespace osgMyGUI
 
     /*internal:*/
         osg::Texture2D *getTexture() const { return mTexture.get(); }
+
+        /// Pack the image of this texture into \a atlas, if it is an icon and has not been packed yet, by this or an earlier
+        /// texture of the same file.
+        /// @return The region of the image, with mPage -1 if the texture is not part of the atlas.
+        const AtlasRegion& getAtlasRegion(TextureAtlas& atlas);
     };
 
 }
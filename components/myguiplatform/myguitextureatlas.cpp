@@ -0,0 +1,259 @@
+#include "myguitextureatlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <osg/Image>
+#include <osg/Texture2D>
+
+namespace
+{
+
+    const int sPageSize = 512;
+
+    // larger images are drawn from their own texture
+    const int sMaxImageSize = 64;
+
+    // border around each image, filled with its edge texels so images do not bleed into each other when filtered.
+    // One S3TC block.
+    const int sPadding = 4;
+
+    /// Get the size of the blocks the image data is copied in: 4x4 pixels for S3TC compressed formats, single pixels
+    /// otherwise.
+    /// @return Is the format supported?
+    bool getBlockInfo(GLenum pixelFormat, GLenum dataType, int& blockSize, int& bytesPerBlock)
+    {
+        switch (pixelFormat)
+        {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                blockSize = 4;
+                bytesPerBlock = 8;
+                return true;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                blockSize = 4;
+                bytesPerBlock = 16;
+                return true;
+            case GL_RGB:
+                blockSize = 1;
+                bytesPerBlock = 3;
+                return dataType == GL_UNSIGNED_BYTE;
+            case GL_RGBA:
+                blockSize = 1;
+                bytesPerBlock = 4;
+                return dataType == GL_UNSIGNED_BYTE;
+            default:
+                return false;
+        }
+    }
+
+    osg::ref_ptr<osg::Texture2D> createPageTexture(osg::Image* image)
+    {
+        osg::ref_ptr<osg::Texture2D> texture = new osg::Texture2D(image);
+        texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
+        texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
+        texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+        texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+        // keep the image, it is copied when more images are added
+        texture->setUnRefImageDataAfterApply(false);
+        return texture;
+    }
+
+}
+
+namespace osgMyGUI
+{
+
+    AtlasRegion::AtlasRegion()
+        : mPage(-1)
+        , mLeft(0.f)
+        , mTop(0.f)
+        , mWidth(1.f)
+        , mHeight(1.f)
+    {
+    }
+
+    TextureAtlas::TextureAtlas()
+    {
+    }
+
+    TextureAtlas::~TextureAtlas()
+    {
+    }
+
+    bool TextureAtlas::isPackable(const osg::Image *image)
+    {
+        if (!image || !image->data() || image->r() != 1)
+            return false;
+
+        if (image->s() > sMaxImageSize || image->t() > sMaxImageSize)
+            return false;
+
+        // whole S3TC blocks, which also keeps the rows of uncompressed images free of padding
+        if (image->s() % 4 != 0 || image->t() % 4 != 0)
+            return false;
+
+        int blockSize, bytesPerBlock;
+        return getBlockInfo(image->getPixelFormat(), image->getDataType(), blockSize, bytesPerBlock);
+    }
+
+    AtlasRegion TextureAtlas::add(const osg::Image *image, const std::string& key)
+    {
+        std::map<std::string, AtlasRegion>::const_iterator found = mRegions.find(key);
+        if (found != mRegions.end())
+            return found->second;
+
+        AtlasRegion region;
+        if (!isPackable(image))
+            return region;
+
+        int width = image->s() + 2*sPadding;
+        int height = image->t() + 2*sPadding;
+
+        int x = 0, y = 0;
+        int pageIndex = -1;
+        for (unsigned int i=0; i<mPages.size(); ++i)
+        {
+            Page& page = mPages[i];
+            if (page.mPixelFormat == image->getPixelFormat() && page.mDataType == image->getDataType()
+                    && page.mInternalFormat == image->getInternalTextureFormat()
+                    && place(page, width, height, x, y))
+            {
+                pageIndex = i;
+                break;
+            }
+        }
+
+        if (pageIndex == -1)
+        {
+            pageIndex = createPage(image);
+            place(mPages[pageIndex], width, height, x, y);
+        }
+
+        x += sPadding;
+        y += sPadding;
+
+        Page& page = mPages[pageIndex];
+        if (page.mDrawn)
+        {
+            // the draw thread may be reading the current image, so modify a copy
+            page.mImage = new osg::Image(*page.mImage, osg::CopyOp::DEEP_COPY_ALL);
+            page.mTexture = createPageTexture(page.mImage);
+            page.mDrawn = false;
+        }
+
+        copyImage(image, page, x, y);
+
+        region.mPage = pageIndex;
+        region.mLeft = x / static_cast<float>(sPageSize);
+        region.mTop = y / static_cast<float>(sPageSize);
+        region.mWidth = image->s() / static_cast<float>(sPageSize);
+        region.mHeight = image->t() / static_cast<float>(sPageSize);
+
+        mRegions[key] = region;
+        return region;
+    }
+
+    osg::Texture2D* TextureAtlas::getTexture(int page)
+    {
+        mPages[page].mUsed = true;
+        return mPages[page].mTexture.get();
+    }
+
+    void TextureAtlas::frameEnded()
+    {
+        for (std::vector<Page>::iterator it = mPages.begin(); it != mPages.end(); ++it)
+        {
+            if (it->mUsed)
+            {
+                it->mDrawn = true;
+                it->mUsed = false;
+            }
+        }
+    }
+
+    int TextureAtlas::createPage(const osg::Image *image)
+    {
+        int blockSize, bytesPerBlock;
+        getBlockInfo(image->getPixelFormat(), image->getDataType(), blockSize, bytesPerBlock);
+
+        unsigned int dataSize = (sPageSize / blockSize) * (sPageSize / blockSize) * bytesPerBlock;
+        unsigned char* data = new unsigned char[dataSize];
+        std::memset(data, 0, dataSize);
+
+        Page page;
+        page.mPixelFormat = image->getPixelFormat();
+        page.mDataType = image->getDataType();
+        page.mInternalFormat = image->getInternalTextureFormat();
+        page.mImage = new osg::Image;
+        page.mImage->setImage(sPageSize, sPageSize, 1, page.mInternalFormat, page.mPixelFormat, page.mDataType,
+                              data, osg::Image::USE_NEW_DELETE);
+        page.mTexture = createPageTexture(page.mImage);
+        page.mUsed = false;
+        page.mDrawn = false;
+        page.mShelfX = 0;
+        page.mShelfY = 0;
+        page.mShelfHeight = 0;
+
+        mPages.push_back(page);
+        return mPages.size()-1;
+    }
+
+    bool TextureAtlas::place(Page &page, int width, int height, int &x, int &y)
+    {
+        int shelfX = page.mShelfX;
+        int shelfY = page.mShelfY;
+        int shelfHeight = page.mShelfHeight;
+
+        if (shelfX + width > sPageSize)
+        {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (shelfY + height > sPageSize)
+            return false;
+
+        x = shelfX;
+        y = shelfY;
+
+        page.mShelfX = shelfX + width;
+        page.mShelfY = shelfY;
+        page.mShelfHeight = std::max(shelfHeight, height);
+        return true;
+    }
+
+    void TextureAtlas::copyImage(const osg::Image *image, Page &page, int x, int y)
+    {
+        int blockSize, bytesPerBlock;
+        getBlockInfo(image->getPixelFormat(), image->getDataType(), blockSize, bytesPerBlock);
+
+        // only the first mipmap level, the pages are not mipmapped
+        int columns = image->s() / blockSize;
+        int rows = image->t() / blockSize;
+        int border = sPadding / blockSize;
+        unsigned int sourceRowSize = columns * bytesPerBlock;
+        unsigned int pageRowSize = (sPageSize / blockSize) * bytesPerBlock;
+
+        const unsigned char* source = image->data();
+        unsigned char* dest = page.mImage->data() + (y / blockSize) * pageRowSize + (x / blockSize) * bytesPerBlock;
+        for (int row=-border; row<rows+border; ++row)
+        {
+            // the border repeats the first and last row and column
+            const unsigned char* sourceRow = source + std::max(0, std::min(rows-1, row)) * sourceRowSize;
+            unsigned char* destRow = dest + row * static_cast<int>(pageRowSize);
+
+            std::memcpy(destRow, sourceRow, sourceRowSize);
+            for (int i=1; i<=border; ++i)
+            {
+                std::memcpy(destRow - i * bytesPerBlock, sourceRow, bytesPerBlock);
+                std::memcpy(destRow + sourceRowSize + (i-1) * bytesPerBlock, sourceRow + sourceRowSize - bytesPerBlock,
+                            bytesPerBlock);
+            }
+        }
+
+        page.mImage->dirty();
+    }
+
+}
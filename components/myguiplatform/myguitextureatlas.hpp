@@ -0,0 +1,101 @@
+#ifndef OPENMW_COMPONENTS_MYGUIPLATFORM_MYGUITEXTUREATLAS_H
+#define OPENMW_COMPONENTS_MYGUIPLATFORM_MYGUITEXTUREATLAS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osg/ref_ptr>
+#include <osg/GL>
+
+namespace osg
+{
+    class Image;
+    class Texture2D;
+}
+
+namespace osgMyGUI
+{
+
+    /// The part of a TextureAtlas page taken by an image, in texture coordinates of the page.
+    struct AtlasRegion
+    {
+        AtlasRegion();
+
+        int mPage; // -1 if the image is not in the atlas
+        float mLeft;
+        float mTop;
+        float mWidth;
+        float mHeight;
+    };
+
+    /// @brief Packs small images into shared textures, so widgets showing different images can be drawn in one batch
+    ///
+    /// The images are copied as they are, without conversion, so there is a separate set of pages for each pixel
+    /// format. S3TC compressed images are copied block by block. Each image is surrounded by copies of its edge texels
+    /// (edge blocks for S3TC), so filtering does not blend in its neighbours. A page that was drawn in an earlier frame
+    /// may still be in use by the draw thread, so adding an image to it replaces its texture with a modified copy, once
+    /// per frame at most.
+    ///
+    /// Images are packed once per key, so textures that are created again for the same file share their region.
+    class TextureAtlas
+    {
+    public:
+        TextureAtlas();
+        ~TextureAtlas();
+
+        /// Can \a image be packed? Only small images in a few common formats are supported.
+        static bool isPackable(const osg::Image* image);
+
+        /// Copy \a image to a free part of a page, unless an image has been packed for \a key before.
+        /// @param image May be NULL if it is not available anymore, the image is then only looked up by \a key.
+        /// @param key Identifies the image, e.g. its file name.
+        /// @return The region of the image, with mPage -1 if it could not be packed.
+        AtlasRegion add(const osg::Image* image, const std::string& key);
+
+        /// Get the texture of the given page for drawing. Images added to the page later in the same frame are
+        /// copied to the texture in place, see frameEnded().
+        osg::Texture2D* getTexture(int page);
+
+        /// Call once the draw calls of a frame are collected. The textures of the pages used in the frame may be
+        /// read by the draw thread from now on, so they will not be modified anymore.
+        void frameEnded();
+
+    private:
+        struct Page
+        {
+            GLenum mPixelFormat;
+            GLenum mDataType;
+            GLint mInternalFormat;
+
+            osg::ref_ptr<osg::Image> mImage;
+            osg::ref_ptr<osg::Texture2D> mTexture;
+            bool mUsed; // by the frame being collected
+            bool mDrawn; // by a frame the draw thread may still be reading
+
+            // shelf packing, images are added left to right in rows of the height of the tallest image
+            int mShelfX;
+            int mShelfY;
+            int mShelfHeight;
+        };
+
+        std::vector<Page> mPages;
+
+        std::map<std::string, AtlasRegion> mRegions; // by key of the image
+
+        int createPage(const osg::Image* image);
+
+        /// Find space for an image with its border.
+        /// @return Was there enough space in the page?
+        bool place(Page& page, int width, int height, int& x, int& y);
+
+        /// Copy \a image to \a x, \a y of the page and fill its border with the edge texels.
+        void copyImage(const osg::Image* image, Page& page, int x, int y);
+
+        TextureAtlas(const TextureAtlas&);
+        void operator = (const TextureAtlas&);
+    };
+
+}
+
+#endif
@@ -4,7 +4,13 @@
 #include <osg/Geode>
 #include <osg/UserDataContainer>
 
+#include <osg/LightSource>
+
 #include <osgParticle/ParticleSystem>
+#include <osgParticle/ParticleProcessor>
+#include <osgParticle/ParticleSystemUpdater>
+
+#include <osgAnimation/MorphGeometry>
 
 #include <osgUtil/IncrementalCompileOperation>
 
@@ -18,6 +24,8 @@
 
 #include <components/sceneutil/clone.hpp>
 #include <components/sceneutil/util.hpp>
+#include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 
 namespace
 {
@@ -76,6 +84,60 @@ namespace
         }
     };
 
+    /// Checks if a subgraph has any state that differs between instances of a scene, i.e. anything
+    /// SceneUtil::CopyOp would make a copy of apart from the nodes themselves.
+    class FindInstanceStateVisitor : public osg::NodeVisitor
+    {
+    public:
+        FindInstanceStateVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mFound(false)
+        {
+        }
+
+        void apply(osg::Node& node)
+        {
+            if (node.getUpdateCallback() || node.getEventCallback()
+                    || isDynamic(node.getStateSet())
+                    || dynamic_cast<osgParticle::ParticleProcessor*>(&node)
+                    || dynamic_cast<osgParticle::ParticleSystemUpdater*>(&node)
+                    || dynamic_cast<osg::LightSource*>(&node)
+                    || dynamic_cast<SceneUtil::LightSource*>(&node))
+            {
+                mFound = true;
+                return;
+            }
+
+            if (osg::Geode* geode = node.asGeode())
+            {
+                for (unsigned int i=0;i<geode->getNumDrawables();++i)
+                {
+                    osg::Drawable* drawable = geode->getDrawable(i);
+                    if (drawable->getUpdateCallback() || drawable->getEventCallback()
+                            || isDynamic(drawable->getStateSet())
+                            || dynamic_cast<osgParticle::ParticleSystem*>(drawable)
+                            || dynamic_cast<osgAnimation::MorphGeometry*>(drawable)
+                            || dynamic_cast<SceneUtil::RigGeometry*>(drawable))
+                    {
+                        mFound = true;
+                        return;
+                    }
+                }
+            }
+
+            if (!mFound)
+                traverse(node);
+        }
+
+        bool mFound;
+
+    private:
+        static bool isDynamic(const osg::StateSet* stateset)
+        {
+            return stateset && stateset->getDataVariance() == osg::Object::DYNAMIC;
+        }
+    };
+
 }
 
 namespace Resource
@@ -142,6 +204,31 @@ namespace Resource
         return cloned;
     }
 
+    osg::ref_ptr<osg::Node> SceneManager::getSharedInstance(const std::string &name)
+    {
+        std::string normalized = name;
+        mVFS->normalizeFilename(normalized);
+
+        SharedIndex::iterator it = mSharedIndex.find(normalized);
+        if (it != mSharedIndex.end())
+            return it->second;
+
+        osg::ref_ptr<const osg::Node> scene = getTemplate(normalized);
+
+        FindInstanceStateVisitor visitor;
+        const_cast<osg::Node*>(scene.get())->accept(visitor);
+
+        osg::ref_ptr<osg::Node> shared;
+        if (!visitor.mFound)
+        {
+            // copy the nodes once, so the template itself is never attached to the scene
+            shared = osg::clone(scene.get(), SceneUtil::CopyOp());
+        }
+
+        mSharedIndex[normalized] = shared;
+        return shared;
+    }
+
     osg::ref_ptr<const NifOsg::KeyframeHolder> SceneManager::getKeyframes(const std::string &name)
     {
         std::string normalized = name;
@@ -50,6 +50,13 @@ namespace Resource
         /// @see getTemplate
         osg::ref_ptr<osg::Node> createInstance(const std::string& name, osg::Group* parentNode);
 
+        /// Get an instance of the given scene template that can be attached to any number of parent nodes
+        /// @note Only templates without per-instance state (controllers, particle systems, lights, animated
+        ///  geometry or state) can be shared, for others NULL is returned and createInstance has to be used.
+        /// @note The returned node must not be modified.
+        /// @see getTemplate
+        osg::ref_ptr<osg::Node> getSharedInstance(const std::string& name);
+
         /// Attach the given scene instance to the given parent node
         /// @note You should have the parentNode in its intended position before calling this method,
         ///       so that world space particles of the \a instance get transformed correctly.
@@ -83,6 +90,10 @@ namespace Resource
         typedef std::map<std::string, osg::ref_ptr<const osg::Node> > Index;
         Index mIndex;
 
+        // NULL for templates that can not be shared
+        typedef std::map<std::string, osg::ref_ptr<osg::Node> > SharedIndex;
+        SharedIndex mSharedIndex;
+
         typedef std::map<std::string, osg::ref_ptr<const NifOsg::KeyframeHolder> > KeyframeIndex;
         KeyframeIndex mKeyframeIndex;
 
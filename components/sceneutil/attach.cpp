@@ -51,10 +51,7 @@ namespace SceneUtil
     {
         if (dynamic_cast<SceneUtil::Skeleton*>(toAttach.get()))
         {
-            osg::ref_ptr<osg::Group> handle = new osg::Group;
-
-            CopyRigVisitor copyVisitor(handle, filter);
-            toAttach->accept(copyVisitor);
+            osg::ref_ptr<osg::Group> handle = extractRig(toAttach, filter);
 
             master->asGroup()->addChild(handle);
 
@@ -112,4 +109,14 @@ namespace SceneUtil
         }
     }
 
+    osg::ref_ptr<osg::Group> extractRig(osg::Node *toAttach, const std::string &filter)
+    {
+        osg::ref_ptr<osg::Group> handle = new osg::Group;
+
+        CopyRigVisitor copyVisitor(handle, filter);
+        toAttach->accept(copyVisitor);
+
+        return handle;
+    }
+
 }
@@ -8,6 +8,7 @@
 namespace osg
 {
     class Node;
+    class Group;
 }
 
 namespace SceneUtil
@@ -20,6 +21,12 @@ namespace SceneUtil
     /// @return A newly created node that is directly attached to the master scene graph
     osg::ref_ptr<osg::Node> attach(osg::ref_ptr<osg::Node> toAttach, osg::Node* master, const std::string& filter, const std::string& attachNode);
 
+    /// Collect the skinned objects of the \a toAttach scenegraph that match the \a filter into a new group, which can
+    /// then be added to the root of the master scenegraph. This is the part of attach() for skinned objects that does not
+    /// need the master scenegraph, so it can be done on a worker thread.
+    /// @note \a toAttach is expected to be a SceneUtil::Skeleton.
+    osg::ref_ptr<osg::Group> extractRig(osg::Node* toAttach, const std::string& filter);
+
 }
 
 #endif
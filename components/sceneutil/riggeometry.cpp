@@ -62,6 +62,7 @@ RigGeometry::RigGeometry()
     : mSkeleton(NULL)
     , mFirstFrame(true)
     , mBoundsFirstFrame(true)
+    , mSkinnedFrame(0)
 {
     setCullCallback(new UpdateRigGeometry);
     setUpdateCallback(new UpdateRigBounds);
@@ -74,6 +75,7 @@ RigGeometry::RigGeometry(const RigGeometry &copy, const osg::CopyOp &copyop)
     , mInfluenceMap(copy.mInfluenceMap)
     , mFirstFrame(copy.mFirstFrame)
     , mBoundsFirstFrame(copy.mBoundsFirstFrame)
+    , mSkinnedFrame(0)
 {
     setSourceGeometry(copy.mSourceGeometry);
 }
@@ -208,7 +210,12 @@ void RigGeometry::update(osg::NodeVisitor* nv)
 
     if (!mSkeleton->getActive() && !mFirstFrame)
         return;
+
+    // the bones have not moved since the last skinning, e.g. the skeleton is throttled or seen by a second camera
+    if (!mFirstFrame && mSkeleton->getLastUpdateFrame() == mSkinnedFrame)
+        return;
     mFirstFrame = false;
+    mSkinnedFrame = mSkeleton->getLastUpdateFrame();
 
     mSkeleton->updateBoneMatrices(nv);
 
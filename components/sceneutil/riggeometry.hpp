@@ -67,6 +67,8 @@ namespace SceneUtil
         bool mFirstFrame;
         bool mBoundsFirstFrame;
 
+        unsigned int mSkinnedFrame; // Skeleton::getLastUpdateFrame() at the last skinning
+
         bool initFromParentSkeleton(osg::NodeVisitor* nv);
 
         osg::Matrixf getGeomToSkelMatrix(osg::NodeVisitor* nv);
@@ -3,6 +3,7 @@
 #include <osg/Transform>
 #include <osg/MatrixTransform>
 
+#include <algorithm>
 #include <iostream>
 
 namespace SceneUtil
@@ -36,6 +37,11 @@ Skeleton::Skeleton()
     , mNeedToUpdateBoneMatrices(true)
     , mActive(true)
     , mLastFrameNumber(0)
+    , mLodDistance(0.f)
+    , mMaxUpdateInterval(1)
+    , mLastUpdateFrame(0)
+    , mCullDistance(0.f)
+    , mLastCullFrame(0)
 {
 
 }
@@ -46,6 +52,11 @@ Skeleton::Skeleton(const Skeleton &copy, const osg::CopyOp &copyop)
     , mNeedToUpdateBoneMatrices(true)
     , mActive(copy.mActive)
     , mLastFrameNumber(0)
+    , mLodDistance(copy.mLodDistance)
+    , mMaxUpdateInterval(copy.mMaxUpdateInterval)
+    , mLastUpdateFrame(0)
+    , mCullDistance(0.f)
+    , mLastCullFrame(0)
 {
 
 }
@@ -133,10 +144,60 @@ bool Skeleton::getActive() const
     return mActive;
 }
 
+void Skeleton::setUpdateLod(float distance, unsigned int maxInterval)
+{
+    mLodDistance = distance;
+    mMaxUpdateInterval = std::max(1u, maxInterval);
+}
+
+unsigned int Skeleton::getLastUpdateFrame() const
+{
+    return mLastUpdateFrame;
+}
+
+unsigned int Skeleton::getUpdateInterval(unsigned int frameNumber) const
+{
+    if (mLodDistance <= 0.f)
+        return 1;
+
+    // not drawn in the previous frame, the bones are only needed for the bounds
+    if (mLastCullFrame + 1 < frameNumber)
+        return mMaxUpdateInterval;
+
+    unsigned int interval = 1;
+    float distance = mLodDistance;
+    while (mCullDistance > distance && interval < mMaxUpdateInterval)
+    {
+        interval *= 2;
+        distance *= 2;
+    }
+    return std::min(interval, mMaxUpdateInterval);
+}
+
 void Skeleton::traverse(osg::NodeVisitor& nv)
 {
-    if (!mActive && nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR && mLastFrameNumber != 0)
-        return;
+    if (nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR)
+    {
+        if (!mActive && mLastFrameNumber != 0)
+            return;
+
+        unsigned int frameNumber = nv.getFrameStamp()->getFrameNumber();
+        if (mLastUpdateFrame != 0 && frameNumber - mLastUpdateFrame < getUpdateInterval(frameNumber))
+            return;
+        mLastUpdateFrame = frameNumber;
+    }
+    else if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR)
+    {
+        float distance = nv.getDistanceToViewPoint(getBound().center(), true);
+
+        unsigned int frameNumber = nv.getFrameStamp()->getFrameNumber();
+        if (frameNumber != mLastCullFrame)
+            mCullDistance = distance;
+        else
+            mCullDistance = std::min(mCullDistance, distance);
+        mLastCullFrame = frameNumber;
+    }
+
     osg::Group::traverse(nv);
 }
 
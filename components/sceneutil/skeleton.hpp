@@ -53,6 +53,16 @@ namespace SceneUtil
 
         bool getActive() const;
 
+        /// Update the bones less often if the skeleton is far away from the camera, or was not drawn in the previous frame.
+        /// @param distance Beyond this distance the bones are updated every second frame, beyond twice the distance every
+        ///                 fourth frame, and so on. 0 to update the bones every frame.
+        /// @param maxInterval Maximum number of frames between updates, also used if the skeleton was not drawn.
+        /// @note Update callbacks below the skeleton are throttled as well, which rules out light sources.
+        void setUpdateLod(float distance, unsigned int maxInterval);
+
+        /// Get the number of the last frame in which the bones were updated.
+        unsigned int getLastUpdateFrame() const;
+
         void traverse(osg::NodeVisitor& nv);
 
     private:
@@ -69,6 +79,16 @@ namespace SceneUtil
         bool mActive;
 
         unsigned int mLastFrameNumber;
+
+        float mLodDistance;
+        unsigned int mMaxUpdateInterval;
+        unsigned int mLastUpdateFrame;
+
+        // closest distance to the camera in the last frame the skeleton was drawn
+        float mCullDistance;
+        unsigned int mLastCullFrame;
+
+        unsigned int getUpdateInterval(unsigned int frameNumber) const;
     };
 
 }
@@ -24,6 +24,11 @@ void WorkTicket::signalDone()
     mCondition.broadcast();
 }
 
+bool WorkTicket::isDone()
+{
+    return mDone > 0;
+}
+
 WorkItem::WorkItem()
     : mTicket(new WorkTicket)
 {
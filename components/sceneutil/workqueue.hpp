@@ -21,6 +21,9 @@ namespace SceneUtil
 
         void signalDone();
 
+        /// Has the work been completed? Does not block.
+        bool isDone();
+
     private:
         OpenThreads::Atomic mDone;
         OpenThreads::Mutex mMutex;
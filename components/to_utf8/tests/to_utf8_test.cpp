@@ -33,6 +33,15 @@ void testEncoder(ToUTF8::FromType encoding, const std::string &legacyEncFile,
     std::string convertedLegacyEncLine = encoder.getLegacyEnc(utf8Line);
     // check correctness
     assert(convertedLegacyEncLine == legacyEncLine);
+
+    // append to existing data
+    std::string appendedUtf8Line = utf8Line;
+    encoder.appendUtf8(legacyEncLine.c_str(), legacyEncLine.size(), appendedUtf8Line);
+    assert(appendedUtf8Line == utf8Line + utf8Line);
+
+    std::vector<char> appendedLegacyEncLine (legacyEncLine.begin(), legacyEncLine.end());
+    encoder.appendLegacyEnc(utf8Line.c_str(), utf8Line.size(), appendedLegacyEncLine);
+    assert(std::string(appendedLegacyEncLine.begin(), appendedLegacyEncLine.end()) == legacyEncLine + legacyEncLine);
 }
 
 std::string getFirstLine(const std::string &filename)
@@ -1,11 +1,18 @@
 #include "to_utf8.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOUTF8_SSE2
+#include <emmintrin.h>
+#endif
+
 /* This file contains the code to translate from WINDOWS-1252 (native
    charset used in English version of Morrowind) to UTF-8. The library
    is designed to be extened to support more source encodings later,
@@ -35,7 +42,10 @@
    non-ASCII characters are typically starting and ending quotation
    marks.) Within these, almost all the characters are ASCII. For this
    purpose, the library is also optimized for mostly-ASCII contents
-   even in the cases where some conversion is necessary.
+   even in the cases where some conversion is necessary: runs of ASCII
+   characters are found 16 bytes at a time (SSE2) or one machine word
+   at a time, and copied as a block. Only the remaining characters go
+   through the lookup tables.
  */
 
 
@@ -44,8 +54,73 @@
 
 using namespace ToUTF8;
 
-Utf8Encoder::Utf8Encoder(const FromType sourceEncoding):
-    mOutput(50*1024)
+namespace
+{
+    /// Return the first byte in [ptr, end) that is either zero or not 7-bit ASCII, or \a end.
+    inline const char* skipAscii(const char* ptr, const char* end)
+    {
+#ifdef TOUTF8_SSE2
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; end-ptr >= 16; ptr += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+
+            // the high bit of each byte is set for non-ASCII bytes, and for zero bytes after the compare
+            if (_mm_movemask_epi8(_mm_or_si128(block, _mm_cmpeq_epi8(block, zero))))
+                break;
+        }
+#else
+        const size_t ones = ~static_cast<size_t>(0) / 0xff;
+        const size_t highs = ones * 0x80;
+
+        for (; end-ptr >= static_cast<ptrdiff_t>(sizeof(size_t)); ptr += sizeof(size_t))
+        {
+            size_t word;
+            std::memcpy(&word, ptr, sizeof(word));
+
+            // non-ASCII bytes have their high bit set, zero bytes get it set by the subtraction
+            if ((word | ((word - ones) & ~word)) & highs)
+                break;
+        }
+#endif
+
+        // at most one block left
+        while (ptr!=end && *ptr!=0 && static_cast<unsigned char>(*ptr) < 128)
+            ++ptr;
+
+        return ptr;
+    }
+
+    /// Return the length of the UTF8 sequence starting with \a ch, as far as the legacy
+    /// encodings are concerned.
+    inline int getUtf8SequenceLength(unsigned char ch)
+    {
+        switch (ch)
+        {
+            case 0xe2: return 3;
+            case 0xc2:
+            case 0xcb:
+            case 0xc4:
+            case 0xc6:
+            case 0xc3:
+            case 0xd0:
+            case 0xd1:
+            case 0xd2:
+            case 0xc5: return 2;
+        }
+
+        // There is no 1 length utf-8 glyph that is not 0x20 (empty space)
+        return 1;
+    }
+
+    bool compareGlyphs(const std::pair<unsigned int, char>& left, const std::pair<unsigned int, char>& right)
+    {
+        return left.first < right.first;
+    }
+}
+
+Utf8Encoder::Utf8Encoder(const FromType sourceEncoding)
 {
     switch (sourceEncoding)
     {
@@ -75,101 +150,113 @@ Utf8Encoder::Utf8Encoder(const FromType sourceEncoding):
             assert(0);
         }
     }
+
+    // Reverse lookup table for getLegacyEnc
+    for (int i = 128; i < 256; i++)
+    {
+        const signed char *in = translationArray + i*6;
+        int len = *(in++);
+
+        if (len < 2)
+            continue;
+
+        unsigned int key = 0;
+        for (int j=0; j<len && j<4; ++j)
+            key |= static_cast<unsigned int>(static_cast<unsigned char>(in[j])) << (8*j);
+
+        mLegacyGlyphs.push_back(std::make_pair(key, static_cast<char>(i)));
+    }
+
+    // stable, so that the lowest code point wins if several map to the same glyph
+    std::stable_sort(mLegacyGlyphs.begin(), mLegacyGlyphs.end(), compareGlyphs);
 }
 
 std::string Utf8Encoder::getUtf8(const char* input, size_t size)
 {
-    // Double check that the input string stops at some point (it might
-    // contain zero terminators before this, inside its own data, which
-    // is also ok.)
-    assert(input[size] == 0);
+    std::string output;
+    appendUtf8(input, size, output);
+    return output;
+}
+
+std::string Utf8Encoder::getLegacyEnc(const char *input, size_t size)
+{
+    std::string output;
+    appendLegacyEnc(input, size, output);
+    return output;
+}
 
+void Utf8Encoder::appendUtf8(const char *input, size_t size, std::string& output)
+{
     // Note: The rest of this function is designed for single-character
     // input encodings only. It also assumes that the input the input
     // encoding shares its first 128 values (0-127) with ASCII. There are
     // no plans to add more encodings to this module (we are using utf8
     // for new content files), so that shouldn't be an issue.
 
-    // Compute output length, and check for pure ascii input at the same
-    // time.
+    const char *end = input + size;
     bool ascii;
-    size_t outlen = getLength(input, ascii);
+    size_t outlen = getLength(input, end, ascii);
 
     // If we're pure ascii, then don't bother converting anything.
-    if(ascii)
-        return std::string(input, outlen);
-
-    // Make sure the output is large enough
-    resize(outlen);
-    char *out = &mOutput[0];
+    if (ascii)
+    {
+        output.append(input, end);
+        return;
+    }
 
-    // Translate
-    while (*input)
-        copyFromArray(*(input++), out);
+    size_t offset = output.size();
+    output.resize(offset + outlen);
+    copyUtf8(input, end, &output[offset]);
+}
 
-    // Make sure that we wrote the correct number of bytes
-    assert((out-&mOutput[0]) == (int)outlen);
+void Utf8Encoder::appendUtf8(const char *input, size_t size, std::vector<char>& output)
+{
+    const char *end = input + size;
+    bool ascii;
+    size_t outlen = getLength(input, end, ascii);
 
-    // And make extra sure the output is null terminated
-    assert(mOutput.size() > outlen);
-    assert(mOutput[outlen] == 0);
+    if (ascii)
+    {
+        output.insert(output.end(), input, end);
+        return;
+    }
 
-    // Return a string
-    return std::string(&mOutput[0], outlen);
+    size_t offset = output.size();
+    output.resize(offset + outlen);
+    copyUtf8(input, end, &output[offset]);
 }
 
-std::string Utf8Encoder::getLegacyEnc(const char *input, size_t size)
+void Utf8Encoder::appendLegacyEnc(const char *input, size_t size, std::string& output)
 {
-    // Double check that the input string stops at some point (it might
-    // contain zero terminators before this, inside its own data, which
-    // is also ok.)
-    assert(input[size] == 0);
-
     // TODO: The rest of this function is designed for single-character
     // input encodings only. It also assumes that the input the input
     // encoding shares its first 128 values (0-127) with ASCII. These
     // conditions must be checked again if you add more input encodings
     // later.
 
-    // Compute output length, and check for pure ascii input at the same
-    // time.
-    bool ascii;
-    size_t outlen = getLength2(input, ascii);
-
-    // If we're pure ascii, then don't bother converting anything.
-    if(ascii)
-        return std::string(input, outlen);
-
-    // Make sure the output is large enough
-    resize(outlen);
-    char *out = &mOutput[0];
-
-    // Translate
-    while(*input)
-        copyFromArray2(input, out);
+    if (!size)
+        return;
 
-    // Make sure that we wrote the correct number of bytes
-    assert((out-&mOutput[0]) == (int)outlen);
+    // The legacy encodings use one byte per character, so the output can't be longer than the input
+    size_t offset = output.size();
+    output.resize(offset + size);
 
-    // And make extra sure the output is null terminated
-    assert(mOutput.size() > outlen);
-    assert(mOutput[outlen] == 0);
+    char *out = copyLegacyEnc(input, input + size, &output[offset]);
 
-    // Return a string
-    return std::string(&mOutput[0], outlen);
+    output.resize(out - &output[0]);
 }
 
-// Make sure the output vector is large enough for 'size' bytes,
-// including a terminating zero after it.
-void Utf8Encoder::resize(size_t size)
+void Utf8Encoder::appendLegacyEnc(const char *input, size_t size, std::vector<char>& output)
 {
-    if (mOutput.size() <= size)
-        // Add some extra padding to reduce the chance of having to resize
-        // again later.
-        mOutput.resize(3*size);
+    if (!size)
+        return;
 
-    // And make sure the string is zero terminated
-    mOutput[size] = 0;
+    size_t offset = output.size();
+    output.resize(offset + size);
+
+    char *out = copyLegacyEnc(input, input + size, &output[offset]);
+
+    output.resize(out - &output[0]);
 }
 
 /** Get the total length length needed to decode the given string with
@@ -182,148 +269,109 @@ void Utf8Encoder::resize(size_t size)
   is the case, then the ascii parameter is set to true, and the
   caller can optimize for this case.
  */
-size_t Utf8Encoder::getLength(const char* input, bool &ascii)
+size_t Utf8Encoder::getLength(const char* input, const char*& end, bool& ascii) const
 {
     ascii = true;
     size_t len = 0;
     const char* ptr = input;
-    unsigned char inp = *ptr;
-
-    // Do away with the ascii part of the string first (this is almost
-    // always the entire string.)
-    while (inp && inp < 128)
-        inp = *(++ptr);
-    len += (ptr-input);
-
-    // If we're not at the null terminator at this point, then there
-    // were some non-ascii characters to deal with. Go to slow-mode for
-    // the rest of the string.
-    if (inp)
+
+    while (true)
     {
-        ascii = false;
-        while (inp)
+        // Do away with the ascii part of the string first (this is almost
+        // always the entire string.)
+        const char* next = skipAscii(ptr, end);
+        len += next-ptr;
+        ptr = next;
+
+        if (ptr==end)
+            break;
+
+        unsigned char inp = *ptr;
+
+        if (!inp)
         {
-            // Find the translated length of this character in the
-            // lookup table.
-            len += translationArray[inp*6];
-            inp = *(++ptr);
+            end = ptr;
+            break;
         }
+
+        // Find the translated length of this character in the
+        // lookup table.
+        ascii = false;
+        len += translationArray[inp*6];
+        ++ptr;
     }
+
     return len;
 }
 
-// Translate one character 'ch' using the translation array 'arr', and
-// advance the output pointer accordingly.
-void Utf8Encoder::copyFromArray(unsigned char ch, char* &out)
+void Utf8Encoder::copyUtf8(const char* input, const char* end, char* out) const
 {
-    // Optimize for ASCII values
-    if (ch < 128)
+    while (input!=end)
     {
-        *(out++) = ch;
-        return;
-    }
+        // Copy runs of ASCII characters as a whole
+        const char* next = skipAscii(input, end);
+        std::memcpy(out, input, next-input);
+        out += next-input;
+        input = next;
 
-    const signed char *in = translationArray + ch*6;
-    int len = *(in++);
-    for (int i=0; i<len; i++)
-        *(out++) = *(in++);
-}
+        if (input==end)
+            break;
 
-size_t Utf8Encoder::getLength2(const char* input, bool &ascii)
-{
-    ascii = true;
-    size_t len = 0;
-    const char* ptr = input;
-    unsigned char inp = *ptr;
-
-    // Do away with the ascii part of the string first (this is almost
-    // always the entire string.)
-    while (inp && inp < 128)
-        inp = *(++ptr);
-    len += (ptr-input);
-
-    // If we're not at the null terminator at this point, then there
-    // were some non-ascii characters to deal with. Go to slow-mode for
-    // the rest of the string.
-    if (inp)
-    {
-        ascii = false;
-        while(inp)
-        {
-            len += 1;
-            // Find the translated length of this character in the
-            // lookup table.
-            switch(inp)
-            {
-                case 0xe2: len -= 2; break;
-                case 0xc2:
-                case 0xcb:
-                case 0xc4:
-                case 0xc6:
-                case 0xc3:
-                case 0xd0:
-                case 0xd1:
-                case 0xd2:
-                case 0xc5: len -= 1; break;
-            }
-
-            inp = *(++ptr);
-        }
+        // Translate one character using the translation array
+        const signed char *in = translationArray + static_cast<unsigned char>(*(input++))*6;
+        int len = *(in++);
+        for (int i=0; i<len; i++)
+            *(out++) = *(in++);
     }
-    return len;
 }
 
-void Utf8Encoder::copyFromArray2(const char*& chp, char* &out)
+char* Utf8Encoder::copyLegacyEnc(const char* input, const char* end, char* out) const
 {
-    unsigned char ch = *(chp++);
-    // Optimize for ASCII values
-    if (ch < 128)
+    while (input!=end)
     {
-        *(out++) = ch;
-        return;
-    }
-
-    int len = 1;
-    switch (ch)
-    {
-        case 0xe2: len = 3; break;
-        case 0xc2:
-        case 0xcb:
-        case 0xc4:
-        case 0xc6:
-        case 0xc3:
-        case 0xd0:
-        case 0xd1:
-        case 0xd2:
-        case 0xc5: len = 2; break;
-    }
+        const char* next = skipAscii(input, end);
+        std::memcpy(out, input, next-input);
+        out += next-input;
+        input = next;
 
-    if (len == 1) // There is no 1 length utf-8 glyph that is not 0x20 (empty space)
-    {
-        *(out++) = ch;
-        return;
-    }
+        if (input==end || *input==0)
+            break;
 
-    unsigned char ch2 = *(chp++);
-    unsigned char ch3 = '\0';
-    if (len == 3)
-        ch3 = *(chp++);
+        unsigned char utf8[3] = { static_cast<unsigned char>(*(input++)), 0, 0 };
+        int len = getUtf8SequenceLength(utf8[0]);
 
-    for (int i = 128; i < 256; i++)
-    {
-        unsigned char b1 = translationArray[i*6 + 1], b2 = translationArray[i*6 + 2], b3 = translationArray[i*6 + 3];
-        if (b1 == ch && b2 == ch2 && (len != 3 || b3 == ch3))
+        if (len==1)
         {
-            *(out++) = (char)i;
-            return;
+            *(out++) = utf8[0];
+            continue;
         }
+
+        for (int i=1; i<len && input!=end; ++i)
+            utf8[i] = *(input++);
+
+        *(out++) = findGlyph(utf8, len);
     }
 
+    return out;
+}
+
+char Utf8Encoder::findGlyph(const unsigned char* utf8, int len) const
+{
+    unsigned int key = 0;
+    for (int i=0; i<len; ++i)
+        key |= static_cast<unsigned int>(utf8[i]) << (8*i);
+
+    std::vector<std::pair<unsigned int, char> >::const_iterator iter =
+        std::lower_bound(mLegacyGlyphs.begin(), mLegacyGlyphs.end(), std::make_pair(key, '\0'), compareGlyphs);
+
+    if (iter!=mLegacyGlyphs.end() && iter->first==key)
+        return iter->second;
+
     std::ios::fmtflags f(std::cout.flags());
-    std::cout << "Could not find glyph " << std::hex << (int)ch << " " << (int)ch2 << " " << (int)ch3 << std::endl;
+    std::cout << "Could not find glyph " << std::hex << (int)utf8[0] << " " << (int)utf8[1] << " " << (int)utf8[2] << std::endl;
     std::cout.flags(f);
 
-    *(out++) = ch; // Could not find glyph, just put whatever
+    return utf8[0]; // Could not find glyph, just put whatever
 }
 
 ToUTF8::FromType ToUTF8::calculateEncoding(const std::string& encodingName)
@@ -40,15 +40,34 @@ namespace ToUTF8
                 return getLegacyEnc(str.c_str(), str.size());
             }
 
+            // Convert up to \a size bytes of \a input (stopping early at a zero byte) and append
+            // the result to \a output. This avoids allocating a new string for every conversion.
+            void appendUtf8(const char *input, size_t size, std::string& output);
+            void appendUtf8(const char *input, size_t size, std::vector<char>& output);
+
+            void appendLegacyEnc(const char *input, size_t size, std::string& output);
+            void appendLegacyEnc(const char *input, size_t size, std::vector<char>& output);
+
         private:
-            void resize(size_t size);
-            size_t getLength(const char* input, bool &ascii);
-            void copyFromArray(unsigned char chp, char* &out);
-            size_t getLength2(const char* input, bool &ascii);
-            void copyFromArray2(const char*& chp, char* &out);
+            size_t getLength(const char* input, const char*& end, bool& ascii) const;
+            ///< Return the length of the UTF8 representation of [input, end). If the input
+            /// contains a zero byte, \a end is moved there.
+
+            void copyUtf8(const char* input, const char* end, char* out) const;
+            ///< Write the UTF8 representation of [input, end) to \a out.
+
+            char* copyLegacyEnc(const char* input, const char* end, char* out) const;
+            ///< Write the legacy representation of [input, end) to \a out.
+            ///
+            /// \return End of the written data (never more than end-input bytes)
+
+            char findGlyph(const unsigned char* utf8, int len) const;
 
-            std::vector<char> mOutput;
             signed char* translationArray;
+
+            // UTF8 sequences of the non-ASCII characters, packed little-endian into integers,
+            // and sorted for the lookup in findGlyph
+            std::vector<std::pair<unsigned int, char> > mLegacyGlyphs;
     };
 }
 